@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <sstream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <gpds/archiver_xml.hpp>
+#include <gpds/serialize.hpp>
+#include <qschematic/headless/document.h>
+#include <qschematic/headless/node.h>
+#include <qschematic/headless/connector.h>
+#include <qschematic/wire_system/manager.h>
+#include <qschematic/utils/taskscheduler.h>
+#include "batchprocessor.h"
+#include "connectivitycheck.h"
+
+// Rough ratio between the size of a file and the memory needed to parse it (XML DOM). Only used to skip
+// files up front, the memory held afterwards is accounted.
+const qint64 PARSE_MEMORY_FACTOR = 8;
+
+using namespace QSchematic::Headless;
+
+/**
+ * Allows loading a Document through the GPDS archiver.
+ */
+class DocumentLoader :
+    public gpds::serialize
+{
+public:
+    explicit DocumentLoader(Document& document) :
+        _document(document)
+    {
+    }
+
+    gpds::container to_container() const override
+    {
+        return { };
+    }
+
+    void from_container(const gpds::container& container) override
+    {
+        _document.from_container(container);
+    }
+
+private:
+    Document& _document;
+};
+
+BatchProcessor::BatchProcessor(const Options& options) :
+    _options(options)
+{
+}
+
+/**
+ * Processes all files and returns the results in the same order as the paths.
+ */
+QVector<BatchProcessor::Result> BatchProcessor::run(const QStringList& paths) const
+{
+    QVector<Result> results(paths.count());
+
+    // Files with the same name in different directories would overwrite each
+    // other's netlist, reject all but the first one before processing anything
+    QStringList outputPaths;
+    QHash<QString, int> outputOwners;
+    for (int i = 0; i < paths.count(); i++) {
+        const QString& output = outputPath(paths.at(i));
+        outputPaths << output;
+        if (output.isEmpty()) {
+            continue;
+        }
+        if (outputOwners.contains(output)) {
+            results[i].path = paths.at(i);
+            results[i].error = QStringLiteral("Output file \"%1\" collides with the one of \"%2\"").arg(output, paths.at(outputOwners.value(output)));
+            continue;
+        }
+        outputOwners.insert(output, i);
+    }
+
+    // The calling thread helps out while waiting for the group, hence one worker less
+    QSchematic::TaskScheduler& scheduler = QSchematic::TaskScheduler::instance();
+    scheduler.setWorkerCount(std::max(1, _options.workers) - 1);
+
+    QSchematic::TaskGroup group(scheduler);
+    for (int i = 0; i < paths.count(); i++) {
+        if (!results.at(i).error.isEmpty()) {
+            continue;
+        }
+        group.run([this, &paths, &outputPaths, &results, i] {
+            results[i] = process(paths.at(i), outputPaths.at(i));
+        });
+    }
+    group.wait();
+
+    return results;
+}
+
+/**
+ * Returns the path of the netlist written for the given file or an empty string
+ * if no netlists are written.
+ */
+QString BatchProcessor::outputPath(const QString& path) const
+{
+    if (_options.outputDirectory.isEmpty()) {
+        return QString();
+    }
+
+    const QString& fileName = QFileInfo(path).completeBaseName() + '.' + NetlistWriter::fileExtension(_options.format);
+
+    return QDir::cleanPath(QDir(_options.outputDirectory).absoluteFilePath(fileName));
+}
+
+BatchProcessor::Result BatchProcessor::process(const QString& path, const QString& outputPath) const
+{
+    Result result;
+    result.path = path;
+
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+
+    // Accounts the memory currently held, returns false once it exceeds the budget
+    auto account = [this, &result, &total](qint64 bytes, const char* stage) {
+        result.peakBytes = std::max(result.peakBytes, bytes);
+        if (_options.memoryBudget <= 0 || bytes <= _options.memoryBudget) {
+            return true;
+        }
+
+        result.error = QStringLiteral("Exceeded the memory budget while %1 (%2 MiB)").arg(QLatin1String(stage)).arg(bytes / (1024 * 1024));
+        result.totalNsecs = total.nsecsElapsed();
+        return false;
+    };
+
+    // The parser can't be accounted, skip files that won't fit before reading anything
+    const QFileInfo fileInfo(path);
+    const qint64 parseBytes = fileInfo.size() * PARSE_MEMORY_FACTOR;
+    if (_options.memoryBudget > 0 && parseBytes > _options.memoryBudget) {
+        result.error = QStringLiteral("Too large to be parsed within the memory budget (estimated %1 MiB)").arg(parseBytes / (1024 * 1024));
+        result.totalNsecs = total.nsecsElapsed();
+        return result;
+    }
+
+    // Load
+    timer.start();
+    Document document;
+    {
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) {
+            result.error = file.errorString();
+            result.totalNsecs = total.nsecsElapsed();
+            return result;
+        }
+
+        std::stringstream stream(file.readAll().toStdString());
+        file.close();
+
+        DocumentLoader loader(document);
+        gpds::archiver_xml ar;
+        if (!ar.load(stream, loader, "qschematic")) {
+            result.error = QStringLiteral("Couldn't parse file");
+            result.totalNsecs = total.nsecsElapsed();
+            return result;
+        }
+    }
+    result.loadNsecs = timer.nsecsElapsed();
+    result.nodes = document.nodes().count();
+
+    // The file contents are released, only the document is left
+    const qint64 documentBytes = static_cast<qint64>(document.wire_manager()->memory_stats().bytes)
+                                 + document.nodes().count() * static_cast<qint64>(sizeof(Node))
+                                 + document.connectors().count() * static_cast<qint64>(sizeof(Connector));
+    if (!account(documentBytes, "loading")) {
+        return result;
+    }
+
+    // Netlist
+    timer.start();
+    Netlist netlist;
+    NetlistGenerator::generate(netlist, document);
+    result.nets = static_cast<int>(netlist.nets().size());
+    result.netlistNsecs = timer.nsecsElapsed();
+
+    qint64 netlistBytes = static_cast<qint64>(netlist.nodes().size() * sizeof(const Node*));
+    for (const auto& net : netlist.nets()) {
+        netlistBytes += sizeof(NetlistNet) + net.name.size() * sizeof(QChar);
+        netlistBytes += (net.wires.size() + net.nodes.size() + net.connectors.size()) * sizeof(void*);
+        netlistBytes += net.connectorNodePairs.size() * 4 * sizeof(void*);     // Tree node: links, key and value
+    }
+    if (!account(documentBytes + netlistBytes, "generating the netlist")) {
+        return result;
+    }
+
+    // Connectivity checks
+    if (_options.check) {
+        timer.start();
+        for (const auto& issue : ConnectivityCheck::run(document)) {
+            result.issues << issue.description;
+        }
+        result.checkNsecs = timer.nsecsElapsed();
+    }
+
+    // Write
+    if (!outputPath.isEmpty()) {
+        timer.start();
+        const QByteArray data = NetlistWriter::write(netlist, _options.format);
+        if (!account(documentBytes + netlistBytes + data.size(), "writing")) {
+            return result;
+        }
+
+        QFile file(outputPath);
+        if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+            result.error = file.errorString();
+            result.totalNsecs = total.nsecsElapsed();
+            return result;
+        }
+        file.write(data);
+        file.close();
+        result.writeNsecs = timer.nsecsElapsed();
+    }
+
+    result.ok = true;
+    result.totalNsecs = total.nsecsElapsed();
+
+    return result;
+}
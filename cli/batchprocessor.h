@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "netlistwriter.h"
+
+/**
+ * Processes schematic files concurrently on the shared QSchematic::TaskScheduler.
+ * Each worker handles one file at a time and releases the document before picking
+ * up the next one, so the memory usage is bounded by the number of workers times
+ * the per-worker budget.
+ *
+ * The budget is enforced on the memory held by the worker: the file contents, the
+ * document and the netlist. These are accounted as they are built and a file is
+ * aborted as soon as they exceed the budget. Only the XML DOM of the parser can't
+ * be accounted, files that are too large to be parsed within the budget are
+ * skipped up front based on their size.
+ */
+class BatchProcessor
+{
+public:
+    struct Options
+    {
+        QString outputDirectory;                        // Empty: don't write netlists
+        NetlistWriter::Format format = NetlistWriter::Json;
+        bool check = false;
+        int workers = 1;
+        qint64 memoryBudget = 0;                        // Per worker, in bytes. 0: unlimited
+    };
+
+    struct Result
+    {
+        QString path;
+        bool ok = false;
+        QString error;
+        qint64 loadNsecs = 0;
+        qint64 netlistNsecs = 0;
+        qint64 checkNsecs = 0;
+        qint64 writeNsecs = 0;
+        qint64 totalNsecs = 0;
+        qint64 peakBytes = 0;                           // Peak of the accounted memory
+        int nodes = 0;
+        int nets = 0;
+        QStringList issues;
+    };
+
+    explicit BatchProcessor(const Options& options);
+
+    QVector<Result> run(const QStringList& paths) const;
+
+private:
+    Result process(const QString& path, const QString& outputPath) const;
+    QString outputPath(const QString& path) const;
+
+    Options _options;
+};
@@ -0,0 +1,85 @@
+#include <QHash>
+#include <QSet>
+#include <qschematic/headless/document.h>
+#include <qschematic/headless/node.h>
+#include <qschematic/headless/connector.h>
+#include <qschematic/headless/net.h>
+#include <qschematic/wire_system/manager.h>
+#include <qschematic/wire_system/wire.h>
+#include "connectivitycheck.h"
+
+using namespace QSchematic::Headless;
+
+QVector<ConnectivityCheck::Issue> ConnectivityCheck::run(const Document& document)
+{
+    QVector<Issue> issues;
+    const auto& manager = document.wire_manager();
+
+    // Connectors
+    QHash<const wire_system::wire*, int> connectorsPerWire;
+    QSet<QPair<const wire_system::wire*, int>> attachedPoints;
+    int nodeIndex = 0;
+    for (const auto& node : document.nodes()) {
+        for (const auto& connector : node->connectors()) {
+            const wire_system::wire* wire = manager->attached_wire(connector.get());
+            if (!wire) {
+                issues.append({ Issue::UnconnectedConnector, QStringLiteral("Connector \"%1\" of node #%2 is not connected").arg(connector->text()).arg(nodeIndex) });
+                continue;
+            }
+            connectorsPerWire[wire]++;
+            attachedPoints.insert({ wire, manager->attached_point(connector.get()) });
+        }
+        nodeIndex++;
+    }
+
+    // Group the wire nets into global nets (wire nets sharing the same name) the
+    // same way the NetlistGenerator does. Unnamed wire nets are on their own.
+    QVector<QVector<std::shared_ptr<Net>>> globalNets;
+    QHash<QString, int> namedNets;
+    for (const auto& net : document.nets()) {
+        const QString& name = net->name();
+        if (!name.isEmpty() && namedNets.contains(name)) {
+            globalNets[namedNets.value(name)].append(net);
+            continue;
+        }
+        if (!name.isEmpty()) {
+            namedNets.insert(name, globalNets.count());
+        }
+        globalNets.append({ net });
+    }
+
+    // Nets & wires
+    for (const auto& globalNet : globalNets) {
+        const QString& name = globalNet.first()->name();
+
+        int wireCount = 0;
+        int connectorCount = 0;
+        for (const auto& net : globalNet) {
+            const auto& wires = net->wires();
+            wireCount += wires.count();
+            for (const auto& wire : wires) {
+                connectorCount += connectorsPerWire.value(wire.get());
+
+                // Wire ends need to be attached to a connector or to another wire
+                const auto& points = wire->points();
+                for (int index : { 0, points.count() - 1 }) {
+                    if (index < 0 || points.at(index).is_junction() || attachedPoints.contains({ wire.get(), index })) {
+                        continue;
+                    }
+                    issues.append({ Issue::DanglingWireEnd, QStringLiteral("Wire end at (%1, %2) in net \"%3\" is not connected")
+                                                                .arg(points.at(index).x())
+                                                                .arg(points.at(index).y())
+                                                                .arg(name) });
+                }
+            }
+        }
+
+        if (wireCount == 0) {
+            issues.append({ Issue::EmptyNet, QStringLiteral("Net \"%1\" has no wires").arg(name) });
+        } else if (connectorCount == 1) {
+            issues.append({ Issue::SingleConnectorNet, QStringLiteral("Net \"%1\" connects to a single connector only").arg(name) });
+        }
+    }
+
+    return issues;
+}
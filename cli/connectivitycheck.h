@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+namespace QSchematic::Headless
+{
+    class Document;
+}
+
+/**
+ * Basic electrical rule checks on the connectivity of a document.
+ */
+class ConnectivityCheck
+{
+public:
+    struct Issue
+    {
+        enum Type {
+            UnconnectedConnector,
+            DanglingWireEnd,
+            SingleConnectorNet,
+            EmptyNet
+        };
+
+        Type type;
+        QString description;
+    };
+
+    static QVector<Issue> run(const QSchematic::Headless::Document& document);
+
+private:
+    ConnectivityCheck() = default;
+};
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdio>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include "batchprocessor.h"
+
+// Quotes a CSV field, quotes inside of it are doubled
+static QString csvField(const QString& value)
+{
+    return '"' + QString(value).replace('"', QLatin1String("\"\"")) + '"';
+}
+
+static void writeReport(QTextStream& out, const QVector<BatchProcessor::Result>& results)
+{
+    out << "file,status,load_ms,netlist_ms,check_ms,write_ms,total_ms,nodes,nets,issues,peak_kib,error\n";
+    for (const auto& result : results) {
+        out << csvField(result.path) << ','
+            << (result.ok ? "ok" : "failed") << ','
+            << result.loadNsecs / 1.0e6 << ','
+            << result.netlistNsecs / 1.0e6 << ','
+            << result.checkNsecs / 1.0e6 << ','
+            << result.writeNsecs / 1.0e6 << ','
+            << result.totalNsecs / 1.0e6 << ','
+            << result.nodes << ','
+            << result.nets << ','
+            << result.issues.count() << ','
+            << result.peakBytes / 1024 << ','
+            << csvField(result.error) << '\n';
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qschematic-cli");
+
+    // Command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates netlists and checks the connectivity of QSchematic files.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "The schematic files to process.", "files...");
+    QCommandLineOption outputOption({ "o", "output" }, "Write the netlists to <directory>.", "directory");
+    QCommandLineOption formatOption({ "f", "format" }, "Netlist format: json or binary.", "format", "json");
+    QCommandLineOption checkOption({ "c", "check" }, "Run the connectivity checks.");
+    QCommandLineOption jobsOption({ "j", "jobs" }, "Number of files to process concurrently.", "count", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption memoryOption({ "m", "memory-budget" }, "Memory budget per worker in MiB (0: unlimited). Files are aborted once the memory held for them exceeds it.", "mib", "0");
+    QCommandLineOption reportOption({ "r", "report" }, "Write the per-file timing report (CSV) to <file> instead of stdout.", "file");
+    parser.addOptions({ outputOption, formatOption, checkOption, jobsOption, memoryOption, reportOption });
+    parser.process(app);
+
+    const QStringList& files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    // Options
+    BatchProcessor::Options options;
+    options.check = parser.isSet(checkOption);
+    options.workers = std::max(1, parser.value(jobsOption).toInt());
+    options.memoryBudget = parser.value(memoryOption).toLongLong() * 1024 * 1024;
+    const QString& format = parser.value(formatOption);
+    if (format == "json") {
+        options.format = NetlistWriter::Json;
+    } else if (format == "binary") {
+        options.format = NetlistWriter::Binary;
+    } else {
+        fprintf(stderr, "Unknown format: %s\n", qPrintable(format));
+        return 1;
+    }
+    if (parser.isSet(outputOption)) {
+        options.outputDirectory = parser.value(outputOption);
+        if (!QDir().mkpath(options.outputDirectory)) {
+            fprintf(stderr, "Couldn't create output directory: %s\n", qPrintable(options.outputDirectory));
+            return 1;
+        }
+    }
+
+    // Process
+    const auto& results = BatchProcessor(options).run(files);
+
+    // Issues
+    bool success = true;
+    for (const auto& result : results) {
+        if (!result.ok) {
+            fprintf(stderr, "%s: error: %s\n", qPrintable(result.path), qPrintable(result.error));
+            success = false;
+        }
+        for (const auto& issue : result.issues) {
+            fprintf(stderr, "%s: warning: %s\n", qPrintable(result.path), qPrintable(issue));
+            success = false;
+        }
+    }
+
+    // Report
+    if (parser.isSet(reportOption)) {
+        QFile file(parser.value(reportOption));
+        if (!file.open(QFile::WriteOnly | QFile::Text | QFile::Truncate)) {
+            fprintf(stderr, "Couldn't write report: %s\n", qPrintable(file.errorString()));
+            return 1;
+        }
+        QTextStream out(&file);
+        writeReport(out, results);
+    } else {
+        QTextStream out(stdout);
+        writeReport(out, results);
+    }
+
+    return success ? 0 : 1;
+}
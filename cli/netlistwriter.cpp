@@ -0,0 +1,82 @@
+#include <QDataStream>
+#include <QHash>
+#include <QJsonDocument>
+#include <qschematic/headless/node.h>
+#include <qschematic/headless/connector.h>
+#include "netlistwriter.h"
+
+const quint16 BINARY_FORMAT_VERSION = 1;
+
+using namespace QSchematic::Headless;
+
+QByteArray NetlistWriter::write(const Netlist& netlist, Format format)
+{
+    switch (format) {
+    case Json:
+        return toJson(netlist);
+
+    case Binary:
+        return toBinary(netlist);
+    }
+
+    return { };
+}
+
+QString NetlistWriter::fileExtension(Format format)
+{
+    switch (format) {
+    case Json:
+        return QStringLiteral("json");
+
+    case Binary:
+        return QStringLiteral("qsnl");
+    }
+
+    return { };
+}
+
+QByteArray NetlistWriter::toJson(const Netlist& netlist)
+{
+    return QJsonDocument(netlist.toJson()).toJson(QJsonDocument::Compact);
+}
+
+static void writeString(QDataStream& stream, const QString& string)
+{
+    const QByteArray& utf8 = string.toUtf8();
+    stream << static_cast<quint32>(utf8.size());
+    stream.writeRawData(utf8.constData(), utf8.size());
+}
+
+QByteArray NetlistWriter::toBinary(const Netlist& netlist)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    // Header
+    stream.writeRawData("QSNL", 4);
+    stream << BINARY_FORMAT_VERSION;
+
+    // Nodes are referenced by index
+    const auto& nodes = netlist.nodes();
+    QHash<const Node*, quint32> nodeIndices;
+    nodeIndices.reserve(static_cast<int>(nodes.size()));
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        nodeIndices.insert(nodes[i], static_cast<quint32>(i));
+    }
+    stream << static_cast<quint32>(nodes.size());
+
+    // Nets
+    const auto& nets = netlist.nets();
+    stream << static_cast<quint32>(nets.size());
+    for (const auto& net : nets) {
+        writeString(stream, net.name);
+        stream << static_cast<quint32>(net.connectors.size());
+        for (const Connector* connector : net.connectors) {
+            stream << nodeIndices.value(connector->node());
+            writeString(stream, connector->text());
+        }
+    }
+
+    return data;
+}
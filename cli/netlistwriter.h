@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QByteArray>
+#include <qschematic/headless/netlistgenerator.h>
+
+/**
+ * Serializes headless netlists. The binary format is a compact alternative to
+ * JSON for large batch runs:
+ *
+ *   magic "QSNL", quint16 version
+ *   quint32 node count
+ *   quint32 net count, then per net:
+ *     name (quint32 length + UTF-8), quint32 connector count, then per connector:
+ *       quint32 node index, text (quint32 length + UTF-8)
+ *
+ * All integers are big endian.
+ */
+class NetlistWriter
+{
+public:
+    enum Format {
+        Json,
+        Binary
+    };
+
+    static QByteArray write(const QSchematic::Headless::Netlist& netlist, Format format);
+    static QString fileExtension(Format format);
+
+private:
+    NetlistWriter() = default;
+
+    static QByteArray toJson(const QSchematic::Headless::Netlist& netlist);
+    static QByteArray toBinary(const QSchematic::Headless::Netlist& netlist);
+};
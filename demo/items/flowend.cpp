@@ -1,5 +1,4 @@
 #include <QPainter>
-#include <QGraphicsDropShadowEffect>
 
 #include "flowend.h"
 #include "itemtypes.h"
@@ -35,11 +34,10 @@ FlowEnd::FlowEnd() :
     addConnector(connector);
 
     // Drop shadow
-    auto graphicsEffect = new QGraphicsDropShadowEffect(this);
-    graphicsEffect->setOffset(SHADOW_OFFSET);
-    graphicsEffect->setBlurRadius(SHADOW_BLUR_RADIUS);
-    graphicsEffect->setColor(SHADOW_COLOR);
-    setGraphicsEffect(graphicsEffect);
+    setShadowEnabled(true);
+    setShadowOffset(QPointF(SHADOW_OFFSET, SHADOW_OFFSET));
+    setShadowBlurRadius(SHADOW_BLUR_RADIUS);
+    setShadowColor(SHADOW_COLOR);
 
     // Misc
     setSize(60, 40);
@@ -77,9 +75,18 @@ void FlowEnd::copyAttributes(FlowEnd& dest) const
 QRectF FlowEnd::boundingRect() const
 {
     QRectF rect = _symbolPolygon.boundingRect();
-    qreal adj = SHADOW_BLUR_RADIUS;
+    qreal adj = PEN_WIDTH / 2;
 
-    return rect.adjusted(-adj, -adj, adj, adj);
+    return rect.adjusted(-adj, -adj, adj, adj).united(shadowRect());
+}
+
+QPainterPath FlowEnd::shadowPath() const
+{
+    QPainterPath path;
+    path.addPolygon(_symbolPolygon);
+    path.closeSubpath();
+
+    return path;
 }
 
 void FlowEnd::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
@@ -87,6 +94,9 @@ void FlowEnd::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, Q
     Q_UNUSED(option)
     Q_UNUSED(widget)
 
+    // Shadow
+    paintShadow(*painter);
+
     // Symbol
     {
         QPen pen(Qt::SolidLine);
@@ -21,6 +21,7 @@ public:
 
 protected:
     void copyAttributes(FlowEnd& dest) const;
+    virtual QPainterPath shadowPath() const override;
 
 private:
     QPolygon _symbolPolygon;
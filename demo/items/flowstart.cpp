@@ -1,5 +1,4 @@
 #include <QPainter>
-#include <QGraphicsDropShadowEffect>
 
 #include "flowstart.h"
 #include "itemtypes.h"
@@ -34,11 +33,10 @@ FlowStart::FlowStart() :
     addConnector(connector);
 
     // Drop shadow
-    auto graphicsEffect = new QGraphicsDropShadowEffect(this);
-    graphicsEffect->setOffset(SHADOW_OFFSET);
-    graphicsEffect->setBlurRadius(SHADOW_BLUR_RADIUS);
-    graphicsEffect->setColor(SHADOW_COLOR);
-    setGraphicsEffect(graphicsEffect);
+    setShadowEnabled(true);
+    setShadowOffset(QPointF(SHADOW_OFFSET, SHADOW_OFFSET));
+    setShadowBlurRadius(SHADOW_BLUR_RADIUS);
+    setShadowColor(SHADOW_COLOR);
 
     // Misc
     setSize(60, 40);
@@ -76,9 +74,18 @@ void FlowStart::copyAttributes(FlowStart& dest) const
 QRectF FlowStart::boundingRect() const
 {
     QRectF rect = _symbolPolygon.boundingRect();
-    qreal adj = SHADOW_BLUR_RADIUS;
+    qreal adj = PEN_WIDTH / 2;
 
-    return rect.adjusted(-adj, -adj, adj, adj);
+    return rect.adjusted(-adj, -adj, adj, adj).united(shadowRect());
+}
+
+QPainterPath FlowStart::shadowPath() const
+{
+    QPainterPath path;
+    path.addPolygon(_symbolPolygon);
+    path.closeSubpath();
+
+    return path;
 }
 
 void FlowStart::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
@@ -86,6 +93,9 @@ void FlowStart::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
     Q_UNUSED(option)
     Q_UNUSED(widget)
 
+    // Shadow
+    paintShadow(*painter);
+
     // Symbol
     {
         QPen pen(Qt::SolidLine);
@@ -19,6 +19,7 @@ public:
 
 protected:
     void copyAttributes(FlowStart& dest) const;
+    virtual QPainterPath shadowPath() const override;
 
 private:
     QPolygon _symbolPolygon;
@@ -2,7 +2,6 @@
 #include <QMenu>
 #include <QGraphicsSceneContextMenuEvent>
 #include <QInputDialog>
-#include <QGraphicsDropShadowEffect>
 
 #include "qschematic/scene.h"
 #include "qschematic/items/label.h"
@@ -48,11 +47,10 @@ Operation::Operation(int type, QGraphicsItem* parent) :
     setConnectorsSnapToGrid(true);
 
     // Drop shadow
-    auto graphicsEffect = new QGraphicsDropShadowEffect(this);
-    graphicsEffect->setOffset(SHADOW_OFFSET);
-    graphicsEffect->setBlurRadius(SHADOW_BLUR_RADIUS);
-    graphicsEffect->setColor(SHADOW_COLOR);
-    setGraphicsEffect(graphicsEffect);
+    setShadowEnabled(true);
+    setShadowOffset(QPointF(SHADOW_OFFSET, SHADOW_OFFSET));
+    setShadowBlurRadius(SHADOW_BLUR_RADIUS);
+    setShadowColor(SHADOW_COLOR);
 }
 
 Operation::~Operation()
@@ -127,6 +125,9 @@ void Operation::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
         painter->drawRect(boundingRect());
     }
 
+    // Shadow
+    paintShadow(*painter);
+
     // Body
     {
         // Common stuff
@@ -6,15 +6,23 @@
 
 #include "itemslibrarymodel.h"
 #include "iteminfo.h"
+#include "itemspreviewcache.h"
 #include "../items/operation.h"
 #include "../items/operationdemo1.h"
 #include "../items/flowstart.h"
 #include "../items/flowend.h"
 
-ItemsLibraryModel::ItemsLibraryModel(QObject* parent) : QAbstractItemModel(parent)
+ItemsLibraryModel::ItemsLibraryModel(ItemsPreviewCache* previewCache, QObject* parent) :
+    QAbstractItemModel(parent),
+    _previewCache(previewCache)
 {
     _rootItem = new ItemsLibraryModelItem<itemType>(Root, nullptr);
 
+    // Icons are rendered asynchronously
+    if (_previewCache) {
+        connect(_previewCache, &ItemsPreviewCache::iconChanged, this, &ItemsLibraryModel::iconChanged);
+    }
+
     createModel();
 }
 
@@ -71,6 +79,28 @@ void ItemsLibraryModel::addTreeItem(const QString& name, const QIcon& icon, cons
     beginInsertRows(QModelIndex(), _rootItem->childCount(), _rootItem->childCount());
     parent->appendChild(newItem);
     endInsertRows();
+
+    // Render the icon & drag preview
+    if (_previewCache) {
+        _previewCache->add(item);
+    }
+}
+
+void ItemsLibraryModel::iconChanged(const QSchematic::Item* item)
+{
+    for (auto categoryItem : _rootItem->children()) {
+        for (auto modelItem : categoryItem->children()) {
+            ItemInfo* itemInfo = static_cast<ItemInfo*>(modelItem->data());
+            if (!itemInfo || itemInfo->item != item) {
+                continue;
+            }
+
+            itemInfo->icon = _previewCache->icon(item);
+
+            const QModelIndex& index = createIndex(modelItem->row(), 0, modelItem);
+            emit dataChanged(index, index, { Qt::DecorationRole });
+        }
+    }
 }
 
 const QSchematic::Item* ItemsLibraryModel::itemFromIndex(const QModelIndex& index) const
@@ -182,6 +212,10 @@ QVariant ItemsLibraryModel::data(const QModelIndex& index, int role) const
         case Qt::DisplayRole:
             Q_ASSERT(itemInfo);
             return itemInfo->name;
+
+        case Qt::DecorationRole:
+            Q_ASSERT(itemInfo);
+            return itemInfo->icon;
         }
     }
 
@@ -8,6 +8,8 @@ namespace QSchematic {
     class Item;
 }
 
+class ItemsPreviewCache;
+
 class ItemsLibraryModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -25,7 +27,7 @@ public:
     };
     Q_ENUM(LibraryItems)
 
-    explicit ItemsLibraryModel(QObject* parent = nullptr);
+    explicit ItemsLibraryModel(ItemsPreviewCache* previewCache, QObject* parent = nullptr);
     virtual ~ItemsLibraryModel() override;
 
     const QSchematic::Item* itemFromIndex(const QModelIndex& index) const;
@@ -43,7 +45,9 @@ private:
     typedef LibraryItems itemType;
 
     void createModel();
+    void iconChanged(const QSchematic::Item* item);
     void addTreeItem(const QString& name, const QIcon& icon, const QSchematic::Item* item, ItemsLibraryModelItem<itemType>* parent);
 
     ItemsLibraryModelItem<itemType>* _rootItem;
+    ItemsPreviewCache* _previewCache;
 };
@@ -5,11 +5,14 @@
 #include "qschematic/items/itemmimedata.h"
 
 #include "itemslibraryview.h"
+#include "itemspreviewcache.h"
+#include "itemslibrarymodel.h"
 
 ItemsLibraryView::ItemsLibraryView(QWidget* parent) : QTreeView(parent)
 {
     // Initialization
     _scale = 1.0;
+    _previewCache = nullptr;
 
     // Configuration
     setDragDropMode(QAbstractItemView::DragOnly);
@@ -19,9 +22,18 @@ ItemsLibraryView::ItemsLibraryView(QWidget* parent) : QTreeView(parent)
     setIconSize(QSize(28, 28));
 }
 
+void ItemsLibraryView::setPreviewCache(ItemsPreviewCache* previewCache)
+{
+    _previewCache = previewCache;
+}
+
 void ItemsLibraryView::setPixmapScale(qreal scale)
 {
     _scale = scale;
+
+    if (_previewCache) {
+        _previewCache->setDragScale(scale);
+    }
 }
 
 void ItemsLibraryView::startDrag(Qt::DropActions supportedActions)
@@ -45,10 +57,22 @@ void ItemsLibraryView::startDrag(Qt::DropActions supportedActions)
 
     // Create the drag object
     QDrag* drag = new QDrag(this);
-    QPointF hotSpot;
     drag->setMimeData(data);
-    drag->setPixmap(m->item()->toPixmap(hotSpot, _scale));
-    drag->setHotSpot(hotSpot.toPoint());
+
+    // Use the pre-rendered preview if available
+    const ItemsPreviewCache::Preview* preview = nullptr;
+    if (_previewCache) {
+        const auto item = static_cast<const ItemsLibraryModel*>(model())->itemFromIndex(indexes.first());
+        preview = _previewCache->dragPreview(item);
+    }
+    if (preview) {
+        drag->setPixmap(QPixmap::fromImage(preview->image));
+        drag->setHotSpot(preview->hotSpot.toPoint());
+    } else {
+        QPointF hotSpot;
+        drag->setPixmap(m->item()->toPixmap(hotSpot, _scale));
+        drag->setHotSpot(hotSpot.toPoint());
+    }
 
     // Execute the drag
     drag->exec(supportedActions, Qt::CopyAction);
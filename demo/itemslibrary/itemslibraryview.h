@@ -2,6 +2,8 @@
 
 #include <QTreeView>
 
+class ItemsPreviewCache;
+
 class ItemsLibraryView : public QTreeView
 {
     Q_OBJECT
@@ -11,10 +13,12 @@ public:
     explicit ItemsLibraryView(QWidget* parent = nullptr);
     virtual ~ItemsLibraryView() override = default;
 
+    void setPreviewCache(ItemsPreviewCache* previewCache);
     void setPixmapScale(qreal scale);
 
 private:
     virtual void startDrag(Qt::DropActions supportedActions) override;
 
     qreal _scale;
+    ItemsPreviewCache* _previewCache;
 };
@@ -0,0 +1,269 @@
+#include <sstream>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <gpds/archiver_xml.hpp>
+
+#include "qschematic/items/item.h"
+#include "qschematic/utils/taskscheduler.h"
+
+#include "itemspreviewcache.h"
+
+const qreal DRAG_SCALE_STEP         = 0.25;
+const QVector<qreal> ICON_DPRS      = { 1.0, 2.0 };
+const char* HOT_SPOT_KEY            = "hotspot";
+
+using namespace QSchematic;
+
+ItemsPreviewCache::ItemsPreviewCache(QObject* parent) :
+    QObject(parent),
+    _iconSize(28, 28),
+    _dragScale(1.0),
+    _generation(std::make_shared<int>(0))
+{
+    // Disk cache
+    _directory = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(QStringLiteral("itemslibrary"));
+    QDir().mkpath(_directory);
+}
+
+ItemsPreviewCache::~ItemsPreviewCache()
+{
+    // Pending results get discarded
+    _generation.reset();
+}
+
+void ItemsPreviewCache::setIconSize(const QSize& size)
+{
+    if (_iconSize == size) {
+        return;
+    }
+
+    _iconSize = size;
+    invalidate();
+}
+
+void ItemsPreviewCache::setSettings(const Settings& settings)
+{
+    _settings = settings;
+    invalidate();
+}
+
+/**
+ * Sets the scale of the drag previews. Previews are rendered per scale bucket,
+ * buckets which haven't been rendered yet are scheduled in the background.
+ */
+void ItemsPreviewCache::setDragScale(qreal scale)
+{
+    _dragScale = scale;
+
+    const int bucket = scaleBucket(scale);
+    for (auto it = _entries.cbegin(); it != _entries.cend(); it++) {
+        if (!it->dragPreviews.contains(bucket)) {
+            render(it.key(), false);
+        }
+    }
+}
+
+void ItemsPreviewCache::add(const Item* item)
+{
+    // Sanity check
+    if (!item || _entries.contains(item)) {
+        return;
+    }
+
+    Entry entry;
+    entry.contentKey = contentKey(*item);
+    _entries.insert(item, entry);
+
+    render(item, true);
+    render(item, false);
+}
+
+QIcon ItemsPreviewCache::icon(const Item* item) const
+{
+    return _entries.value(item).icon;
+}
+
+/**
+ * Returns the drag preview for the current drag scale or nullptr if it hasn't
+ * been rendered yet.
+ */
+const ItemsPreviewCache::Preview* ItemsPreviewCache::dragPreview(const Item* item) const
+{
+    auto it = _entries.constFind(item);
+    if (it == _entries.constEnd()) {
+        return nullptr;
+    }
+
+    auto previewIt = it->dragPreviews.constFind(scaleBucket(_dragScale));
+    if (previewIt == it->dragPreviews.constEnd()) {
+        return nullptr;
+    }
+
+    return &previewIt.value();
+}
+
+void ItemsPreviewCache::render(const Item* item, bool icon)
+{
+    auto it = _entries.constFind(item);
+    if (it == _entries.constEnd()) {
+        return;
+    }
+
+    // Parameters
+    const int bucket = scaleBucket(_dragScale);
+    const qreal dragScale = bucket * DRAG_SCALE_STEP;
+    const QSize iconSize = _iconSize;
+    const QVector<qreal>& dprs = icon ? ICON_DPRS : QVector<qreal>{ qApp->devicePixelRatio() };
+    QString baseName;
+    if (icon) {
+        baseName = QStringLiteral("%1_icon%2x%3").arg(it->contentKey).arg(iconSize.width()).arg(iconSize.height());
+    } else {
+        baseName = QStringLiteral("%1_drag%2").arg(it->contentKey).arg(bucket);
+    }
+    const QString& basePath = QDir(_directory).filePath(baseName);
+
+    // Render a private copy so that the prototype isn't touched by other threads
+    std::shared_ptr<Item> copy = item->deepCopy();
+    copy->setSettings(_settings);
+
+    std::weak_ptr<int> generation = _generation;
+    QPointer<ItemsPreviewCache> self(this);
+
+    auto task = [copy = std::move(copy), item, icon, bucket, dragScale, iconSize, dprs, basePath, generation, self]() mutable {
+        QVector<Preview> previews;
+        for (qreal dpr : dprs) {
+            const QString& path = QStringLiteral("%1@%2x.png").arg(basePath).arg(dpr);
+
+            // Disk cache
+            Preview preview;
+            if (preview.image.load(path)) {
+                preview.image.setDevicePixelRatio(dpr);
+                const QStringList& hotSpot = preview.image.text(HOT_SPOT_KEY).split(';');
+                if (hotSpot.count() == 2) {
+                    preview.hotSpot = QPointF(hotSpot.at(0).toDouble(), hotSpot.at(1).toDouble());
+                }
+                previews << preview;
+                continue;
+            }
+
+            // Render
+            if (icon) {
+                // Same extent as rendered by Item::toImage()
+                QRectF rect = copy->boundingRect().united(copy->childrenBoundingRect());
+                rect.setWidth(rect.width() - rect.x());
+                rect.setHeight(rect.height() - rect.y());
+                if (rect.isEmpty()) {
+                    continue;
+                }
+                const qreal scale = qMin(iconSize.width() / rect.width(), iconSize.height() / rect.height());
+                const QImage& image = copy->toImage(preview.hotSpot, scale, dpr);
+
+                // Center within the icon
+                preview.image = QImage(iconSize * dpr, QImage::Format_ARGB32_Premultiplied);
+                preview.image.setDevicePixelRatio(dpr);
+                preview.image.fill(Qt::transparent);
+                QPainter painter(&preview.image);
+                painter.drawImage(QPointF((iconSize.width() - image.width() / dpr) / 2, (iconSize.height() - image.height() / dpr) / 2), image);
+            } else {
+                preview.image = copy->toImage(preview.hotSpot, dragScale, dpr);
+                preview.image.setText(HOT_SPOT_KEY, QStringLiteral("%1;%2").arg(preview.hotSpot.x()).arg(preview.hotSpot.y()));
+            }
+
+            // Store on disk
+            QSaveFile file(path);
+            if (file.open(QIODevice::WriteOnly) && preview.image.save(&file, "PNG")) {
+                file.commit();
+            }
+
+            previews << preview;
+        }
+
+        // Hand the results to the GUI thread. The copy is destroyed there as well.
+        QMetaObject::invokeMethod(qApp, [copy = std::move(copy), item, icon, bucket, previews, generation, self]() mutable {
+            copy.reset();
+            if (!self || generation.expired()) {
+                return;
+            }
+            self->store(item, icon, bucket, previews);
+        }, Qt::QueuedConnection);
+    };
+
+    TaskScheduler::instance().schedule(std::move(task), icon ? TaskScheduler::Interactive : TaskScheduler::Background);
+}
+
+void ItemsPreviewCache::store(const Item* item, bool icon, int bucket, const QVector<Preview>& previews)
+{
+    auto it = _entries.find(item);
+    if (it == _entries.end() || previews.isEmpty()) {
+        return;
+    }
+
+    if (icon) {
+        QIcon newIcon;
+        for (const auto& preview : previews) {
+            newIcon.addPixmap(QPixmap::fromImage(preview.image));
+        }
+        it->icon = newIcon;
+
+        emit iconChanged(item);
+    } else {
+        it->dragPreviews.insert(bucket, previews.first());
+    }
+}
+
+/**
+ * Discards everything rendered so far and renders the icons & drag previews
+ * again. Results of renders which are still running are ignored.
+ */
+void ItemsPreviewCache::invalidate()
+{
+    _generation = std::make_shared<int>(0);
+
+    for (auto it = _entries.begin(); it != _entries.end(); it++) {
+        it->contentKey = contentKey(*it.key());
+        it->icon = QIcon();
+        it->dragPreviews.clear();
+
+        render(it.key(), true);
+        render(it.key(), false);
+    }
+}
+
+/**
+ * Builds the key identifying the rendered content of an item: the type, a hash
+ * of the serialized item and a hash of the settings affecting the rendering.
+ */
+QString ItemsPreviewCache::contentKey(const Item& item) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // Content
+    {
+        gpds::archiver_xml ar;
+        std::stringstream stream;
+        ar.save(stream, item.to_container(), "item");
+        hash.addData(QByteArray::fromStdString(stream.str()));
+    }
+
+    // Settings
+    {
+        QByteArray settings;
+        QDataStream stream(&settings, QIODevice::WriteOnly);
+        stream << _settings.debug << _settings.gridSize << _settings.gridPointSize << _settings.highlightRectPadding
+               << _settings.resizeHandleSize << _settings.antialiasing;
+        hash.addData(settings);
+    }
+
+    return QStringLiteral("%1_%2").arg(item.type()).arg(QString::fromLatin1(hash.result().toHex()));
+}
+
+int ItemsPreviewCache::scaleBucket(qreal scale)
+{
+    return qMax(1, qRound(scale / DRAG_SCALE_STEP));
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QObject>
+#include <QPointF>
+#include <QVector>
+
+#include "qschematic/settings.h"
+
+namespace QSchematic {
+    class Item;
+}
+
+/**
+ * Pre-renders the library icons and drag previews of the prototype items on the
+ * QSchematic::TaskScheduler. The rendered images are kept in memory and on disk,
+ * keyed by the item type, a hash of the item's content and the settings.
+ */
+class ItemsPreviewCache : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ItemsPreviewCache)
+
+public:
+    struct Preview
+    {
+        QImage image;
+        QPointF hotSpot;
+    };
+
+    explicit ItemsPreviewCache(QObject* parent = nullptr);
+    virtual ~ItemsPreviewCache() override;
+
+    void setIconSize(const QSize& size);
+    void setSettings(const QSchematic::Settings& settings);
+    void setDragScale(qreal scale);
+    void add(const QSchematic::Item* item);
+    QIcon icon(const QSchematic::Item* item) const;
+    const Preview* dragPreview(const QSchematic::Item* item) const;
+
+signals:
+    void iconChanged(const QSchematic::Item* item);
+
+private:
+    struct Entry
+    {
+        QString contentKey;
+        QIcon icon;
+        QHash<int, Preview> dragPreviews;       // By scale bucket
+    };
+
+    void render(const QSchematic::Item* item, bool icon);
+    void store(const QSchematic::Item* item, bool icon, int bucket, const QVector<Preview>& previews);
+    void invalidate();
+    QString contentKey(const QSchematic::Item& item) const;
+    static int scaleBucket(qreal scale);
+
+    QSchematic::Settings _settings;
+    QSize _iconSize;
+    qreal _dragScale;
+    QHash<const QSchematic::Item*, Entry> _entries;
+    QString _directory;
+    std::shared_ptr<int> _generation;           // Results of previous generations are discarded
+};
@@ -3,14 +3,20 @@
 #include "itemsslibrarywidget.h"
 #include "itemslibrarymodel.h"
 #include "itemslibraryview.h"
+#include "itemspreviewcache.h"
 
 ItemsLibraryWidget::ItemsLibraryWidget(QWidget* parent) : QWidget(parent)
 {
-    // Model
-    _model = new ItemsLibraryModel(this);
-
     // View
     _view = new ItemsLibraryView(this);
+
+    // Preview cache
+    _previewCache = new ItemsPreviewCache(this);
+    _previewCache->setIconSize(_view->iconSize());
+    _view->setPreviewCache(_previewCache);
+
+    // Model
+    _model = new ItemsLibraryModel(_previewCache, this);
     _view->setModel(_model);
     connect(_view, &ItemsLibraryView::clicked, this, &ItemsLibraryWidget::itemClickedSlot);
 
@@ -44,6 +50,11 @@ void ItemsLibraryWidget::itemClickedSlot(const QModelIndex& index)
     emit itemClicked(item);
 }
 
+void ItemsLibraryWidget::setSettings(const QSchematic::Settings& settings)
+{
+    _previewCache->setSettings(settings);
+}
+
 void ItemsLibraryWidget::expandAll()
 {
     _view->expandAll();
@@ -4,10 +4,12 @@
 
 namespace QSchematic {
     class Item;
+    class Settings;
 }
 
 class ItemsLibraryModel;
 class ItemsLibraryView;
+class ItemsPreviewCache;
 
 class ItemsLibraryWidget : public QWidget
 {
@@ -19,6 +21,7 @@ public:
     virtual ~ItemsLibraryWidget() override = default;
 
     void expandAll();
+    void setSettings(const QSchematic::Settings& settings);
 
 signals:
     void itemClicked(const QSchematic::Item* item);
@@ -30,6 +33,7 @@ private slots:
     void itemClickedSlot(const QModelIndex& index);
 
 private:
+    ItemsPreviewCache* _previewCache;
     ItemsLibraryModel* _model;
     ItemsLibraryView* _view;
 };
@@ -80,6 +80,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Item library
     _itemLibraryWidget = new ItemsLibraryWidget(this);
+    _itemLibraryWidget->setSettings(_settings);
     connect(_view, &QSchematic::View::zoomChanged, _itemLibraryWidget, &ItemsLibraryWidget::setPixmapScale);
     QDockWidget* itemLibraryDock = new QDockWidget;
     itemLibraryDock->setWindowTitle("Items");
@@ -310,7 +311,7 @@ void MainWindow::createActions()
         QSchematic::NetlistGenerator::generate(netlist, *_scene);
 
         Q_ASSERT( _netlistViewer );
-        _netlistViewer->setNetlist( netlist );
+        _netlistViewer->setNetlist( std::move( netlist ) );
     });
 
     // Debug mode
@@ -328,6 +329,7 @@ void MainWindow::settingsChanged()
 {
     _view->setSettings(_settings);
     _scene->setSettings(_settings);
+    _itemLibraryWidget->setSettings(_settings);
 }
 
 void MainWindow::print()
@@ -20,8 +20,8 @@ NetlistViewer::NetlistViewer( QWidget* parent ) :
     setLayout( layout );
 }
 
-void NetlistViewer::setNetlist( const QSchematic::Netlist<Operation*, OperationConnector*>& netlist )
+void NetlistViewer::setNetlist( QSchematic::Netlist<Operation*, OperationConnector*> netlist )
 {
     Q_ASSERT( _model );
-    _model->setNetlist( netlist );
+    _model->setNetlist( std::move( netlist ) );
 }
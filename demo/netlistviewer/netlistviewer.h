@@ -14,7 +14,7 @@ class NetlistViewer : public QWidget
 public:
     NetlistViewer( QWidget* parent = nullptr );
 
-    void setNetlist(const QSchematic::Netlist<Operation*, OperationConnector*>& netlist );
+    void setNetlist( QSchematic::Netlist<Operation*, OperationConnector*> netlist );
 
 private:
     Q_OBJECT
@@ -1,66 +1,432 @@
 #include "netlistviewermodel.h"
-#include "common/treeitem.h"
 #include "items/operation.h"
 #include "items/operationconnector.h"
 
+const int FETCH_BATCH_SIZE = 256;
+
+// Internal ids: 0 for nets, (net id << 2) for groups and (net id << 2 | group + 1) for group members
+const quintptr GROUP_MASK = 0x3;
+
 NetlistViewerModel::NetlistViewerModel( QObject* parent ) :
-    TreeModel( parent )
+    QAbstractItemModel( parent ),
+    _nextId( 1 )
 {
-    // Set header
-    _rootItem->setData( { "Name", "Address" } );
 }
 
-void NetlistViewerModel::setNetlist( const QSchematic::Netlist<Operation*, OperationConnector*>& netlist )
+void NetlistViewerModel::setNetlist( Netlist netlist )
 {
-    // Clear previous content
-    clear();
+    const auto& oldNets = _netlist.nets();
+    const auto& newNets = netlist.nets();
+    const int newNetCount = static_cast<int>( newNets.size() );
 
-    // Make sure that there are nets available
-    if ( netlist.nets().empty() ) {
-        return;
+    // Map the net names to their position in the new netlist
+    QHash<QString, int> newPositions;
+    newPositions.reserve( newNetCount );
+    for ( int i = 0; i < newNetCount; i++ ) {
+        newPositions.insert( newNets[i].name, i );
+    }
+
+    // Figure out which of the fetched rows remain. They have to stay in netlist order.
+    const int previouslyFetched = static_cast<int>( _rows.size() );
+    std::vector<int> newPosition( _rows.size(), -1 );
+    int lastPosition = -1;
+    for ( std::size_t row = 0; row < _rows.size(); row++ ) {
+        const int position = newPositions.value( oldNets[_rows[row].net].name, -1 );
+        if ( position > lastPosition ) {
+            newPosition[row] = position;
+            lastPosition = position;
+        }
+    }
+
+    // Remove the rows of nets that are gone
+    for ( int row = static_cast<int>( _rows.size() )-1; row >= 0; ) {
+        if ( newPosition[row] >= 0 ) {
+            row--;
+            continue;
+        }
+
+        int first = row;
+        while ( first > 0 && newPosition[first-1] < 0 ) {
+            first--;
+        }
+        removeNetRows( first, row );
+        newPosition.erase( newPosition.begin() + first, newPosition.begin() + row + 1 );
+        row = first - 1;
     }
 
-    // Create three model
+    // Remove the fetched members of groups that changed. They get fetched again below.
+    struct Refetch
     {
-        Q_ASSERT( _rootItem );
-        beginInsertRows( QModelIndex(), 0, static_cast<int>( netlist.nets().size() )-1 );
-
-        for ( const auto& net : netlist.nets() ) {
-
-            // Net
-            TreeItem* netItem = new TreeItem( { net.name, pointerToString( &net ) } );
-            _rootItem->appendChild( netItem );
-
-            // Nodes
-            TreeItem* nodesItem = new TreeItem( { QStringLiteral( "Nodes" ), "" } );
-            netItem->appendChild( nodesItem );
-            for ( const auto& node : net.nodes ) {
-                Q_ASSERT( node );
-                TreeItem* nodeItem = new TreeItem( { node->text(), pointerToString( &node ) } );
-                nodesItem->appendChild( nodeItem );
+        quint32 id;
+        int group;
+        int count;
+    };
+    std::vector<Refetch> refetches;
+    for ( std::size_t row = 0; row < _rows.size(); row++ ) {
+        const Net& oldNet = oldNets[_rows[row].net];
+        const Net& newNet = newNets[newPosition[row]];
+        for ( int group = 0; group < GroupCount; group++ ) {
+            if ( groupEquals( oldNet, newNet, group ) ) {
+                continue;
             }
 
-            // Connectors
-            TreeItem* connectorsItem = new TreeItem( { QStringLiteral( "Connectors" ), "" } );
-            netItem->appendChild( connectorsItem );
-            for ( const auto& connector : net.connectors ) {
-                Q_ASSERT( connector );
-                Q_ASSERT( connector->label() );
-                TreeItem* connectorItem = new TreeItem( { connector->label()->text(), pointerToString( connector ) } );
-                connectorsItem->appendChild( connectorItem );
-            }
+            refetches.push_back( { _rows[row].id, group, _rows[row].fetched[group] } );
+            removeGroupRows( static_cast<int>( row ), group );
+        }
+    }
 
-            // Wires
-            TreeItem* wiresItem = new TreeItem( { QStringLiteral( "Wires" ), "" } );
-            netItem->appendChild( wiresItem );
-            for ( const auto& wire : net.wires ) {
-                Q_ASSERT( wire );
-                TreeItem* wireItem = new TreeItem( { "Wire", pointerToString( wire ) } );
-                wiresItem->appendChild( wireItem );
-            }
+    // Switch to the new netlist
+    _netlist = std::move( netlist );
+    for ( std::size_t row = 0; row < _rows.size(); row++ ) {
+        _rows[row].net = newPosition[row];
+    }
+
+    // Insert the rows of new nets so that the fetched rows are a prefix of the netlist again
+    const int target = std::max( lastPosition + 1, std::min( previouslyFetched, newNetCount ) );
+    int row = 0;
+    for ( int position = 0; position < target; ) {
+        if ( row < static_cast<int>( _rows.size() ) && _rows[row].net == position ) {
+            row++;
+            position++;
+            continue;
+        }
+
+        const int next = row < static_cast<int>( _rows.size() ) ? _rows[row].net : target;
+        insertNetRows( row, position, next-1 );
+        row += next - position;
+        position = next;
+    }
+
+    // Fetch the changed groups again and notify about their changed children
+    for ( const Refetch& refetch : refetches ) {
+        const int netRow = _rowsById.value( refetch.id, -1 );
+        Q_ASSERT( netRow >= 0 );
+
+        const int count = std::min( refetch.count, groupSize( *net( netRow ), refetch.group ) );
+        if ( count > 0 ) {
+            insertGroupRows( netRow, refetch.group, count );
+        }
+
+        const QModelIndex& groupIndex = index( refetch.group, 0, index( netRow, 0 ) );
+        emit dataChanged( groupIndex, groupIndex );
+    }
+
+    // The addresses of the remaining nets changed
+    if ( !_rows.empty() ) {
+        emit dataChanged( index( 0, 1 ), index( static_cast<int>( _rows.size() )-1, 1 ), { Qt::DisplayRole } );
+    }
+}
+
+QVariant NetlistViewerModel::data( const QModelIndex& index, int role ) const
+{
+    if ( !index.isValid() || role != Qt::DisplayRole ) {
+        return QVariant();
+    }
+
+    const quintptr internalId = index.internalId();
+
+    // Net
+    if ( internalId == 0 ) {
+        const Net* n = net( index.row() );
+        Q_ASSERT( n );
+        return index.column() == 0 ? QVariant( n->name ) : QVariant( pointerToString( n ) );
+    }
+
+    // Group
+    if ( ( internalId & GROUP_MASK ) == 0 ) {
+        if ( index.column() != 0 ) {
+            return QString();
+        }
+
+        switch ( index.row() ) {
+        case Nodes:
+            return QStringLiteral( "Nodes" );
+        case Connectors:
+            return QStringLiteral( "Connectors" );
+        case Wires:
+            return QStringLiteral( "Wires" );
+        default:
+            return QVariant();
+        }
+    }
+
+    // Group member
+    const Net* n = net( netRow( internalId ) );
+    Q_ASSERT( n );
+    const std::size_t row = static_cast<std::size_t>( index.row() );
+    switch ( static_cast<int>( internalId & GROUP_MASK ) - 1 ) {
+    case Nodes:
+    {
+        const auto& node = n->nodes.at( row );
+        Q_ASSERT( node );
+        return index.column() == 0 ? QVariant( node->text() ) : QVariant( pointerToString( node ) );
+    }
+
+    case Connectors:
+    {
+        const auto& connector = n->connectors.at( row );
+        Q_ASSERT( connector );
+        Q_ASSERT( connector->label() );
+        return index.column() == 0 ? QVariant( connector->label()->text() ) : QVariant( pointerToString( connector ) );
+    }
+
+    case Wires:
+    {
+        const auto& wire = n->wires.at( row );
+        Q_ASSERT( wire );
+        return index.column() == 0 ? QVariant( QStringLiteral( "Wire" ) ) : QVariant( pointerToString( wire ) );
+    }
+
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags NetlistViewerModel::flags( const QModelIndex& index ) const
+{
+    if ( !index.isValid() ) {
+        return Qt::NoItemFlags;
+    }
+
+    return QAbstractItemModel::flags( index );
+}
+
+QVariant NetlistViewerModel::headerData( int section, Qt::Orientation orientation, int role ) const
+{
+    if ( orientation != Qt::Horizontal || role != Qt::DisplayRole ) {
+        return QVariant();
+    }
+
+    switch ( section ) {
+    case 0:
+        return QStringLiteral( "Name" );
+    case 1:
+        return QStringLiteral( "Address" );
+    default:
+        return QVariant();
+    }
+}
+
+QModelIndex NetlistViewerModel::index( int row, int column, const QModelIndex& parent ) const
+{
+    if ( !hasIndex( row, column, parent ) ) {
+        return QModelIndex();
+    }
+
+    // Net
+    if ( !parent.isValid() ) {
+        return createIndex( row, column, quintptr( 0 ) );
+    }
+
+    // Group
+    if ( parent.internalId() == 0 ) {
+        return createIndex( row, column, quintptr( _rows[parent.row()].id ) << 2 );
+    }
+
+    // Group member
+    return createIndex( row, column, parent.internalId() | quintptr( parent.row() + 1 ) );
+}
+
+QModelIndex NetlistViewerModel::parent( const QModelIndex& index ) const
+{
+    if ( !index.isValid() || index.internalId() == 0 ) {
+        return QModelIndex();
+    }
+
+    const quintptr internalId = index.internalId();
+
+    // Group: parent is the net
+    if ( ( internalId & GROUP_MASK ) == 0 ) {
+        const int row = netRow( internalId );
+        Q_ASSERT( row >= 0 );
+        return createIndex( row, 0, quintptr( 0 ) );
+    }
+
+    // Group member: parent is the group
+    return createIndex( static_cast<int>( internalId & GROUP_MASK ) - 1, 0, internalId & ~GROUP_MASK );
+}
+
+int NetlistViewerModel::rowCount( const QModelIndex& parent ) const
+{
+    if ( parent.column() > 0 ) {
+        return 0;
+    }
+
+    // Nets
+    if ( !parent.isValid() ) {
+        return static_cast<int>( _rows.size() );
+    }
+
+    // Groups
+    if ( parent.internalId() == 0 ) {
+        return GroupCount;
+    }
+
+    // Group members
+    if ( ( parent.internalId() & GROUP_MASK ) == 0 ) {
+        const int row = netRow( parent.internalId() );
+        Q_ASSERT( row >= 0 );
+        return _rows[row].fetched[parent.row()];
+    }
+
+    return 0;
+}
+
+int NetlistViewerModel::columnCount( const QModelIndex& parent ) const
+{
+    Q_UNUSED( parent )
+
+    return 2;
+}
+
+bool NetlistViewerModel::hasChildren( const QModelIndex& parent ) const
+{
+    if ( parent.column() > 0 ) {
+        return false;
+    }
+
+    if ( !parent.isValid() ) {
+        return !_netlist.nets().empty();
+    }
+
+    if ( parent.internalId() == 0 ) {
+        return true;
+    }
+
+    if ( ( parent.internalId() & GROUP_MASK ) == 0 ) {
+        return groupSize( *net( netRow( parent.internalId() ) ), parent.row() ) > 0;
+    }
+
+    return false;
+}
+
+bool NetlistViewerModel::canFetchMore( const QModelIndex& parent ) const
+{
+    if ( !parent.isValid() ) {
+        return _rows.size() < _netlist.nets().size();
+    }
+
+    if ( parent.internalId() != 0 && ( parent.internalId() & GROUP_MASK ) == 0 ) {
+        const int row = netRow( parent.internalId() );
+        return _rows[row].fetched[parent.row()] < groupSize( *net( row ), parent.row() );
+    }
+
+    return false;
+}
+
+void NetlistViewerModel::fetchMore( const QModelIndex& parent )
+{
+    // Nets
+    if ( !parent.isValid() ) {
+        const int first = static_cast<int>( _rows.size() );
+        const int last = std::min( first + FETCH_BATCH_SIZE, static_cast<int>( _netlist.nets().size() ) ) - 1;
+        if ( last >= first ) {
+            insertNetRows( first, first, last );
         }
+        return;
+    }
 
-        endInsertRows();
+    // Group members
+    if ( parent.internalId() != 0 && ( parent.internalId() & GROUP_MASK ) == 0 ) {
+        const int row = netRow( parent.internalId() );
+        const int group = parent.row();
+        const int count = std::min( FETCH_BATCH_SIZE, groupSize( *net( row ), group ) - _rows[row].fetched[group] );
+        if ( count > 0 ) {
+            insertGroupRows( row, group, count );
+        }
+    }
+}
+
+int NetlistViewerModel::netRow( quintptr internalId ) const
+{
+    return _rowsById.value( static_cast<quint32>( internalId >> 2 ), -1 );
+}
+
+const NetlistViewerModel::Net* NetlistViewerModel::net( int row ) const
+{
+    if ( row < 0 || row >= static_cast<int>( _rows.size() ) ) {
+        return nullptr;
+    }
+
+    return &_netlist.nets().at( static_cast<std::size_t>( _rows[row].net ) );
+}
+
+int NetlistViewerModel::groupSize( const Net& net, int group )
+{
+    switch ( group ) {
+    case Nodes:
+        return static_cast<int>( net.nodes.size() );
+    case Connectors:
+        return static_cast<int>( net.connectors.size() );
+    case Wires:
+        return static_cast<int>( net.wires.size() );
+    default:
+        return 0;
+    }
+}
+
+bool NetlistViewerModel::groupEquals( const Net& a, const Net& b, int group )
+{
+    switch ( group ) {
+    case Nodes:
+        return a.nodes == b.nodes;
+    case Connectors:
+        return a.connectors == b.connectors;
+    case Wires:
+        return a.wires == b.wires;
+    default:
+        return true;
+    }
+}
+
+void NetlistViewerModel::removeNetRows( int first, int last )
+{
+    beginRemoveRows( QModelIndex(), first, last );
+    for ( int row = first; row <= last; row++ ) {
+        _rowsById.remove( _rows[row].id );
+    }
+    _rows.erase( _rows.begin() + first, _rows.begin() + last + 1 );
+    updateRowsById( first );
+    endRemoveRows();
+}
+
+void NetlistViewerModel::removeGroupRows( int row, int group )
+{
+    const int count = _rows[row].fetched[group];
+    if ( count <= 0 ) {
+        return;
+    }
+
+    beginRemoveRows( index( group, 0, index( row, 0 ) ), 0, count-1 );
+    _rows[row].fetched[group] = 0;
+    endRemoveRows();
+}
+
+void NetlistViewerModel::insertNetRows( int row, int firstNet, int lastNet )
+{
+    beginInsertRows( QModelIndex(), row, row + lastNet - firstNet );
+    std::vector<NetRow> rows;
+    rows.reserve( static_cast<std::size_t>( lastNet - firstNet + 1 ) );
+    for ( int net = firstNet; net <= lastNet; net++ ) {
+        rows.push_back( { _nextId++, net, { } } );
+    }
+    _rows.insert( _rows.begin() + row, rows.cbegin(), rows.cend() );
+    updateRowsById( row );
+    endInsertRows();
+}
+
+void NetlistViewerModel::insertGroupRows( int row, int group, int count )
+{
+    const int first = _rows[row].fetched[group];
+    beginInsertRows( index( group, 0, index( row, 0 ) ), first, first + count - 1 );
+    _rows[row].fetched[group] += count;
+    endInsertRows();
+}
+
+void NetlistViewerModel::updateRowsById( int first )
+{
+    for ( std::size_t row = static_cast<std::size_t>( first ); row < _rows.size(); row++ ) {
+        _rowsById.insert( _rows[row].id, static_cast<int>( row ) );
     }
 }
 
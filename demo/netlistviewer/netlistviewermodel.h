@@ -1,23 +1,75 @@
 #pragma once
 
-#include "qschematic/netlist.h"
+#include <array>
+#include <vector>
+#include <QAbstractItemModel>
+#include <QHash>
 
-#include "common/treemodel.h"
+#include "qschematic/netlist.h"
 
 class Operation;
 class OperationConnector;
 
-class NetlistViewerModel : public TreeModel
+/**
+ * Tree model presenting a netlist. Nets and their members are fetched lazily
+ * in batches and are referenced by index into the netlist instead of being
+ * copied into tree items. Setting a new netlist applies the difference to the
+ * previous one as row removals & insertions.
+ */
+class NetlistViewerModel : public QAbstractItemModel
 {
 public:
+    using Netlist = QSchematic::Netlist<Operation*, OperationConnector*>;
+
     explicit NetlistViewerModel( QObject* parent = nullptr );
     virtual ~NetlistViewerModel() override = default;
 
-    void setNetlist( const QSchematic::Netlist<Operation*, OperationConnector*>& netlist );
+    void setNetlist( Netlist netlist );
+
+    virtual QVariant data( const QModelIndex& index, int role ) const override;
+    virtual Qt::ItemFlags flags( const QModelIndex& index ) const override;
+    virtual QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const override;
+    virtual QModelIndex index( int row, int column, const QModelIndex& parent = QModelIndex() ) const override;
+    virtual QModelIndex parent( const QModelIndex& index ) const override;
+    virtual int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
+    virtual int columnCount( const QModelIndex& parent = QModelIndex() ) const override;
+    virtual bool hasChildren( const QModelIndex& parent = QModelIndex() ) const override;
+    virtual bool canFetchMore( const QModelIndex& parent ) const override;
+    virtual void fetchMore( const QModelIndex& parent ) override;
 
 private:
     Q_OBJECT
     Q_DISABLE_COPY( NetlistViewerModel )
 
+    using Net = QSchematic::Net<QSchematic::Wire*, Operation*, OperationConnector*>;
+
+    enum Group {
+        Nodes,
+        Connectors,
+        Wires,
+        GroupCount
+    };
+
+    struct NetRow
+    {
+        quint32 id;                                 // Stable, part of the internal ids of the children
+        int net;                                    // Index into the netlist
+        std::array<int, GroupCount> fetched;        // Number of fetched children per group
+    };
+
+    int netRow( quintptr internalId ) const;
+    const Net* net( int row ) const;
+    static int groupSize( const Net& net, int group );
+    static bool groupEquals( const Net& a, const Net& b, int group );
+    void removeNetRows( int first, int last );
+    void removeGroupRows( int row, int group );
+    void insertNetRows( int row, int firstNet, int lastNet );
+    void insertGroupRows( int row, int group, int count );
+    void updateRowsById( int first );
     static QString pointerToString( const void* ptr );
+
+    Netlist _netlist;
+    std::vector<NetRow> _rows;                      // Fetched nets, _rows[i].net == i once a netlist is set
+    QHash<quint32, int> _rowsById;
+    quint32 _nextId;
 };
@@ -0,0 +1,264 @@
+#include <QUndoStack>
+#include "blockdefinition.h"
+#include "blocklibrary.h"
+#include "netlistgenerator.h"
+#include "scene.h"
+#include "items/blockinstance.h"
+#include "items/connector.h"
+#include "items/node.h"
+#include "headless/connector.h"
+#include "headless/document.h"
+#include "headless/netlistgenerator.h"
+#include "headless/node.h"
+
+using namespace QSchematic;
+
+BlockDefinition::BlockDefinition(const QString& name) :
+    _name(name),
+    _library(nullptr)
+{
+}
+
+BlockDefinition::~BlockDefinition()
+{
+    // Callers might still hold on to the sub-scene
+    QObject::disconnect(_sceneConnection);
+}
+
+#ifdef USE_GPDS
+gpds::container BlockDefinition::to_container() const
+{
+    // Ports
+    gpds::container portsContainer;
+    for (const Port& port : _ports) {
+        gpds::container portContainer;
+        portContainer.add_value("name", port.name.toStdString());
+        portContainer.add_value("x", port.pos.x());
+        portContainer.add_value("y", port.pos.y());
+        portsContainer.add_value("port", portContainer);
+    }
+
+    // Root
+    gpds::container root;
+    root.add_value("name", _name.toStdString());
+    root.add_value("width", _size.width());
+    root.add_value("height", _size.height());
+    root.add_value("ports", portsContainer);
+    root.add_value("content", content());
+
+    return root;
+}
+
+void BlockDefinition::from_container(const gpds::container& container)
+{
+    _name = QString::fromStdString(container.get_value<std::string>("name").value_or(""));
+    _size.setWidth(container.get_value<double>("width").value_or(0));
+    _size.setHeight(container.get_value<double>("height").value_or(0));
+
+    // Ports
+    _ports.clear();
+    if (const gpds::container* portsContainer = container.get_value<gpds::container*>("ports").value_or(nullptr)) {
+        for (const gpds::container* portContainer : portsContainer->get_values<gpds::container*>("port")) {
+            Port port;
+            port.name = QString::fromStdString(portContainer->get_value<std::string>("name").value_or(""));
+            port.pos.setX(portContainer->get_value<double>("x").value_or(0));
+            port.pos.setY(portContainer->get_value<double>("y").value_or(0));
+            _ports << port;
+        }
+    }
+
+    // Content
+    const gpds::container* contentContainer = container.get_value<gpds::container*>("content").value_or(nullptr);
+    setContent(contentContainer ? *contentContainer : gpds::container());
+}
+
+/**
+ * Replaces the content of the sub-scene. A materialized sub-scene is discarded.
+ */
+void BlockDefinition::setContent(const gpds::container& content)
+{
+    _content = content;
+    _scene.reset();
+    _subnets.reset();
+}
+
+/**
+ * Returns the content of the sub-scene. This serializes the sub-scene if it is
+ * materialized.
+ */
+gpds::container BlockDefinition::content() const
+{
+    if (_scene) {
+        return _scene->to_container();
+    }
+
+    return _content;
+}
+#endif
+
+QString BlockDefinition::name() const
+{
+    return _name;
+}
+
+void BlockDefinition::setSize(const QSizeF& size)
+{
+    _size = size;
+}
+
+QSizeF BlockDefinition::size() const
+{
+    return _size;
+}
+
+void BlockDefinition::setPorts(const QVector<Port>& ports)
+{
+    _ports = ports;
+}
+
+QVector<BlockDefinition::Port> BlockDefinition::ports() const
+{
+    return _ports;
+}
+
+BlockLibrary* BlockDefinition::library() const
+{
+    return _library;
+}
+
+bool BlockDefinition::isMaterialized() const
+{
+    return _scene != nullptr;
+}
+
+/**
+ * Returns the sub-scene, creating it from the serialized content first if
+ * necessary. The sub-scene resolves nested instances through the library this
+ * definition belongs to.
+ */
+std::shared_ptr<Scene> BlockDefinition::materialize()
+{
+    if (_scene) {
+        return _scene;
+    }
+
+    _scene = std::make_shared<Scene>();
+    if (_library) {
+        _scene->setOuterBlockLibrary(_library->weak_from_this());
+    }
+#ifdef USE_GPDS
+    if (_content.get_value<gpds::container*>("scene").value_or(nullptr)) {
+        _scene->from_container(_content);
+    }
+#endif
+
+    // Modifications invalidate the cached subnets
+    _sceneConnection = QObject::connect(_scene->undoStack(), &QUndoStack::indexChanged, [this] {
+        _subnets.reset();
+    });
+    _subnets.reset();
+
+    return _scene;
+}
+
+/**
+ * Serializes the sub-scene and releases it.
+ */
+void BlockDefinition::dematerialize()
+{
+#ifdef USE_GPDS
+    if (!_scene) {
+        return;
+    }
+
+    _content = _scene->to_container();
+    QObject::disconnect(_sceneConnection);
+    _scene.reset();
+#endif
+}
+
+/**
+ * Returns the connectivity of the sub-scene. This is computed from the
+ * serialized content without materializing the sub-scene and cached.
+ */
+const BlockDefinition::Subnets& BlockDefinition::subnets() const
+{
+    if (!_subnets) {
+        if (_scene) {
+            _subnets = subnetsFromScene(*_scene);
+        } else {
+#ifdef USE_GPDS
+            _subnets = subnetsFromContent(_content);
+#else
+            _subnets = Subnets();
+#endif
+        }
+    }
+
+    return *_subnets;
+}
+
+BlockDefinition::Subnets BlockDefinition::subnetsFromScene(const Scene& scene)
+{
+    Subnets subnets;
+
+    // Index the nodes
+    QHash<const Node*, int> nodeIndices;
+    const auto& nodes = scene.nodes();
+    for (int i = 0; i < nodes.count(); i++) {
+        nodeIndices.insert(nodes.at(i).get(), i);
+
+        if (const auto* instance = dynamic_cast<const BlockInstance*>(nodes.at(i).get())) {
+            subnets.instances.insert(i, { instance->instanceName(), instance->definitionName() });
+        }
+    }
+
+    // Nets
+    Netlist<> netlist;
+    NetlistGenerator::generate(netlist, scene);
+    for (const auto& net : netlist.nets()) {
+        Subnets::Net subnet;
+        subnet.name = net.name;
+        for (const auto& [connector, node] : net.connectorNodePairs) {
+            subnet.pins.append({ nodeIndices.value(node, -1), connector->text() });
+        }
+        subnets.nets.append(subnet);
+    }
+
+    return subnets;
+}
+
+#ifdef USE_GPDS
+BlockDefinition::Subnets BlockDefinition::subnetsFromContent(const gpds::container& content)
+{
+    Subnets subnets;
+
+    Headless::Document document;
+    document.from_container(content);
+
+    // Index the nodes
+    QHash<const Headless::Node*, int> nodeIndices;
+    const auto& nodes = document.nodes();
+    for (int i = 0; i < nodes.count(); i++) {
+        nodeIndices.insert(nodes.at(i).get(), i);
+
+        if (!nodes.at(i)->blockDefinition().isEmpty()) {
+            subnets.instances.insert(i, { nodes.at(i)->instanceName(), nodes.at(i)->blockDefinition() });
+        }
+    }
+
+    // Nets
+    Headless::Netlist netlist;
+    Headless::NetlistGenerator::generate(netlist, document);
+    for (const auto& net : netlist.nets()) {
+        Subnets::Net subnet;
+        subnet.name = net.name;
+        for (const auto& [connector, node] : net.connectorNodePairs) {
+            subnet.pins.append({ nodeIndices.value(node, -1), connector->text() });
+        }
+        subnets.nets.append(subnet);
+    }
+
+    return subnets;
+}
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Scene;
+    class BlockLibrary;
+
+    /**
+     * The definition of a hierarchical block: a sub-scene with boundary ports.
+     *
+     * Every BlockInstance placed in a scene references a definition which is shared
+     * by all instances. The sub-scene is kept serialized and only materialized into
+     * a Scene when the user descends into an instance. A port connects to the net of
+     * the same name inside the sub-scene.
+     *
+     * The connectivity of the sub-scene (its subnets) is computed once and cached
+     * until the materialized sub-scene is modified.
+     */
+    class QSCHEMATIC_EXPORT BlockDefinition
+    {
+        friend class BlockLibrary;
+
+    public:
+        struct Port
+        {
+            QString name;
+            QPointF pos;        // Relative to the instance
+        };
+
+        struct Subnets
+        {
+            struct Pin
+            {
+                int node;           // Index of the node in the scene
+                QString connector;
+            };
+
+            struct Net
+            {
+                QString name;
+                QVector<Pin> pins;
+            };
+
+            struct Instance
+            {
+                QString name;
+                QString definition;
+            };
+
+            QVector<Net> nets;
+            QHash<int, Instance> instances;     // By node index
+        };
+
+        explicit BlockDefinition(const QString& name = QString());
+        BlockDefinition(const BlockDefinition& other) = delete;
+        BlockDefinition(BlockDefinition&& other) = delete;
+        virtual ~BlockDefinition();
+
+        BlockDefinition& operator=(const BlockDefinition& rhs) = delete;
+        BlockDefinition& operator=(BlockDefinition&& rhs) = delete;
+
+#ifdef USE_GPDS
+        gpds::container to_container() const;
+        void from_container(const gpds::container& container);
+        void setContent(const gpds::container& content);
+        gpds::container content() const;
+#endif
+
+        QString name() const;
+        void setSize(const QSizeF& size);
+        QSizeF size() const;
+        void setPorts(const QVector<Port>& ports);
+        QVector<Port> ports() const;
+        BlockLibrary* library() const;
+        bool isMaterialized() const;
+        std::shared_ptr<Scene> materialize();
+        void dematerialize();
+        const Subnets& subnets() const;
+
+        static Subnets subnetsFromScene(const Scene& scene);
+#ifdef USE_GPDS
+        static Subnets subnetsFromContent(const gpds::container& content);
+#endif
+
+    private:
+        QString _name;
+        QSizeF _size;
+        QVector<Port> _ports;
+        BlockLibrary* _library;
+#ifdef USE_GPDS
+        gpds::container _content;
+#endif
+        std::shared_ptr<Scene> _scene;
+        QMetaObject::Connection _sceneConnection;   // The sub-scene may outlive the definition
+        mutable std::optional<Subnets> _subnets;
+    };
+
+}
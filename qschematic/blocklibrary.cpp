@@ -0,0 +1,85 @@
+#include "blocklibrary.h"
+#include "blockdefinition.h"
+
+using namespace QSchematic;
+
+BlockLibrary::~BlockLibrary()
+{
+    clear();
+}
+
+#ifdef USE_GPDS
+gpds::container BlockLibrary::to_container() const
+{
+    gpds::container root;
+    for (const auto& definition : _definitions) {
+        root.add_value("block_definition", definition->to_container());
+    }
+
+    return root;
+}
+
+void BlockLibrary::from_container(const gpds::container& container)
+{
+    clear();
+
+    for (const gpds::container* definitionContainer : container.get_values<gpds::container*>("block_definition")) {
+        auto definition = std::make_shared<BlockDefinition>();
+        definition->from_container(*definitionContainer);
+        if (!addDefinition(definition)) {
+            qWarning("BlockLibrary::from_container(): Couldn't restore block definition. Skipping.");
+        }
+    }
+}
+#endif
+
+/**
+ * Adds a definition. Fails if the definition has no name or the name is taken.
+ */
+bool BlockLibrary::addDefinition(const std::shared_ptr<BlockDefinition>& definition)
+{
+    // Sanity check
+    if (!definition || definition->name().isEmpty() || _definitions.contains(definition->name())) {
+        return false;
+    }
+
+    definition->_library = this;
+    _definitions.insert(definition->name(), definition);
+
+    return true;
+}
+
+bool BlockLibrary::removeDefinition(const QString& name)
+{
+    auto definition = _definitions.take(name);
+    if (!definition) {
+        return false;
+    }
+
+    definition->_library = nullptr;
+
+    return true;
+}
+
+std::shared_ptr<BlockDefinition> BlockLibrary::definition(const QString& name) const
+{
+    return _definitions.value(name);
+}
+
+QList<std::shared_ptr<BlockDefinition>> BlockLibrary::definitions() const
+{
+    return _definitions.values();
+}
+
+bool BlockLibrary::isEmpty() const
+{
+    return _definitions.isEmpty();
+}
+
+void BlockLibrary::clear()
+{
+    for (const auto& definition : _definitions) {
+        definition->_library = nullptr;
+    }
+    _definitions.clear();
+}
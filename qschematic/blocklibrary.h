@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <QList>
+#include <QMap>
+#include <QString>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class BlockDefinition;
+
+    /**
+     * The set of block definitions available to a scene and all of its sub-scenes.
+     * Definitions are identified by their name.
+     */
+    class QSCHEMATIC_EXPORT BlockLibrary :
+        public std::enable_shared_from_this<BlockLibrary>
+    {
+    public:
+        BlockLibrary() = default;
+        BlockLibrary(const BlockLibrary& other) = delete;
+        BlockLibrary(BlockLibrary&& other) = delete;
+        virtual ~BlockLibrary();
+
+        BlockLibrary& operator=(const BlockLibrary& rhs) = delete;
+        BlockLibrary& operator=(BlockLibrary&& rhs) = delete;
+
+#ifdef USE_GPDS
+        gpds::container to_container() const;
+        void from_container(const gpds::container& container);
+#endif
+
+        bool addDefinition(const std::shared_ptr<BlockDefinition>& definition);
+        bool removeDefinition(const QString& name);
+        std::shared_ptr<BlockDefinition> definition(const QString& name) const;
+        QList<std::shared_ptr<BlockDefinition>> definitions() const;
+        bool isEmpty() const;
+        void clear();
+
+    private:
+        QMap<QString, std::shared_ptr<BlockDefinition>> _definitions;
+    };
+
+}
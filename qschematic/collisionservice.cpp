@@ -0,0 +1,257 @@
+#include <cmath>
+#include "collisionservice.h"
+#include "items/node.h"
+
+const int SEARCH_RADIUS_MAX       = 32;     // In grid units
+const int PUSH_AWAY_ITERATIONS    = 8;
+
+using namespace QSchematic;
+
+CollisionService::CollisionService(QObject* parent) :
+    QObject(parent),
+    _tree(_settings.gridSize)
+{
+}
+
+void CollisionService::setSettings(const Settings& settings)
+{
+    _settings = settings;
+
+    // Rebuild the tree with the new margin
+    _tree = AabbTree<Node*>(_settings.gridSize);
+    for (auto it = _proxies.begin(); it != _proxies.end(); ++it) {
+        Node* node = const_cast<Node*>(it.key());
+        it.value() = _tree.insert(sceneRect(*node), node);
+    }
+}
+
+void CollisionService::addNode(const std::shared_ptr<Node>& node)
+{
+    // Sanity check
+    if (!node || _proxies.contains(node.get())) {
+        return;
+    }
+
+    _proxies.insert(node.get(), _tree.insert(sceneRect(*node), node.get()));
+
+    // Keep track of the node geometry
+    connect(node.get(), &Item::movedInScene, this, [this](Item& item) {
+        updateNode(static_cast<const Node&>(item));
+    });
+    connect(node.get(), &Item::rotated, this, [this](Item& item) {
+        updateNode(static_cast<const Node&>(item));
+    });
+    Node* rawNode = node.get();
+    connect(node.get(), &Node::sizeChanged, this, [this, rawNode] {
+        updateNode(*rawNode);
+    });
+}
+
+void CollisionService::removeNode(const std::shared_ptr<Node>& node)
+{
+    // Sanity check
+    if (!node || !_proxies.contains(node.get())) {
+        return;
+    }
+
+    _tree.remove(_proxies.take(node.get()));
+    disconnect(node.get(), nullptr, this, nullptr);
+}
+
+void CollisionService::clear()
+{
+    for (auto it = _proxies.cbegin(); it != _proxies.cend(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    _proxies.clear();
+    _tree.clear();
+}
+
+int CollisionService::count() const
+{
+    return _tree.count();
+}
+
+/**
+ * Returns all nodes whose size rect overlaps the given rect (in scene coordinates).
+ * Touching edges don't count as overlapping.
+ */
+QList<Node*> CollisionService::overlapping(const QRectF& rect, const IgnoreFunction& ignore) const
+{
+    QList<Node*> nodes;
+    _tree.query(rect, [&](AabbTree<Node*>::Proxy proxy) {
+        Node* node = _tree.data(proxy);
+        if ((!ignore || !ignore(*node)) && sceneRect(*node).intersects(rect)) {
+            nodes << node;
+        }
+        return true;
+    });
+
+    return nodes;
+}
+
+bool CollisionService::isFree(const QRectF& rect, const IgnoreFunction& ignore) const
+{
+    bool free = true;
+    _tree.query(rect, [&](AabbTree<Node*>::Proxy proxy) {
+        const Node* node = _tree.data(proxy);
+        if ((!ignore || !ignore(*node)) && sceneRect(*node).intersects(rect)) {
+            free = false;
+        }
+        return free;
+    });
+
+    return free;
+}
+
+/**
+ * Returns the position closest to pos at which the node doesn't overlap any
+ * other node. The candidates are searched in growing rings on the grid.
+ * Returns pos if no free position was found within the search radius.
+ */
+QPointF CollisionService::nearestFreePosition(const Node& node, const QPointF& pos, const IgnoreFunction& ignore) const
+{
+    auto ignoreSelf = [&node, &ignore](const Node& other) {
+        return &other == &node || (ignore && ignore(other));
+    };
+
+    const QPointF origin = node.snapToGrid() ? QPointF(_settings.snapToGrid(pos)) : pos;
+    const QRectF rect = sceneRect(node).translated(origin - node.pos());
+    if (isFree(rect, ignoreSelf)) {
+        return origin;
+    }
+
+    QPointF offset;
+    if (!searchFreeOffset([&](const QPointF& candidate) { return isFree(rect.translated(candidate), ignoreSelf); }, offset)) {
+        return pos;
+    }
+
+    return origin + offset;
+}
+
+/**
+ * Returns the translation closest to zero (a multiple of the grid size) by
+ * which all rects (in scene coordinates) can be moved together without
+ * overlapping any node. This is used to move a selection of nodes as one.
+ * Returns a null point if no free translation was found within the search
+ * radius.
+ */
+QPointF CollisionService::nearestFreeOffset(const QVector<QRectF>& rects, const IgnoreFunction& ignore) const
+{
+    auto isFreeAt = [&](const QPointF& candidate) {
+        for (const QRectF& rect : rects) {
+            if (!isFree(rect.translated(candidate), ignore)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (isFreeAt(QPointF())) {
+        return { };
+    }
+
+    QPointF offset;
+    searchFreeOffset(isFreeAt, offset);
+
+    return offset;
+}
+
+/**
+ * Returns the smallest translation (snapped to the grid) that moves the rect
+ * out of all overlapping nodes. Each iteration resolves the deepest overlap
+ * along its axis of least penetration.
+ */
+QVector2D CollisionService::pushAwayVector(const QRectF& rect, const IgnoreFunction& ignore) const
+{
+    const qreal gridSize = _settings.gridSize;
+    QPointF total;
+    for (int i = 0; i < PUSH_AWAY_ITERATIONS; i++) {
+        const QRectF current = rect.translated(total);
+
+        // Find the deepest overlap
+        QRectF deepest;
+        qreal deepestArea = 0;
+        for (const Node* node : overlapping(current, ignore)) {
+            const QRectF& intersection = current.intersected(sceneRect(*node));
+            const qreal area = intersection.width() * intersection.height();
+            if (area > deepestArea) {
+                deepest = sceneRect(*node);
+                deepestArea = area;
+            }
+        }
+        if (deepestArea <= 0) {
+            break;
+        }
+
+        // Move out along the axis of least penetration
+        const qreal left = current.right() - deepest.left();
+        const qreal right = deepest.right() - current.left();
+        const qreal up = current.bottom() - deepest.top();
+        const qreal down = deepest.bottom() - current.top();
+        const qreal dx = left < right ? -left : right;
+        const qreal dy = up < down ? -up : down;
+        QPointF step = std::abs(dx) < std::abs(dy) ? QPointF(dx, 0) : QPointF(0, dy);
+
+        // Stay on the grid (rounding away from the obstacle)
+        step.setX(std::copysign(std::ceil(std::abs(step.x()) / gridSize) * gridSize, step.x()));
+        step.setY(std::copysign(std::ceil(std::abs(step.y()) / gridSize) * gridSize, step.y()));
+        total += step;
+    }
+
+    return QVector2D(total);
+}
+
+QRectF CollisionService::sceneRect(const Node& node)
+{
+    return node.mapRectToScene(node.sizeRect());
+}
+
+void CollisionService::updateNode(const Node& node)
+{
+    const auto proxy = _proxies.value(&node, AabbTree<Node*>::NullProxy);
+    if (proxy == AabbTree<Node*>::NullProxy) {
+        return;
+    }
+
+    _tree.update(proxy, sceneRect(node));
+}
+
+/**
+ * Searches the grid in growing rings around zero for the closest offset at
+ * which isFreeAt() holds. Zero itself isn't tested.
+ */
+bool CollisionService::searchFreeOffset(const std::function<bool(const QPointF& offset)>& isFreeAt, QPointF& offset) const
+{
+    // A candidate on a later ring can still be closer than one at the corner
+    // of the current ring, stop once no closer one is possible.
+    const int gridSize = _settings.gridSize;
+    qreal bestDistance = -1;
+    for (int ring = 1; ring <= SEARCH_RADIUS_MAX; ring++) {
+        if (bestDistance >= 0 && ring * gridSize > bestDistance) {
+            break;
+        }
+
+        for (int dx = -ring; dx <= ring; dx++) {
+            for (int dy = -ring; dy <= ring; dy++) {
+                // Only the perimeter of the ring
+                if (std::abs(dx) != ring && std::abs(dy) != ring) {
+                    continue;
+                }
+
+                const QPointF candidate(dx * gridSize, dy * gridSize);
+                const qreal distance = std::hypot(candidate.x(), candidate.y());
+                if (bestDistance >= 0 && distance >= bestDistance) {
+                    continue;
+                }
+
+                if (isFreeAt(candidate)) {
+                    offset = candidate;
+                    bestDistance = distance;
+                }
+            }
+        }
+    }
+
+    return bestDistance >= 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <QVector2D>
+#include "settings.h"
+#include "utils/aabbtree.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Node;
+
+    /**
+     * Broadphase collision detection for nodes. The size rects of all nodes
+     * (in scene coordinates) are kept in a dynamic AABB tree which is updated
+     * as the nodes move, resize or rotate. Queries are O(log n) so they can be
+     * used on every mouse move.
+     */
+    class QSCHEMATIC_EXPORT CollisionService :
+        public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(CollisionService)
+
+    public:
+        /**
+         * Returns true for nodes that should be ignored by a query (eg. the nodes being dragged).
+         */
+        using IgnoreFunction = std::function<bool(const Node& node)>;
+
+        explicit CollisionService(QObject* parent = nullptr);
+        virtual ~CollisionService() override = default;
+
+        void setSettings(const Settings& settings);
+        void addNode(const std::shared_ptr<Node>& node);
+        void removeNode(const std::shared_ptr<Node>& node);
+        void clear();
+        int count() const;
+
+        QList<Node*> overlapping(const QRectF& rect, const IgnoreFunction& ignore = { }) const;
+        bool isFree(const QRectF& rect, const IgnoreFunction& ignore = { }) const;
+        QPointF nearestFreePosition(const Node& node, const QPointF& pos, const IgnoreFunction& ignore = { }) const;
+        QPointF nearestFreeOffset(const QVector<QRectF>& rects, const IgnoreFunction& ignore = { }) const;
+        QVector2D pushAwayVector(const QRectF& rect, const IgnoreFunction& ignore = { }) const;
+
+        static QRectF sceneRect(const Node& node);
+
+    private:
+        void updateNode(const Node& node);
+        bool searchFreeOffset(const std::function<bool(const QPointF& offset)>& isFreeAt, QPointF& offset) const;
+
+        Settings _settings;
+        AabbTree<Node*> _tree;
+        QHash<const Node*, AabbTree<Node*>::Proxy> _proxies;
+    };
+
+}
@@ -1,4 +1,5 @@
 #include "../items/item.h"
+#include "../items/connector.h"
 #include "../items/wire.h"
 #include "../scene.h"
 #include "commands.h"
@@ -66,6 +67,9 @@ void CommandItemAdd::redo()
         for (int i = 0; i < wire->wirePointsRelative().count(); i++) {
             _scene->wire_manager()->point_moved_by_user(*wire.get(), i);
         }
+        for (const auto& attachment : _attachments) {
+            _scene->wire_manager()->attach_wire_to_connector(wire.get(), attachment.first, attachment.second.get());
+        }
     }
 
     // Otherwise, fall back to normal item behavior
@@ -73,3 +77,13 @@ void CommandItemAdd::redo()
         _scene->addItem(_item);
     }
 }
+
+/**
+ * Attaches a point of the wire to the connector whenever the wire is added.
+ * This has to be set before the command is pushed. Removing the wire on undo
+ * detaches it again.
+ */
+void CommandItemAdd::attachToConnector(int pointIndex, const std::shared_ptr<Connector>& connector)
+{
+    _attachments.append({ pointIndex, connector });
+}
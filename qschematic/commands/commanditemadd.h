@@ -3,12 +3,14 @@
 #include "commandbase.h"
 
 #include <QPointer>
+#include <QVector>
 #include <memory>
 
 namespace QSchematic
 {
     class Scene;
     class Item;
+    class Connector;
 
     class QSCHEMATIC_EXPORT CommandItemAdd :
         public UndoCommand
@@ -21,9 +23,12 @@ namespace QSchematic
         virtual void undo()  override;
         virtual void redo()  override;
 
+        void attachToConnector(int pointIndex, const std::shared_ptr<Connector>& connector);
+
     private:
         QPointer<Scene> _scene;
         std::shared_ptr<Item> _item;
+        QVector<QPair<int, std::shared_ptr<Connector>>> _attachments;   // Wire point index & connector
     };
 
 }
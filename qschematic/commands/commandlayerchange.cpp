@@ -0,0 +1,87 @@
+#include "../scene.h"
+#include "../items/item.h"
+#include "commands.h"
+#include "commandlayerchange.h"
+
+using namespace QSchematic;
+
+CommandLayerChange::CommandLayerChange(const QPointer<Scene>& scene, const std::shared_ptr<Layer>& layer, const Layer::State& newState, QUndoCommand* parent) :
+    UndoCommand(parent),
+    _scene(scene),
+    _layer(layer),
+    _newState(newState)
+{
+    connectDependencyDestroySignal(_scene.data());
+    _oldState = _layer->state();
+    setText(QStringLiteral("Change layer"));
+}
+
+int CommandLayerChange::id() const
+{
+    return LayerChangeCommandType;
+}
+
+bool CommandLayerChange::mergeWith(const QUndoCommand* command)
+{
+    if (id() != command->id()) {
+        return false;
+    }
+
+    const CommandLayerChange* myCommand = dynamic_cast<const CommandLayerChange*>(command);
+    if (!myCommand || _layer != myCommand->_layer) {
+        return false;
+    }
+
+    _newState = myCommand->_newState;
+    _deselectedByRedo << myCommand->_deselectedByRedo;
+
+    return true;
+}
+
+void CommandLayerChange::undo()
+{
+    _deselectedByUndo = apply(_oldState);
+    select(_deselectedByRedo);
+}
+
+void CommandLayerChange::redo()
+{
+    _deselectedByRedo = apply(_newState);
+    select(_deselectedByUndo);
+}
+
+/**
+ * Applies the state to the layer and returns the items that had to be deselected.
+ */
+QList<std::weak_ptr<Item>> CommandLayerChange::apply(const Layer::State& state)
+{
+    if (!_scene || !_layer) {
+        return { };
+    }
+
+    // Locked or hidden items can't stay selected
+    QList<std::weak_ptr<Item>> deselected;
+    if (!state.visible || state.locked) {
+        for (const auto& item : _scene->selectedItems()) {
+            if (item->effectiveLayer() == _layer) {
+                item->setSelected(false);
+                deselected << item;
+            }
+        }
+    }
+
+    _layer->setState(state);
+    _scene->applyLayers();
+
+    return deselected;
+}
+
+void CommandLayerChange::select(const QList<std::weak_ptr<Item>>& items)
+{
+    for (const auto& weakItem : items) {
+        auto item = weakItem.lock();
+        if (item && item->scene()) {
+            item->setSelected(true);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "commandbase.h"
+#include "../layer.h"
+
+#include <QList>
+#include <QPointer>
+#include <memory>
+
+namespace QSchematic
+{
+    class Scene;
+    class Item;
+
+    class QSCHEMATIC_EXPORT CommandLayerChange :
+        public UndoCommand
+    {
+    public:
+        CommandLayerChange(const QPointer<Scene>& scene, const std::shared_ptr<Layer>& layer, const Layer::State& newState, QUndoCommand* parent = nullptr);
+
+        virtual int id() const override;
+        virtual bool mergeWith(const QUndoCommand* command) override;
+        virtual void undo() override;
+        virtual void redo() override;
+
+    private:
+        QList<std::weak_ptr<Item>> apply(const Layer::State& state);
+        static void select(const QList<std::weak_ptr<Item>>& items);
+
+        QPointer<Scene> _scene;
+        std::shared_ptr<Layer> _layer;
+        Layer::State _oldState;
+        Layer::State _newState;
+        QList<std::weak_ptr<Item>> _deselectedByRedo;
+        QList<std::weak_ptr<Item>> _deselectedByUndo;
+    };
+
+}
@@ -48,8 +48,11 @@ void CommandNodeResize::undo()
         return;
     }
 
+    // Update the attached wires only once for the final geometry
+    _node->beginConnectorRelocation();
     _node->setSize(_oldSize);
     _node->setPos(_oldPos);
+    _node->endConnectorRelocation();
 }
 
 void CommandNodeResize::redo()
@@ -58,6 +61,9 @@ void CommandNodeResize::redo()
         return;
     }
 
+    // Update the attached wires only once for the final geometry
+    _node->beginConnectorRelocation();
     _node->setSize(_newSize);
     _node->setPos(_newPos);
+    _node->endConnectorRelocation();
 }
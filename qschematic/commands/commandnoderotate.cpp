@@ -45,11 +45,14 @@ void CommandNodeRotate::undo()
         return;
     }
 
+    // Update the attached wires only once for the final geometry
+    _node->beginConnectorRelocation();
     _node->setRotation(_oldAngle);
     // Recalculate position
     if (_node->canSnapToGrid()) {
         _node->setPos(_node->itemChange(QGraphicsItem::ItemPositionChange, _node->pos()).toPointF());
     }
+    _node->endConnectorRelocation();
 }
 
 void CommandNodeRotate::redo()
@@ -58,9 +61,12 @@ void CommandNodeRotate::redo()
         return;
     }
 
+    // Update the attached wires only once for the final geometry
+    _node->beginConnectorRelocation();
     _node->setRotation(_newAngle);
     // Recalculate position
     if (_node->canSnapToGrid()) {
         _node->setPos(_node->itemChange(QGraphicsItem::ItemPositionChange, _node->pos()).toPointF());
     }
+    _node->endConnectorRelocation();
 }
@@ -0,0 +1,98 @@
+#include "../items/item.h"
+#include "../items/connector.h"
+#include "../items/wire.h"
+#include "../items/wirenet.h"
+#include "../scene.h"
+#include "commands.h"
+#include "commandpaste.h"
+
+using namespace QSchematic;
+
+CommandPaste::CommandPaste(const QPointer<Scene>& scene, const QVector<std::shared_ptr<Item>>& items, const QVector<Net>& nets,
+                           const QVector<Attachment>& attachments, const QVector<Junction>& junctions, QUndoCommand* parent) :
+    UndoCommand(parent),
+    _scene(scene),
+    _items(items),
+    _nets(nets),
+    _attachments(attachments),
+    _junctions(junctions),
+    _netsPopulated(false)
+{
+    connectDependencyDestroySignal(_scene.data());
+    setText(QStringLiteral("Paste"));
+}
+
+int CommandPaste::id() const
+{
+    return PasteCommandType;
+}
+
+bool CommandPaste::mergeWith(const QUndoCommand* command)
+{
+    Q_UNUSED(command)
+
+    return false;
+}
+
+void CommandPaste::undo()
+{
+    if (!_scene) {
+        return;
+    }
+
+    auto manager = _scene->wire_manager();
+
+    for (const auto& attachment : _attachments) {
+        manager->detach_wire(attachment.connector.get());
+    }
+    for (const auto& junction : _junctions) {
+        junction.wire->disconnectWire(junction.connectedWire.get());
+    }
+
+    // The wires stay in their nets for the next redo. Everything is removed in
+    // bulk as removing the items one by one is quadratic.
+    QVector<std::shared_ptr<Item>> items;
+    QVector<std::shared_ptr<wire_system::net>> nets;
+    nets.reserve(_nets.count());
+    for (const auto& net : _nets) {
+        for (const auto& wire : net.wires) {
+            items << wire;
+        }
+        nets << net.net;
+    }
+    items << _items;
+    _scene->removeItems(items);
+    manager->remove_nets(nets);
+}
+
+void CommandPaste::redo()
+{
+    if (!_scene) {
+        return;
+    }
+
+    auto manager = _scene->wire_manager();
+
+    for (const auto& item : _items) {
+        _scene->addItem(item);
+    }
+
+    for (const auto& net : _nets) {
+        manager->add_net(net.net);
+        for (const auto& wire : net.wires) {
+            if (!_netsPopulated) {
+                net.net->addWire(wire);
+            }
+            _scene->addItem(wire);
+        }
+    }
+    _netsPopulated = true;
+
+    // The junction flags of the points are part of the pasted geometry
+    for (const auto& junction : _junctions) {
+        junction.wire->connect_wire(junction.connectedWire.get());
+    }
+    for (const auto& attachment : _attachments) {
+        manager->attach_wire_to_connector(attachment.wire.get(), attachment.index, attachment.connector.get());
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "commandbase.h"
+
+#include <QPointer>
+#include <QVector>
+#include <memory>
+
+namespace QSchematic
+{
+    class Scene;
+    class Item;
+    class Wire;
+    class WireNet;
+    class Connector;
+
+    /**
+     * Adds a pasted selection to the scene in one go: the items, the wires
+     * with their nets, the connector attachments and the junctions between
+     * the wires. Nothing has to be rediscovered by the wire system.
+     */
+    class QSCHEMATIC_EXPORT CommandPaste :
+        public UndoCommand
+    {
+    public:
+        struct Net
+        {
+            std::shared_ptr<WireNet> net;
+            QVector<std::shared_ptr<Wire>> wires;
+        };
+
+        struct Attachment
+        {
+            std::shared_ptr<Connector> connector;
+            std::shared_ptr<Wire> wire;
+            int index;
+        };
+
+        struct Junction
+        {
+            std::shared_ptr<Wire> wire;
+            std::shared_ptr<Wire> connectedWire;    // Has a point on wire
+        };
+
+        CommandPaste(const QPointer<Scene>& scene, const QVector<std::shared_ptr<Item>>& items, const QVector<Net>& nets,
+                     const QVector<Attachment>& attachments, const QVector<Junction>& junctions, QUndoCommand* parent = nullptr);
+
+        virtual int id() const override;
+        virtual bool mergeWith(const QUndoCommand* command) override;
+        virtual void undo() override;
+        virtual void redo() override;
+
+    private:
+        QPointer<Scene> _scene;
+        QVector<std::shared_ptr<Item>> _items;
+        QVector<Net> _nets;
+        QVector<Attachment> _attachments;
+        QVector<Junction> _junctions;
+        bool _netsPopulated;
+    };
+
+}
@@ -12,6 +12,9 @@ namespace QSchematic
         NodeRotateCommandType,
         WireNetRenameCommandType,
         WirePointMoveCommandType,
+        LayerChangeCommandType,
+        WireMergeCommandType,
+        PasteCommandType,
 
         QSchematicCommandUserType = 1000
     };
@@ -0,0 +1,151 @@
+#include "../items/wire.h"
+#include "../items/connector.h"
+#include "../scene.h"
+#include "commands.h"
+#include "commandwiremerge.h"
+
+using namespace QSchematic;
+
+CommandWireMerge::CommandWireMerge(const QPointer<Scene>& scene, const QVector<std::shared_ptr<Wire>>& chain, const std::shared_ptr<Wire>& merged, QUndoCommand* parent) :
+    UndoCommand(parent),
+    _scene(scene),
+    _chain(chain),
+    _merged(merged)
+{
+    connectDependencyDestroySignal(_scene.data());
+    setText(QStringLiteral("Merge wires"));
+}
+
+int CommandWireMerge::id() const
+{
+    return WireMergeCommandType;
+}
+
+bool CommandWireMerge::mergeWith(const QUndoCommand* command)
+{
+    Q_UNUSED(command)
+
+    return false;
+}
+
+void CommandWireMerge::undo()
+{
+    if (!_scene || _chain.isEmpty() || !_merged) {
+        return;
+    }
+
+    auto net = _merged->net();
+    auto manager = _scene->wire_manager();
+
+    // Put the chain back first so that the net never becomes empty
+    for (const auto& wire : _chain) {
+        net->addWire(wire);
+        _scene->addItem(wire);
+    }
+    for (const auto& connection : _connections) {
+        connection.wire->connect_wire(connection.connectedWire);
+    }
+    for (const auto& attachment : _attachments) {
+        manager->attach_wire_to_connector(attachment.wire, attachment.index, attachment.connector);
+    }
+
+    takeOut(_merged);
+}
+
+void CommandWireMerge::redo()
+{
+    if (!_scene || _chain.isEmpty() || !_merged) {
+        return;
+    }
+
+    auto net = _chain.first()->net();
+    auto manager = _scene->wire_manager();
+    if (!net) {
+        return;
+    }
+
+    // Remember how the chain is hooked up. Wires only connect to wires of their own net.
+    _attachments.clear();
+    _connections.clear();
+    for (const auto& wire : _chain) {
+        for (const auto* connector : manager->attached_connectors(wire.get())) {
+            _attachments.push_back({ connector, wire.get(), manager->attached_point(connector) });
+        }
+        for (auto* other : wire->connected_wires()) {
+            _connections.push_back({ wire.get(), other });
+        }
+    }
+    for (const auto& other : net->wires()) {
+        // Connections within the chain were recorded above
+        if (_chain.contains(std::dynamic_pointer_cast<Wire>(other))) {
+            continue;
+        }
+        for (const auto& wire : _chain) {
+            if (other->connected_wires().contains(wire.get())) {
+                _connections.push_back({ other.get(), wire.get() });
+            }
+        }
+    }
+
+    // Add the merged wire to the same net
+    net->addWire(_merged);
+    _scene->addItem(_merged);
+
+    // Connect it to the rest of the net before the chain goes away so the net doesn't split
+    for (const auto& other : net->wires()) {
+        if (other == _merged || _chain.contains(std::dynamic_pointer_cast<Wire>(other))) {
+            continue;
+        }
+
+        const auto& otherPoints = other->points();
+        for (int index : { 0, otherPoints.count() - 1 }) {
+            if (_merged->point_is_on_wire(otherPoints.at(index).toPointF())) {
+                manager->connect_wire(_merged.get(), other.get(), index);
+            }
+        }
+        const auto& mergedPoints = _merged->points();
+        for (int index : { 0, mergedPoints.count() - 1 }) {
+            if (other->point_is_on_wire(mergedPoints.at(index).toPointF())) {
+                manager->connect_wire(other.get(), _merged.get(), index);
+            }
+        }
+    }
+
+    // Move the connector attachments of the chain ends to the merged wire
+    for (const auto& attachment : _attachments) {
+        const QPointF& point = attachment.wire->points().at(attachment.index).toPointF();
+        manager->detach_wire(attachment.connector);
+        manager->attach_wire_to_connector(_merged.get(), _merged->pointsAbsolute().indexOf(point), attachment.connector);
+    }
+
+    for (const auto& wire : _chain) {
+        takeOut(wire);
+    }
+}
+
+/**
+ * Removes the wire from the scene and the wire system without touching the
+ * rest of the net. Junctions on other wires stay, the geometry is unchanged.
+ */
+void CommandWireMerge::takeOut(const std::shared_ptr<Wire>& wire)
+{
+    auto manager = _scene->wire_manager();
+
+    // Detaching modifies the list, iterate over a copy
+    const auto connectors = manager->attached_connectors(wire.get());
+    for (const auto* connector : connectors) {
+        manager->detach_wire(connector);
+    }
+
+    // Wires only connect to wires of their own net
+    for (auto* other : wire->connected_wires()) {
+        wire->disconnectWire(other);
+    }
+    if (auto net = wire->net()) {
+        for (const auto& other : net->wires()) {
+            other->disconnectWire(wire.get());
+        }
+        net->removeWire(wire);
+    }
+    _scene->removeItem(wire);
+}
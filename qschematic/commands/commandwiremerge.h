@@ -0,0 +1,59 @@
+#pragma once
+
+#include "commandbase.h"
+
+#include <QPointer>
+#include <QVector>
+#include <memory>
+
+namespace wire_system
+{
+    class wire;
+    class connectable;
+}
+
+namespace QSchematic
+{
+    class Scene;
+    class Wire;
+
+    /**
+     * Replaces a chain of wires joined end-to-end by a single wire covering the
+     * same points. The net (and therefore its name and label), the connector
+     * attachments and the connections to other wires are kept.
+     */
+    class QSCHEMATIC_EXPORT CommandWireMerge :
+        public UndoCommand
+    {
+    public:
+        CommandWireMerge(const QPointer<Scene>& scene, const QVector<std::shared_ptr<Wire>>& chain, const std::shared_ptr<Wire>& merged, QUndoCommand* parent = nullptr);
+
+        virtual int id() const override;
+        virtual bool mergeWith(const QUndoCommand* command) override;
+        virtual void undo() override;
+        virtual void redo() override;
+
+    private:
+        struct Attachment
+        {
+            const wire_system::connectable* connector;
+            wire_system::wire* wire;
+            int index;
+        };
+
+        struct Connection
+        {
+            wire_system::wire* wire;
+            wire_system::wire* connectedWire;       // Has a point on wire
+        };
+
+        void takeOut(const std::shared_ptr<Wire>& wire);
+
+        QPointer<Scene> _scene;
+        QVector<std::shared_ptr<Wire>> _chain;
+        std::shared_ptr<Wire> _merged;
+        QVector<Attachment> _attachments;           // Of the chain
+        QVector<Connection> _connections;           // Of the chain
+    };
+
+}
@@ -27,3 +27,6 @@ find_package(
         Gui
         Widgets
 )
+
+# Threads
+find_package(Threads REQUIRED)
@@ -0,0 +1,76 @@
+#include "connector.h"
+#include "node.h"
+
+using namespace QSchematic::Headless;
+
+Connector::Connector(int type) :
+    _type(type),
+    _node(nullptr)
+{
+}
+
+#ifdef USE_GPDS
+void Connector::from_container(const gpds::container& container)
+{
+    if (const gpds::container* itemContainer = container.get_value<gpds::container*>("item").value_or(nullptr)) {
+        _pos.setX(itemContainer->get_value<double>("x").value_or(0));
+        _pos.setY(itemContainer->get_value<double>("y").value_or(0));
+    }
+    if (const gpds::container* labelContainer = container.get_value<gpds::container*>("label").value_or(nullptr)) {
+        _label.from_container(*labelContainer);
+    }
+}
+#endif
+int Connector::type() const
+{
+    return _type;
+}
+
+void Connector::setNode(const Node* node)
+{
+    _node = node;
+}
+
+const Node* Connector::node() const
+{
+    return _node;
+}
+
+void Connector::setPos(const QPointF& pos)
+{
+    _pos = pos;
+}
+
+QPointF Connector::pos() const
+{
+    return _pos;
+}
+
+QPointF Connector::scenePos() const
+{
+    if (!_node) {
+        return _pos;
+    }
+
+    return _node->mapToScene(_pos);
+}
+
+void Connector::setText(const QString& text)
+{
+    _label.setText(text);
+}
+
+QString Connector::text() const
+{
+    return _label.text();
+}
+
+const Label* Connector::label() const
+{
+    return &_label;
+}
+
+QPointF Connector::position() const
+{
+    return scenePos();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QPointF>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "label.h"
+#include "../wire_system/connectable.h"
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+    class Node;
+
+    /**
+     * Plain data counterpart of QSchematic::Connector. The position is relative
+     * to the parent node.
+     */
+    class QSCHEMATIC_EXPORT Connector :
+        public wire_system::connectable
+    {
+    public:
+        explicit Connector(int type = 0);
+        Connector(const Connector& other) = delete;
+        Connector(Connector&& other) = delete;
+        virtual ~Connector() = default;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        int type() const;
+        void setNode(const Node* node);
+        const Node* node() const;
+        void setPos(const QPointF& pos);
+        QPointF pos() const;
+        QPointF scenePos() const;
+        void setText(const QString& text);
+        QString text() const;
+        const Label* label() const;
+
+        // wire_system::connectable
+        QPointF position() const override;
+
+    private:
+        int _type;
+        const Node* _node;
+        QPointF _pos;
+        Label _label;
+    };
+
+}
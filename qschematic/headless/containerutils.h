@@ -0,0 +1,66 @@
+#pragma once
+
+#ifdef USE_GPDS
+#include <functional>
+#include <gpds/container.hpp>
+
+namespace QSchematic::Headless
+{
+
+    /**
+     * Custom item types store the container of their base class as a child value
+     * (eg. a custom node stores its Node container under "node"). This descends into
+     * the child containers until one that satisfies the predicate is found.
+     */
+    inline const gpds::container* findBaseContainer(const gpds::container& container, const std::function<bool(const gpds::container&)>& isBase)
+    {
+        if (isBase(container)) {
+            return &container;
+        }
+
+        for (const auto& [key, value] : container.values) {
+            const gpds::container* child = value.get<gpds::container*>().value_or(nullptr);
+            if (!child) {
+                continue;
+            }
+
+            if (const gpds::container* base = findBaseContainer(*child, isBase)) {
+                return base;
+            }
+        }
+
+        return nullptr;
+    }
+
+    inline bool hasContainer(const gpds::container& container, const std::string& key)
+    {
+        return container.get_value<gpds::container*>(key).value_or(nullptr) != nullptr;
+    }
+
+    inline bool isNodeContainer(const gpds::container& container)
+    {
+        return hasContainer(container, "connectors_configuration");
+    }
+
+    inline bool isConnectorContainer(const gpds::container& container)
+    {
+        return hasContainer(container, "label") && container.get_value<int>("text_direction").has_value();
+    }
+
+    inline bool isWireContainer(const gpds::container& container)
+    {
+        return hasContainer(container, "points");
+    }
+
+    inline bool isBusRipperContainer(const gpds::container& container)
+    {
+        return hasContainer(container, "node") && container.get_value<std::string>("member").has_value();
+    }
+
+    inline int typeId(const gpds::container& container)
+    {
+        return container.get_attribute<int>("type_id").value_or(-1);
+    }
+
+}
+#endif
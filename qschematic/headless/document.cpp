@@ -0,0 +1,197 @@
+#include "document.h"
+#include "node.h"
+#include "connector.h"
+#include "wire.h"
+#include "net.h"
+#include "containerutils.h"
+#include "../utils/scenecontainerreader.h"
+#include "../wire_system/manager.h"
+
+using namespace QSchematic::Headless;
+
+Document::Document()
+{
+    m_wire_manager = std::make_shared<wire_system::manager>();
+    m_wire_manager->set_net_factory([] { return std::make_shared<Net>(); });
+}
+
+Document::~Document()
+{
+    clear();
+}
+
+#ifdef USE_GPDS
+/**
+ * Restores the document from a container created by Scene::to_container().
+ * Custom item types are supported as long as they wrap the container of their
+ * base class.
+ */
+void Document::from_container(const gpds::container& container)
+{
+    clear();
+
+    SceneContainerReader reader;
+    reader.rect = [this](const QRect& rect) {
+        _sceneRect = rect;
+    };
+    reader.node = [this](const gpds::container& nodeContainer) {
+        const gpds::container* baseContainer = findBaseContainer(nodeContainer, isNodeContainer);
+        if (!baseContainer) {
+            qWarning("Document::from_container(): Couldn't restore node. Skipping.");
+            return;
+        }
+
+        auto node = std::make_shared<Node>(typeId(nodeContainer));
+        node->from_container(*baseContainer);
+        node->setBlock(QString::fromStdString(nodeContainer.get_value<std::string>("block_definition").value_or("")),
+                       QString::fromStdString(nodeContainer.get_value<std::string>("instance_name").value_or("")));
+        if (const gpds::container* ripperContainer = findBaseContainer(nodeContainer, isBusRipperContainer)) {
+            node->setBusRipper(QString::fromStdString(ripperContainer->get_value<std::string>("member").value_or("")));
+        }
+        addNode(node);
+    };
+    reader.net = [this](const gpds::container& netContainer) {
+        auto net = std::make_shared<Net>();
+        net->set_manager(m_wire_manager.get());
+        net->from_container(netContainer);
+        m_wire_manager->add_net(net);
+
+        // Wires
+        const gpds::container* wiresContainer = netContainer.get_value<gpds::container*>("wires").value_or(nullptr);
+        if (!wiresContainer) {
+            return;
+        }
+        for (const gpds::container* wireContainer : wiresContainer->get_values<gpds::container*>("wire")) {
+            const gpds::container* baseContainer = findBaseContainer(*wireContainer, isWireContainer);
+            if (!baseContainer) {
+                continue;
+            }
+
+            auto wire = std::make_shared<Wire>(typeId(*wireContainer));
+            wire->from_container(*baseContainer);
+            addWire(wire, net);
+        }
+    };
+    reader.connectors = [this] {
+        QVector<const wire_system::connectable*> list;
+        for (const auto& connector : connectors()) {
+            list << connector.get();
+        }
+        return list;
+    };
+    reader.read(container, *m_wire_manager);
+}
+#endif
+void Document::clear()
+{
+    // Don't leave the wire manager with dangling connectors
+    for (const auto& connector : connectors()) {
+        m_wire_manager->detach_wire(connector.get());
+    }
+
+    m_wire_manager->clear();
+    _wires.clear();
+    _nodes.clear();
+    _sceneRect = QRect();
+}
+
+void Document::setSettings(const Settings& settings)
+{
+    _settings = settings;
+    m_wire_manager->set_settings(settings);
+}
+
+QSchematic::Settings Document::settings() const
+{
+    return _settings;
+}
+
+void Document::setSceneRect(const QRect& rect)
+{
+    _sceneRect = rect;
+}
+
+QRect Document::sceneRect() const
+{
+    return _sceneRect;
+}
+
+bool Document::addNode(const std::shared_ptr<Node>& node)
+{
+    // Sanity check
+    if (!node) {
+        return false;
+    }
+
+    _nodes << node;
+
+    return true;
+}
+
+QList<std::shared_ptr<Node>> Document::nodes() const
+{
+    return _nodes;
+}
+
+QList<std::shared_ptr<Connector>> Document::connectors() const
+{
+    QList<std::shared_ptr<Connector>> list;
+    for (const auto& node : _nodes) {
+        list << node->connectors();
+    }
+
+    return list;
+}
+
+/**
+ * Adds a wire to the document. If no net is specified a new one is created by
+ * the wire manager.
+ */
+bool Document::addWire(const std::shared_ptr<Wire>& wire, const std::shared_ptr<Net>& net)
+{
+    // Sanity check
+    if (!wire) {
+        return false;
+    }
+
+    // The document keeps the wires alive, the nets only reference them
+    _wires << wire;
+
+    if (net) {
+        return net->addWire(wire);
+    }
+
+    return m_wire_manager->add_wire(wire);
+}
+
+QList<std::shared_ptr<Wire>> Document::wires() const
+{
+    return _wires;
+}
+
+QList<std::shared_ptr<Net>> Document::nets() const
+{
+    QList<std::shared_ptr<Net>> list;
+    for (const auto& net : m_wire_manager->nets()) {
+        if (auto headlessNet = std::dynamic_pointer_cast<Net>(net)) {
+            list << headlessNet;
+        }
+    }
+
+    return list;
+}
+
+std::shared_ptr<wire_system::manager> Document::wire_manager() const
+{
+    return m_wire_manager;
+}
+
+void Document::generateConnections()
+{
+    QVector<const wire_system::connectable*> list;
+    for (const auto& connector : connectors()) {
+        list << connector.get();
+    }
+
+    m_wire_manager->attach_connectors(list);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <QList>
+#include <QRect>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "../settings.h"
+#include "qschematic_export.h"
+
+namespace wire_system
+{
+    class manager;
+}
+
+namespace QSchematic::Headless
+{
+    class Node;
+    class Connector;
+    class Wire;
+    class Net;
+
+    /**
+     * A document model that doesn't depend on QtWidgets. It loads the same files
+     * as the Scene and keeps the nodes, connectors, wires, nets and labels as plain
+     * data on top of the wire_system. This is intended for batch jobs (netlisting,
+     * connectivity checks) which don't need a QApplication nor graphics items.
+     */
+    class QSCHEMATIC_EXPORT Document
+    {
+    public:
+        Document();
+        Document(const Document& other) = delete;
+        Document(Document&& other) = delete;
+        virtual ~Document();
+
+        Document& operator=(const Document& rhs) = delete;
+        Document& operator=(Document&& rhs) = delete;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        void clear();
+        void setSettings(const Settings& settings);
+        Settings settings() const;
+        void setSceneRect(const QRect& rect);
+        QRect sceneRect() const;
+        bool addNode(const std::shared_ptr<Node>& node);
+        QList<std::shared_ptr<Node>> nodes() const;
+        QList<std::shared_ptr<Connector>> connectors() const;
+        bool addWire(const std::shared_ptr<Wire>& wire, const std::shared_ptr<Net>& net = nullptr);
+        QList<std::shared_ptr<Wire>> wires() const;
+        QList<std::shared_ptr<Net>> nets() const;
+        std::shared_ptr<wire_system::manager> wire_manager() const;
+        void generateConnections();
+
+    private:
+        Settings _settings;
+        QRect _sceneRect;
+        QList<std::shared_ptr<Node>> _nodes;
+        QList<std::shared_ptr<Wire>> _wires;
+        std::shared_ptr<wire_system::manager> m_wire_manager;
+    };
+
+}
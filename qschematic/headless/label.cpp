@@ -0,0 +1,44 @@
+#include "label.h"
+
+using namespace QSchematic::Headless;
+
+#ifdef USE_GPDS
+void Label::from_container(const gpds::container& container)
+{
+    if (const gpds::container* itemContainer = container.get_value<gpds::container*>("item").value_or(nullptr)) {
+        _pos.setX(itemContainer->get_value<double>("x").value_or(0));
+        _pos.setY(itemContainer->get_value<double>("y").value_or(0));
+        _visible = itemContainer->get_value<bool>("visible").value_or(true);
+    }
+    _text = QString::fromStdString(container.get_value<std::string>("text").value_or(""));
+}
+#endif
+void Label::setText(const QString& text)
+{
+    _text = text;
+}
+
+QString Label::text() const
+{
+    return _text;
+}
+
+void Label::setPos(const QPointF& pos)
+{
+    _pos = pos;
+}
+
+QPointF Label::pos() const
+{
+    return _pos;
+}
+
+void Label::setVisible(bool visible)
+{
+    _visible = visible;
+}
+
+bool Label::isVisible() const
+{
+    return _visible;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QPointF>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+
+    /**
+     * Plain data counterpart of QSchematic::Label.
+     */
+    class QSCHEMATIC_EXPORT Label
+    {
+    public:
+        Label() = default;
+        Label(const Label& other) = default;
+        virtual ~Label() = default;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        void setText(const QString& text);
+        QString text() const;
+        void setPos(const QPointF& pos);
+        QPointF pos() const;
+        void setVisible(bool visible);
+        bool isVisible() const;
+
+    private:
+        QString _text;
+        QPointF _pos;
+        bool _visible = true;
+    };
+
+}
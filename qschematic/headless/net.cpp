@@ -0,0 +1,22 @@
+#include "net.h"
+
+using namespace QSchematic::Headless;
+
+#ifdef USE_GPDS
+/**
+ * Restores the name & label of the net. The wires are restored by the Document
+ * which owns them.
+ */
+void Net::from_container(const gpds::container& container)
+{
+    set_name(QString::fromStdString(container.get_value<std::string>("name").value_or("")));
+
+    if (const gpds::container* labelContainer = container.get_value<gpds::container*>("label").value_or(nullptr)) {
+        _label.from_container(*labelContainer);
+    }
+}
+#endif
+const Label* Net::label() const
+{
+    return &_label;
+}
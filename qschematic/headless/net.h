@@ -0,0 +1,35 @@
+#pragma once
+
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "label.h"
+#include "../wire_system/net.h"
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+
+    /**
+     * Plain data counterpart of QSchematic::WireNet.
+     */
+    class QSCHEMATIC_EXPORT Net :
+        public wire_system::net
+    {
+    public:
+        Net() = default;
+        Net(const Net& other) = delete;
+        Net(Net&& other) = delete;
+        virtual ~Net() override = default;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        const Label* label() const;
+
+    private:
+        Label _label;
+    };
+
+}
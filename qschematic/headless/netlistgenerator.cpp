@@ -0,0 +1,89 @@
+#include "netlistgenerator.h"
+#include "document.h"
+#include "node.h"
+#include "connector.h"
+#include "wire.h"
+#include "net.h"
+#include "../utils/netlistcore.h"
+
+using namespace QSchematic::Headless;
+
+namespace
+{
+
+    // Describes the bus wires & rippers of the document to the netlist core
+    QSchematic::NetlistCore::Buses buses(const Document& document)
+    {
+        QSchematic::NetlistCore::Buses buses;
+        buses.isBus = [](const wire_system::wire& wire) {
+            const auto* headlessWire = dynamic_cast<const Wire*>(&wire);
+            return headlessWire && headlessWire->isBus();
+        };
+        buses.ripper = [](const wire_system::connectable& connectable) -> std::optional<QSchematic::NetlistCore::Ripper> {
+            const auto* connector = dynamic_cast<const Connector*>(&connectable);
+            if (!connector || !connector->node() || !connector->node()->isBusRipper()) {
+                return std::nullopt;
+            }
+            return QSchematic::NetlistCore::Ripper { connector, connector->node()->busMember(), connector->node()->tapPoint() };
+        };
+
+        // Collected once instead of scanning all wires for every ripper
+        QVector<wire_system::wire*> busWires;
+        for (const auto& wire : document.wires()) {
+            if (wire->isBus()) {
+                busWires.append(wire.get());
+            }
+        }
+        buses.busesAt = [busWires](const QPointF&) {
+            return busWires;
+        };
+
+        return buses;
+    }
+
+}
+
+bool NetlistGenerator::generate(Netlist& netlist, const Document& document)
+{
+    // Add all nodes. Bus rippers only join nets, they aren't components.
+    std::vector<const Node*> nodes;
+    nodes.reserve(document.nodes().count());
+    for (const auto& node : document.nodes()) {
+        if (!node->isBusRipper()) {
+            nodes.push_back(node.get());
+        }
+    }
+
+    // Export nets
+    std::vector<NetlistNet> nets;
+    for (const auto& globalNet : QSchematic::NetlistCore::generate(*document.wire_manager(), buses(document))) {
+        NetlistNet net;
+        net.name = globalNet.name;
+
+        // Store wires
+        for (const auto* wire : globalNet.wires) {
+            if (auto headlessWire = dynamic_cast<const Wire*>(wire)) {
+                net.wires.push_back(headlessWire);
+            }
+        }
+
+        // Create the Connector/Node pairs
+        for (const auto* connectable : globalNet.connectors) {
+            const auto* connector = dynamic_cast<const Connector*>(connectable);
+            if (!connector || !connector->node()) {
+                continue;
+            }
+
+            net.nodes.push_back(connector->node());
+            net.connectors.push_back(connector);
+            net.connectorNodePairs.emplace(connector, connector->node());
+        }
+
+        nets.push_back(net);
+    }
+
+    // Set the netlist
+    netlist.set(std::move(nodes), std::move(nets));
+
+    return true;
+}
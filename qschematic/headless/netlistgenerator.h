@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../netlisttypes.h"
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+    class Document;
+    class Node;
+    class Connector;
+    class Wire;
+
+    using NetlistNet = QSchematic::Net<const Wire*, const Node*, const Connector*>;
+    using Netlist = QSchematic::Netlist<const Node*, const Connector*, const Wire*, NetlistNet>;
+
+    /**
+     * Headless counterpart of QSchematic::NetlistGenerator. Both group the nets
+     * through NetlistCore, the generated nets are the same as the ones generated
+     * from a Scene holding the same file.
+     */
+    class QSCHEMATIC_EXPORT NetlistGenerator
+    {
+    public:
+        static bool generate(Netlist& netlist, const Document& document);
+
+    private:
+        NetlistGenerator() = default;
+        NetlistGenerator(const NetlistGenerator& other) = default;
+        NetlistGenerator(NetlistGenerator&& other) = default;
+        virtual ~NetlistGenerator() = default;
+    };
+
+}
@@ -0,0 +1,160 @@
+#include <QTransform>
+#include "node.h"
+#include "connector.h"
+#include "containerutils.h"
+
+using namespace QSchematic::Headless;
+
+Node::Node(int type) :
+    _type(type),
+    _rotation(0),
+    _busRipper(false)
+{
+}
+
+#ifdef USE_GPDS
+void Node::from_container(const gpds::container& container)
+{
+    if (const gpds::container* itemContainer = container.get_value<gpds::container*>("item").value_or(nullptr)) {
+        _pos.setX(itemContainer->get_value<double>("x").value_or(0));
+        _pos.setY(itemContainer->get_value<double>("y").value_or(0));
+        _rotation = itemContainer->get_value<double>("rotation").value_or(0);
+    }
+    _size.setWidth(container.get_value<double>("width").value_or(0));
+    _size.setHeight(container.get_value<double>("height").value_or(0));
+
+    // Connectors
+    const gpds::container* connectorsContainer = container.get_value<gpds::container*>("connectors").value_or(nullptr);
+    if (connectorsContainer) {
+        _connectors.clear();
+        for (const gpds::container* connectorContainer : connectorsContainer->get_values<gpds::container*>("connector")) {
+            const gpds::container* baseContainer = findBaseContainer(*connectorContainer, isConnectorContainer);
+            if (!baseContainer) {
+                continue;
+            }
+
+            auto connector = std::make_shared<Connector>(typeId(*connectorContainer));
+            connector->from_container(*baseContainer);
+            addConnector(connector);
+        }
+    }
+}
+#endif
+int Node::type() const
+{
+    return _type;
+}
+
+void Node::setPos(const QPointF& pos)
+{
+    _pos = pos;
+}
+
+QPointF Node::pos() const
+{
+    return _pos;
+}
+
+void Node::setRotation(qreal degrees)
+{
+    _rotation = degrees;
+}
+
+qreal Node::rotation() const
+{
+    return _rotation;
+}
+
+void Node::setSize(const QSizeF& size)
+{
+    _size = size;
+}
+
+QSizeF Node::size() const
+{
+    return _size;
+}
+
+/**
+ * Maps a point from the node's coordinate system to the scene. This matches the
+ * transformation of the graphical Node which rotates around its center.
+ */
+QPointF Node::mapToScene(const QPointF& point) const
+{
+    if (qFuzzyIsNull(_rotation)) {
+        return _pos + point;
+    }
+
+    const QPointF& origin = QPointF(_size.width() / 2, _size.height() / 2);
+    QTransform transform;
+    transform.translate(_pos.x() + origin.x(), _pos.y() + origin.y());
+    transform.rotate(_rotation);
+    transform.translate(-origin.x(), -origin.y());
+
+    return transform.map(point);
+}
+
+/**
+ * Marks the node as an instance of a hierarchical block.
+ */
+void Node::setBlock(const QString& definition, const QString& instanceName)
+{
+    _blockDefinition = definition;
+    _instanceName = instanceName;
+}
+
+QString Node::blockDefinition() const
+{
+    return _blockDefinition;
+}
+
+QString Node::instanceName() const
+{
+    return _instanceName;
+}
+
+/**
+ * Marks the node as a bus ripper tapping the given member. Bus rippers join the
+ * net attached to their connector to the member, they aren't exported as nodes.
+ */
+void Node::setBusRipper(const QString& member)
+{
+    _busRipper = true;
+    _busMember = member;
+}
+
+bool Node::isBusRipper() const
+{
+    return _busRipper;
+}
+
+QString Node::busMember() const
+{
+    return _busMember;
+}
+
+/**
+ * The point placed on the bus, see QSchematic::BusRipper::tapPoint().
+ */
+QPointF Node::tapPoint() const
+{
+    return mapToScene(QPointF(0, 0));
+}
+
+bool Node::addConnector(const std::shared_ptr<Connector>& connector)
+{
+    // Sanity check
+    if (!connector) {
+        return false;
+    }
+
+    connector->setNode(this);
+    _connectors << connector;
+
+    return true;
+}
+
+QList<std::shared_ptr<Connector>> Node::connectors() const
+{
+    return _connectors;
+}
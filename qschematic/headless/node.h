@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <QList>
+#include <QPointF>
+#include <QSizeF>
+#include <QString>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+    class Connector;
+
+    /**
+     * Plain data counterpart of QSchematic::Node. Only the geometry and the
+     * connectors are retained, which is all that is needed for connectivity.
+     */
+    class QSCHEMATIC_EXPORT Node
+    {
+    public:
+        explicit Node(int type = 0);
+        Node(const Node& other) = delete;
+        Node(Node&& other) = delete;
+        virtual ~Node() = default;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        int type() const;
+        void setPos(const QPointF& pos);
+        QPointF pos() const;
+        void setRotation(qreal degrees);
+        qreal rotation() const;
+        void setSize(const QSizeF& size);
+        QSizeF size() const;
+        QPointF mapToScene(const QPointF& point) const;
+        void setBlock(const QString& definition, const QString& instanceName);
+        QString blockDefinition() const;
+        QString instanceName() const;
+        void setBusRipper(const QString& member);
+        bool isBusRipper() const;
+        QString busMember() const;
+        QPointF tapPoint() const;
+        bool addConnector(const std::shared_ptr<Connector>& connector);
+        QList<std::shared_ptr<Connector>> connectors() const;
+
+    private:
+        int _type;
+        QPointF _pos;
+        qreal _rotation;
+        QSizeF _size;
+        QString _blockDefinition;
+        QString _instanceName;
+        bool _busRipper;
+        QString _busMember;
+        QList<std::shared_ptr<Connector>> _connectors;
+    };
+
+}
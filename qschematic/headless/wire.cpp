@@ -0,0 +1,41 @@
+#include <algorithm>
+#include "wire.h"
+
+using namespace QSchematic::Headless;
+
+Wire::Wire(int type) :
+    _type(type)
+{
+}
+
+#ifdef USE_GPDS
+void Wire::from_container(const gpds::container& container)
+{
+    // Points
+    const gpds::container* pointsContainer = container.get_value<gpds::container*>("points").value_or(nullptr);
+    if (pointsContainer) {
+        auto points = pointsContainer->get_values<gpds::container*>("point");
+        // Sort points by index
+        std::sort(points.begin(), points.end(), [](gpds::container* a, gpds::container* b) {
+            return a->get_attribute<int>("index").value_or(0) < b->get_attribute<int>("index").value_or(0);
+        });
+        m_points.reserve(points.count());
+        for (const gpds::container* pointContainer : points) {
+            m_points.append(wire_system::point(pointContainer->get_value<double>("x").value_or(0),
+                                               pointContainer->get_value<double>("y").value_or(0)));
+        }
+    }
+}
+#endif
+int Wire::type() const
+{
+    return _type;
+}
+
+/**
+ * Bus wires are told apart by their type, BusWire doesn't store anything else.
+ */
+bool Wire::isBus() const
+{
+    return _type == BusType;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "../wire_system/wire.h"
+#include "qschematic_export.h"
+
+namespace QSchematic::Headless
+{
+
+    /**
+     * Plain data counterpart of QSchematic::Wire.
+     */
+    class QSCHEMATIC_EXPORT Wire :
+        public wire_system::wire
+    {
+    public:
+        explicit Wire(int type = 0);
+        Wire(const Wire& other) = delete;
+        Wire(Wire&& other) = delete;
+        virtual ~Wire() override = default;
+
+#ifdef USE_GPDS
+        void from_container(const gpds::container& container);
+#endif
+
+        int type() const;
+        bool isBus() const;
+
+        static constexpr int BusType = 65536 + 8;   // QSchematic::Item::BusWireType, QGraphicsItem isn't available here
+
+    private:
+        int _type;
+    };
+
+}
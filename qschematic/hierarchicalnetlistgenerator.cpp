@@ -0,0 +1,22 @@
+#include "hierarchicalnetlistgenerator.h"
+#include "blocklibrary.h"
+#include "scene.h"
+
+using namespace QSchematic;
+
+/**
+ * Returns false (and an empty netlist) if the hierarchy can't be flattened: a
+ * definition is missing, instantiates itself or the hierarchy is deeper than
+ * maxDepth.
+ */
+bool HierarchicalNetlistGenerator::generate(FlatNetlist& netlist, const Scene& scene, int maxDepth)
+{
+    const auto& library = scene.blockLibrary();
+    const NetlistFlattener::Lookup lookup = [&library](const QString& name) -> const BlockDefinition::Subnets* {
+        const auto& definition = library ? library->definition(name) : nullptr;
+        return definition ? &definition->subnets() : nullptr;
+    };
+
+    // Walk the hierarchy starting at the top level scene
+    return NetlistFlattener::flatten(netlist, BlockDefinition::subnetsFromScene(scene), lookup, maxDepth);
+}
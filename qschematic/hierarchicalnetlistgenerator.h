@@ -0,0 +1,29 @@
+#pragma once
+
+#include "utils/netlistflattener.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Scene;
+
+    /**
+     * Flattens a scene containing BlockInstances into a single netlist. The
+     * connectivity of every block definition is computed once (see
+     * BlockDefinition::subnets()) no matter how many times it is instantiated,
+     * and no sub-scene gets materialized.
+     */
+    class QSCHEMATIC_EXPORT HierarchicalNetlistGenerator
+    {
+    public:
+        static bool generate(FlatNetlist& netlist, const Scene& scene, int maxDepth = 32);
+
+    private:
+        HierarchicalNetlistGenerator() = default;
+        HierarchicalNetlistGenerator(const HierarchicalNetlistGenerator& other) = default;
+        HierarchicalNetlistGenerator(HierarchicalNetlistGenerator&& other) = default;
+        virtual ~HierarchicalNetlistGenerator() = default;
+    };
+
+}
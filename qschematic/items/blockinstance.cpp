@@ -0,0 +1,142 @@
+#include <QPainter>
+#include "blockinstance.h"
+#include "connector.h"
+#include "../blockdefinition.h"
+
+const QColor COLOR_BODY_FILL   = QColor("#d8e4f0");
+const QColor COLOR_BODY_BORDER = QColor(Qt::black);
+const QColor COLOR_TEXT        = QColor(Qt::black);
+const qreal PEN_WIDTH          = 1.5;
+
+using namespace QSchematic;
+
+BlockInstance::BlockInstance(int type, QGraphicsItem* parent) :
+    Node(type, parent)
+{
+    setAllowMouseResize(false);
+}
+
+#ifdef USE_GPDS
+gpds::container BlockInstance::to_container() const
+{
+    // Root
+    gpds::container root;
+    addItemTypeIdToContainer(root);
+    root.add_value("node", Node::to_container());
+    root.add_value("block_definition", _definitionName.toStdString());
+    root.add_value("instance_name", _instanceName.toStdString());
+
+    return root;
+}
+
+void BlockInstance::from_container(const gpds::container& container)
+{
+    Node::from_container(*container.get_value<gpds::container*>("node").value());
+    _definitionName = QString::fromStdString(container.get_value<std::string>("block_definition").value_or(""));
+    _instanceName = QString::fromStdString(container.get_value<std::string>("instance_name").value_or(""));
+}
+#endif
+
+std::shared_ptr<Item> BlockInstance::deepCopy() const
+{
+    auto clone = std::make_shared<BlockInstance>(type(), parentItem());
+    copyAttributes(*(clone.get()));
+
+    return clone;
+}
+
+void BlockInstance::copyAttributes(BlockInstance& dest) const
+{
+    Node::copyAttributes(dest);
+
+    // The definition is shared
+    dest._definition = _definition;
+    dest._definitionName = _definitionName;
+    dest._instanceName = _instanceName;
+}
+
+/**
+ * Sets the definition and rebuilds the size & connectors from it.
+ */
+void BlockInstance::setDefinition(const std::shared_ptr<BlockDefinition>& definition)
+{
+    _definition = definition;
+    if (!definition) {
+        return;
+    }
+
+    _definitionName = definition->name();
+    setSize(definition->size());
+
+    // Connectors
+    clearConnectors();
+    for (const BlockDefinition::Port& port : definition->ports()) {
+        auto connector = std::make_shared<Connector>(Item::ConnectorType, QPoint(), port.name);
+        connector->setPos(port.pos);
+        addConnector(connector);
+    }
+
+    Item::update();
+}
+
+/**
+ * Returns the definition or nullptr once it was removed from the library.
+ */
+std::shared_ptr<BlockDefinition> BlockInstance::definition() const
+{
+    return _definition.lock();
+}
+
+QString BlockInstance::definitionName() const
+{
+    return _definitionName;
+}
+
+void BlockInstance::setInstanceName(const QString& name)
+{
+    _instanceName = name;
+
+    Item::update();
+}
+
+QString BlockInstance::instanceName() const
+{
+    return _instanceName;
+}
+
+void BlockInstance::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    // Shadow
+    paintShadow(*painter);
+
+    // Body
+    QPen bodyPen;
+    bodyPen.setWidthF(PEN_WIDTH);
+    bodyPen.setStyle(Qt::SolidLine);
+    bodyPen.setColor(COLOR_BODY_BORDER);
+    painter->setPen(bodyPen);
+    painter->setBrush(COLOR_BODY_FILL);
+    painter->drawRect(sizeRect());
+
+    // Double border marks the hierarchy
+    const qreal inset = _settings.gridSize / 4.0;
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(sizeRect().adjusted(inset, inset, -inset, -inset));
+
+    // Instance & definition name
+    painter->setPen(COLOR_TEXT);
+    painter->drawText(sizeRect(), Qt::AlignCenter, QStringLiteral("%1\n%2").arg(_instanceName, _definitionName));
+
+    // Rotate handle
+    if (isSelected() && allowMouseRotate()) {
+        paintRotateHandle(*painter);
+    }
+}
+
+void BlockInstance::mouseDoubleClickEvent([[maybe_unused]] QGraphicsSceneMouseEvent* event)
+{
+    emit descendRequested();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "node.h"
+#include "qschematic_export.h"
+
+namespace QSchematic {
+
+    class BlockDefinition;
+
+    /**
+     * A single node representing an instance of a hierarchical block. The
+     * connectors are created from the ports of the definition. The internals of
+     * the block are not part of the scene. The definition is owned by the
+     * BlockLibrary, the instance only references it.
+     */
+    class QSCHEMATIC_EXPORT BlockInstance :
+        public Node
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(BlockInstance)
+
+    signals:
+        void descendRequested();
+
+    public:
+        BlockInstance(int type = Item::BlockInstanceType, QGraphicsItem* parent = nullptr);
+        virtual ~BlockInstance() override = default;
+
+#ifdef USE_GPDS
+        virtual gpds::container to_container() const override;
+        virtual void from_container(const gpds::container& container) override;
+#endif
+        virtual std::shared_ptr<Item> deepCopy() const override;
+
+        void setDefinition(const std::shared_ptr<BlockDefinition>& definition);
+        std::shared_ptr<BlockDefinition> definition() const;
+        QString definitionName() const;
+        void setInstanceName(const QString& name);
+        QString instanceName() const;
+
+        virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    protected:
+        void copyAttributes(BlockInstance& dest) const;
+        void mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event) override;
+
+    private:
+        std::weak_ptr<BlockDefinition> _definition;        // Owned by the library, the sub-scene of the definition may contain this instance
+        QString _definitionName;
+        QString _instanceName;
+    };
+
+}
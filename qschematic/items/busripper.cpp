@@ -0,0 +1,138 @@
+#include <QPainter>
+#include "busripper.h"
+#include "connector.h"
+#include "label.h"
+
+const QColor COLOR      = QColor("#1c3f94");
+const qreal LINE_WIDTH  = 2;
+const qreal TAP_RADIUS  = 3;
+
+using namespace QSchematic;
+
+BusRipper::BusRipper(int type, QGraphicsItem* parent) :
+    Node(type, parent)
+{
+    // Connector
+    auto connector = std::make_shared<Connector>();
+    connector->label()->setVisible(false);
+    connector->setGridPos(1, 1);
+    addConnector(connector);
+
+    // Misc
+    setSize(_settings.gridSize, _settings.gridSize);
+    setAllowMouseResize(false);
+}
+
+#ifdef USE_GPDS
+gpds::container BusRipper::to_container() const
+{
+    // Root
+    gpds::container root;
+    addItemTypeIdToContainer(root);
+    root.add_value("node", Node::to_container());
+    root.add_value("member", _member.toStdString());
+
+    return root;
+}
+
+void BusRipper::from_container(const gpds::container& container)
+{
+    Node::from_container(*container.get_value<gpds::container*>("node").value());
+    setMember(QString::fromStdString(container.get_value<std::string>("member").value_or("")));
+}
+#endif
+
+std::shared_ptr<Item> BusRipper::deepCopy() const
+{
+    auto clone = std::make_shared<BusRipper>(type(), parentItem());
+    copyAttributes(*(clone.get()));
+
+    return clone;
+}
+
+void BusRipper::copyAttributes(BusRipper& dest) const
+{
+    Node::copyAttributes(dest);
+
+    dest._member = _member;
+}
+
+/**
+ * Sets the name of the bus member this ripper taps (eg. "D5").
+ */
+void BusRipper::setMember(const QString& member)
+{
+    if (_member == member) {
+        return;
+    }
+
+    prepareGeometryChange();
+    const QString previousMember = _member;
+    _member = member;
+
+    Item::update();
+
+    emit memberChanged(previousMember);
+}
+
+QString BusRipper::member() const
+{
+    return _member;
+}
+
+/**
+ * The point in scene coordinates that has to lie on the bus.
+ */
+QPointF BusRipper::tapPoint() const
+{
+    return mapToScene(sizeRect().topLeft());
+}
+
+std::shared_ptr<Connector> BusRipper::connector() const
+{
+    return connectors().value(0);
+}
+
+QRectF BusRipper::boundingRect() const
+{
+    return Node::boundingRect().united(textRect());
+}
+
+void BusRipper::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    const qreal opacity = painter->opacity();
+
+    const QRectF& rect = sizeRect();
+
+    // Highlight
+    painter->setOpacity(isHighlighted() ? opacity * 0.5 : opacity);
+
+    // Entry
+    QPen pen(Qt::SolidLine);
+    pen.setWidthF(LINE_WIDTH);
+    pen.setCapStyle(Qt::RoundCap);
+    pen.setColor(COLOR);
+    painter->setPen(pen);
+    painter->setBrush(COLOR);
+    painter->drawLine(rect.topLeft(), rect.bottomRight());
+    painter->drawEllipse(rect.topLeft(), TAP_RADIUS, TAP_RADIUS);
+
+    // Member name
+    painter->setOpacity(opacity);
+    painter->drawText(textRect(), Qt::AlignLeft | Qt::AlignBottom, _member);
+
+    // Rotate handle
+    if (isSelected() && allowMouseRotate()) {
+        paintRotateHandle(*painter);
+    }
+}
+
+QRectF BusRipper::textRect() const
+{
+    const QRectF& rect = sizeRect();
+
+    return QRectF(rect.center().x(), rect.top() - rect.height(), 4 * rect.width(), rect.height());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "node.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    /**
+     * Taps a single member out of a BusWire. The tap point (the top left corner)
+     * is placed on the bus, the connector (the bottom right corner) is wired like
+     * any other connector. The net attached to the connector becomes part of the
+     * member net.
+     */
+    class QSCHEMATIC_EXPORT BusRipper :
+        public Node
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(BusRipper)
+
+    signals:
+        void memberChanged(const QString& previousMember);
+
+    public:
+        BusRipper(int type = Item::BusRipperType, QGraphicsItem* parent = nullptr);
+        virtual ~BusRipper() override = default;
+
+#ifdef USE_GPDS
+        virtual gpds::container to_container() const override;
+        virtual void from_container(const gpds::container& container) override;
+#endif
+        virtual std::shared_ptr<Item> deepCopy() const override;
+
+        void setMember(const QString& member);
+        QString member() const;
+        QPointF tapPoint() const;
+        std::shared_ptr<Connector> connector() const;
+
+        virtual QRectF boundingRect() const override;
+        virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    protected:
+        void copyAttributes(BusRipper& dest) const;
+
+    private:
+        QRectF textRect() const;
+
+        QString _member;
+    };
+
+}
@@ -0,0 +1,95 @@
+#include <QPainter>
+#include "buswire.h"
+#include "../utils.h"
+#include "../utils/netlistcore.h"
+#include "../headless/wire.h"
+
+const qreal LINE_WIDTH                 = 4;
+const qreal HANDLE_SIZE                = 3.0;
+const QColor COLOR                     = QColor("#1c3f94");
+const QColor COLOR_HIGHLIGHTED         = QColor("#dc2479");
+const QColor COLOR_SELECTED            = QColor("#0f16af");
+
+using namespace QSchematic;
+
+static_assert(Headless::Wire::BusType == Item::BusWireType, "The headless document has to recognize bus wires");
+
+BusWire::BusWire(int type, QGraphicsItem* parent) :
+    Wire(type, parent)
+{
+}
+
+std::shared_ptr<Item> BusWire::deepCopy() const
+{
+    auto clone = std::make_shared<BusWire>(type(), parentItem());
+    copyAttributes(*(clone.get()));
+
+    return clone;
+}
+
+QStringList BusWire::members()
+{
+    const auto& wireNet = net();
+    if (!wireNet) {
+        return { };
+    }
+
+    return Utils::busMembers(wireNet->name());
+}
+
+/**
+ * Returns whether the point (in scene coordinates) lies on one of the segments.
+ */
+bool BusWire::containsScenePoint(const QPointF& point, qreal tolerance) const
+{
+    // Same test as the one used for netlisting
+    return NetlistCore::containsPoint(*this, point, tolerance);
+}
+
+void BusWire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    const qreal opacity = painter->opacity();
+
+    // Pen
+    QPen penLine;
+    penLine.setStyle(Qt::SolidLine);
+    penLine.setCapStyle(Qt::RoundCap);
+    penLine.setJoinStyle(Qt::RoundJoin);
+    if (isSelected()) {
+        penLine.setColor(COLOR_SELECTED);
+    } else if (isHighlighted()) {
+        penLine.setColor(COLOR_HIGHLIGHTED);
+    } else if (valueColor().isValid()) {
+        penLine.setColor(valueColor());
+    } else {
+        penLine.setColor(COLOR);
+    }
+    penLine.setWidthF(LINE_WIDTH);
+
+    // Draw the actual line
+    painter->setPen(penLine);
+    painter->setBrush(Qt::NoBrush);
+    const auto& points = pointsRelative();
+    painter->drawPolyline(points.constData(), points.count());
+
+    // Draw the handles (if selected)
+    if (isSelected()) {
+        painter->setOpacity(opacity * 0.5);
+        painter->setPen(QPen(Qt::black));
+        painter->setBrush(QBrush(Qt::black));
+        for (const QPointF& point : points) {
+            painter->drawRect(QRectF(point.x() - HANDLE_SIZE, point.y() - HANDLE_SIZE, 2*HANDLE_SIZE, 2*HANDLE_SIZE));
+        }
+    }
+
+    // Draw debugging stuff
+    if (_settings.debug) {
+        painter->setOpacity(opacity);
+        painter->setPen(Qt::red);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRect(boundingRect());
+    }
+}
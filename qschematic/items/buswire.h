@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QStringList>
+#include "wire.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    /**
+     * A wire bundling many parallel nets. The members are given by the name of
+     * the net the bus belongs to (eg. "D[63:0]"), see Utils::busMembers().
+     * Individual members are connected through BusRippers placed on the bus.
+     */
+    class QSCHEMATIC_EXPORT BusWire :
+        public Wire
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(BusWire)
+
+    public:
+        BusWire(int type = Item::BusWireType, QGraphicsItem* parent = nullptr);
+        virtual ~BusWire() override = default;
+
+        virtual std::shared_ptr<Item> deepCopy() const override;
+
+        QStringList members();
+        bool containsScenePoint(const QPointF& point, qreal tolerance = 0.5) const;
+
+    protected:
+        virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+    };
+
+}
@@ -368,6 +368,12 @@ void Connector::notify_wire_manager()
         return;
     }
 
+    // The node notifies the wire system once it's done moving its connectors
+    const Node* node = dynamic_cast<const Node*>(parentItem());
+    if (node && node->isRelocatingConnectors()) {
+        return;
+    }
+
     // Notify the wire system when the connector moves
     scene()->wire_manager()->connector_moved(this);
 }
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include "item.h"
 #include "../scene.h"
+#include "../layer.h"
 #include "../commands/commanditemmove.h"
 
 #include <QDebug>
@@ -56,6 +57,9 @@ gpds::container Item::to_container() const
     root.add_value("visible", isVisible());
     root.add_value("snap_to_grid", snapToGrid());
     root.add_value("highlight", highlightEnabled());
+    if (_layer) {
+        root.add_value("layer", _layer->name().toStdString());
+    }
 
     return root;
 }
@@ -69,6 +73,12 @@ void Item::from_container(const gpds::container& container)
     setVisible(container.get_value<bool>("visible").value_or(true));
     setSnapToGrid(container.get_value<bool>("snap_to_grid").value_or(true));
     setHighlightEnabled(container.get_value<bool>("highlight").value_or(false));
+
+    // Layer (resolved by name once the item or its parent is added to a scene)
+    const QString& layerName = QString::fromStdString(container.get_value<std::string>("layer").value_or(""));
+    if (!layerName.isEmpty()) {
+        _layer = std::make_shared<Layer>(layerName);
+    }
 }
 #endif
 void Item::copyAttributes(Item& dest) const
@@ -85,6 +95,7 @@ void Item::copyAttributes(Item& dest) const
     dest._highlighted = _highlighted;
     dest._oldPos = _oldPos;
     dest._oldRot = _oldRot;
+    dest._layer = _layer;
 }
 #ifdef USE_GPDS
 void Item::addItemTypeIdToContainer(gpds::container& container) const
@@ -284,28 +295,38 @@ bool Item::highlightEnabled() const
 }
 
 QPixmap Item::toPixmap(QPointF& hotSpot, qreal scale)
+{
+    return QPixmap::fromImage(toImage(hotSpot, scale));
+}
+
+/**
+ * Renders the item and its children into an image. Unlike toPixmap() this can
+ * be used from worker threads as long as the item isn't modified meanwhile.
+ */
+QImage Item::toImage(QPointF& hotSpot, qreal scale, qreal devicePixelRatio)
 {
     // Retrieve the bounding rect
     QRectF rectF = boundingRect();
     rectF = rectF.united(childrenBoundingRect());
 
-    // Adjust the rectangle as the QPixmap doesn't handle negative coordinates
+    // Adjust the rectangle as the QImage doesn't handle negative coordinates
     rectF.setWidth(rectF.width() - rectF.x());
     rectF.setHeight(rectF.height() - rectF.y());
     const QRect& rect = rectF.toRect();
     if (rect.isNull() || !rect.isValid()) {
-        return QPixmap();
+        return QImage();
     }
 
     // Provide the hot spot
     hotSpot = -rectF.topLeft();
 
-    // Create the pixmap
-    QPixmap pixmap(rect.size() * scale);
-    pixmap.fill(Qt::transparent);
+    // Create the image
+    QImage image(rect.size() * scale * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::transparent);
 
     // Render
-    QPainter painter(&pixmap);
+    QPainter painter(&image);
     painter.setRenderHint(QPainter::Antialiasing, _settings.antialiasing);
     painter.setRenderHint(QPainter::TextAntialiasing, _settings.antialiasing);
     painter.scale(scale, scale);
@@ -320,7 +341,114 @@ QPixmap Item::toPixmap(QPointF& hotSpot, qreal scale)
 
     painter.end();
 
-    return pixmap;
+    return image;
+}
+
+/**
+ * Explicitly assigns the item to a layer. Pass nullptr to fall back to the
+ * layer assigned to the item type (or the one of the parent item).
+ */
+void Item::setLayer(const std::shared_ptr<Layer>& layer)
+{
+    _layer = layer;
+
+    applyLayer();
+}
+
+/**
+ * Returns the layer the item was explicitly assigned to (if any).
+ */
+std::shared_ptr<Layer> Item::layer() const
+{
+    return _layer;
+}
+
+/**
+ * Returns the layer the item belongs to: The explicitly assigned one, the one
+ * assigned to the item type or the one of the parent item, in that order.
+ */
+std::shared_ptr<Layer> Item::effectiveLayer() const
+{
+    if (_layer) {
+        return _layer;
+    }
+
+    if (auto s = scene()) {
+        if (auto typeLayer = s->layerForType(type())) {
+            return typeLayer;
+        }
+    }
+
+    if (auto parent = dynamic_cast<const Item*>(parentItem())) {
+        return parent->effectiveLayer();
+    }
+
+    return nullptr;
+}
+
+/**
+ * Applies the state of the effective layer to this item and its children. A
+ * hidden layer makes the item fully transparent which excludes it (and its
+ * children) from painting. Children sharing the layer of their parent inherit
+ * its opacity. The scene calls this whenever the state of a layer changes.
+ */
+void Item::applyLayer()
+{
+    const auto& layer = effectiveLayer();
+    const auto* parent = dynamic_cast<const Item*>(parentItem());
+    if (!layer || (parent && parent->effectiveLayer() == layer)) {
+        setOpacity(1.0);
+    } else {
+        setOpacity(layer->isVisible() ? layer->opacity() : 0.0);
+    }
+
+    for (QGraphicsItem* child : childItems()) {
+        if (auto* item = dynamic_cast<Item*>(child)) {
+            item->applyLayer();
+        }
+    }
+}
+
+bool Item::contains(const QPointF& point) const
+{
+    return acceptsHitTest() && QGraphicsObject::contains(point);
+}
+
+bool Item::collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode) const
+{
+    return acceptsHitTest() && QGraphicsObject::collidesWithPath(path, mode);
+}
+
+/**
+ * Counts the hit-test in debug mode and returns whether the item takes part in
+ * hit-testing at all. Subclasses implementing their own hit-tests call this
+ * first.
+ */
+bool Item::acceptsHitTest() const
+{
+    // Keep track of the hit-tests in debug mode
+    if (_settings.debug) {
+        if (auto s = scene()) {
+            s->countHitTest();
+        }
+    }
+
+    // Hidden and locked layers are excluded from hit-testing and rubber band selection
+    if (const auto& layer = effectiveLayer(); layer && !layer->isHitTestable()) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Returns whether the item should be painted using the cheaper rendering
+ * profile because an interaction is in progress.
+ */
+bool Item::reducedQuality() const
+{
+    auto s = scene();
+    return s && s->reducedQuality();
 }
 
 QVariant Item::itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant& value)
@@ -333,6 +461,17 @@ QVariant Item::itemChange(QGraphicsItem::GraphicsItemChange change, const QVaria
         prepareGeometryChange();
         return QGraphicsItem::itemChange(change, value);
     }
+    case QGraphicsItem::ItemSceneHasChanged:
+    {
+        // Layers are shared by name, adopt the layer of the new scene. This is
+        // also sent to the children when the parent is added.
+        auto s = scene();
+        if (s && _layer && s->layer(_layer->name()) != _layer) {
+            _layer = s->addLayer(_layer->name());
+        }
+        applyLayer();
+        return QGraphicsItem::itemChange(change, value);
+    }
     case QGraphicsItem::ItemPositionChange:
     {
         QPointF newPos = value.toPointF();
@@ -353,6 +492,7 @@ QVariant Item::itemChange(QGraphicsItem::GraphicsItemChange change, const QVaria
             connect(parent, &Item::moved, this, &Item::scenePosChanged);
             connect(parent, &Item::rotated, this, &Item::scenePosChanged);
         }
+        applyLayer();
         return value;
     }
 
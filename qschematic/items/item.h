@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <QGraphicsObject>
+#include <QImage>
 #ifdef USE_GPDS
 #include <gpds/serialize.hpp>
 #endif
@@ -16,6 +17,7 @@ namespace QSchematic
 {
     class Scene;
     class Item;
+    class Layer;
 
     class QSCHEMATIC_EXPORT Item :
         public QGraphicsObject,
@@ -35,6 +37,9 @@ namespace QSchematic
             ConnectorType,
             LabelType,
             SplineWireType,
+            BlockInstanceType,
+            BusWireType,
+            BusRipperType,
 
             QSchematicItemUserType = QGraphicsItem::UserType + 100
         };
@@ -127,7 +132,14 @@ namespace QSchematic
         void setHighlightEnabled(bool enabled);
         bool highlightEnabled() const;
         QPixmap toPixmap(QPointF& hotSpot, qreal scale = 1.0);
+        QImage toImage(QPointF& hotSpot, qreal scale = 1.0, qreal devicePixelRatio = 1.0);
         virtual void update();
+        void setLayer(const std::shared_ptr<Layer>& layer);
+        std::shared_ptr<Layer> layer() const;
+        std::shared_ptr<Layer> effectiveLayer() const;
+        void applyLayer();
+        virtual bool contains(const QPointF& point) const override;
+        virtual bool collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
         Scene* scene() const;
 
     signals:
@@ -146,6 +158,8 @@ namespace QSchematic
 #endif
 
         bool isHighlighted() const;
+        bool acceptsHitTest() const;
+        bool reducedQuality() const;
         virtual QVariant itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant& value) override;
 
     private slots:
@@ -160,6 +174,7 @@ namespace QSchematic
         bool _highlighted;
         QPointF _oldPos;
         qreal _oldRot;
+        std::shared_ptr<Layer> _layer;
     };
 
 }
@@ -5,6 +5,9 @@
 #include "splinewire.h"
 #include "connector.h"
 #include "label.h"
+#include "blockinstance.h"
+#include "buswire.h"
+#include "busripper.h"
 
 using namespace QSchematic;
 
@@ -52,6 +55,15 @@ std::shared_ptr<Item> ItemFactory::from_container(const gpds::container& contain
     case Item::LabelType:
         return std::make_shared<Label>();
 
+    case Item::BlockInstanceType:
+        return std::make_shared<BlockInstance>();
+
+    case Item::BusWireType:
+        return std::make_shared<BusWire>();
+
+    case Item::BusRipperType:
+        return std::make_shared<BusRipper>();
+
     case Item::QSchematicItemUserType:
         break;
     }
@@ -2,12 +2,15 @@
 #include <QPainter>
 #include <QPen>
 #include <QBrush>
+#include <QtMath>
 #include "label.h"
 #include "../scene.h"
 
 const QColor COLOR_LABEL             = QColor("#000000");
 const QColor COLOR_LABEL_HIGHLIGHTED = QColor("#dc2479");
 const qreal LABEL_TEXT_PADDING = 2;
+const qreal LABEL_VALUE_SPACING = 4;
+const qreal LABEL_TEXT_BOX_OPACITY = 0.3;
 
 using namespace QSchematic;
 
@@ -77,6 +80,9 @@ void Label::copyAttributes(Label& dest) const
 QRectF Label::boundingRect() const
 {
     QRectF rect = _textRect;
+    if (!_valueText.isEmpty()) {
+        rect = rect.united(_valueRect);
+    }
     if(isHighlighted()) {
         rect = rect.united(QRectF(_textRect.center(), mapFromParent(_connectionPoint)));
     }
@@ -126,6 +132,46 @@ void Label::calculateTextRect()
     QFontMetricsF fontMetrics(_font);
     _textRect = fontMetrics.boundingRect(_text);
     _textRect.adjust(-LABEL_TEXT_PADDING, -LABEL_TEXT_PADDING, LABEL_TEXT_PADDING, LABEL_TEXT_PADDING);
+
+    calculateValueRect();
+}
+
+void Label::calculateValueRect()
+{
+    QRectF valueRect;
+    if (!_valueText.isEmpty()) {
+        QFontMetricsF fontMetrics(_font);
+        valueRect = fontMetrics.boundingRect(_valueText);
+        valueRect.adjust(-LABEL_TEXT_PADDING, -LABEL_TEXT_PADDING, LABEL_TEXT_PADDING, LABEL_TEXT_PADDING);
+        valueRect.moveTopLeft(QPointF(_textRect.right() + LABEL_VALUE_SPACING, _textRect.top()));
+    }
+
+    if (valueRect != _valueRect) {
+        prepareGeometryChange();
+        _valueRect = valueRect;
+    }
+}
+
+/**
+ * Shows a (live) value next to the text. An empty text removes it. The value
+ * is not part of the serialized label.
+ */
+void Label::setValueText(const QString& text, const QColor& color)
+{
+    if (_valueText == text && _valueColor == color) {
+        return;
+    }
+
+    _valueText = text;
+    _valueColor = color;
+    calculateValueRect();
+
+    Item::update();
+}
+
+QString Label::valueText() const
+{
+    return _valueText;
 }
 
 QString Label::text() const
@@ -187,11 +233,37 @@ void Label::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWi
     textOption.setWrapMode(QTextOption::NoWrap);
     textOption.setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
 
-    // Draw the text
-    painter->setPen(COLOR_LABEL);
-    painter->setBrush(Qt::NoBrush);
-    painter->setFont(_font);
-    painter->drawText(_textRect, _text, textOption);
+    // Small text is drawn as boxes while an interaction is in progress
+    bool drawBoxes = false;
+    if (reducedQuality()) {
+        const qreal deviceScale = qSqrt(qAbs(painter->worldTransform().determinant()));
+        drawBoxes = QFontMetricsF(_font).height() * deviceScale < _settings.adaptiveQualityTextSize;
+    }
+    if (drawBoxes) {
+        const qreal opacity = painter->opacity();
+        const qreal p = LABEL_TEXT_PADDING;
+        painter->setOpacity(opacity * LABEL_TEXT_BOX_OPACITY);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(COLOR_LABEL);
+        painter->drawRect(_textRect.adjusted(p, p, -p, -p));
+        if (!_valueText.isEmpty()) {
+            painter->setBrush(_valueColor.isValid() ? _valueColor : COLOR_LABEL);
+            painter->drawRect(_valueRect.adjusted(p, p, -p, -p));
+        }
+        painter->setOpacity(opacity);
+    } else {
+        // Draw the text
+        painter->setPen(COLOR_LABEL);
+        painter->setBrush(Qt::NoBrush);
+        painter->setFont(_font);
+        painter->drawText(_textRect, _text, textOption);
+
+        // Draw the value
+        if (!_valueText.isEmpty()) {
+            painter->setPen(_valueColor.isValid() ? _valueColor : COLOR_LABEL);
+            painter->drawText(_valueRect, _valueText, textOption);
+        }
+    }
 
     // Draw the bounding rect if debug mode is enabled
     if (_settings.debug) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QColor>
 #include <QFont>
 
 #include "item.h"
@@ -40,6 +41,8 @@ namespace QSchematic {
         bool hasConnectionPoint() const;
         void setConnectionPoint(const QPointF& connectionPoint);    // Parent coordinates
         QRectF textRect() const;
+        void setValueText(const QString& text, const QColor& color = QColor());
+        QString valueText() const;
 
     protected:
         void copyAttributes(Label& dest) const;
@@ -48,12 +51,16 @@ namespace QSchematic {
 
     private:
         void calculateTextRect();
+        void calculateValueRect();
 
         QString _text;
         QFont _font;
         QRectF _textRect;
         bool _hasConnectionPoint;
         QPointF _connectionPoint;   // Parent coordinates
+        QString _valueText;
+        QColor _valueColor;
+        QRectF _valueRect;
     };
 
 }
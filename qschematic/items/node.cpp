@@ -1,7 +1,11 @@
 #include <QApplication>
 #include <QGraphicsSceneMouseEvent>
+#include <QCache>
+#include <QDataStream>
+#include <QMutex>
 #include <QPainter>
 #include <QtMath>
+#include <vector>
 #include "node.h"
 #include "itemfactory.h"
 #include "../commands/commandnoderesize.h"
@@ -23,6 +27,80 @@ using namespace QSchematic;
 const int DEFAULT_WIDTH     = 160;
 const int DEFAULT_HEIGHT    = 240;
 
+const QColor DEFAULT_SHADOW_COLOR      = QColor(63, 63, 63, 100);
+const QPointF DEFAULT_SHADOW_OFFSET    = QPointF(7, 7);
+const qreal DEFAULT_SHADOW_BLUR_RADIUS = 10;
+const qreal SHADOW_SCALE_MIN           = 1.0 / 16;
+const qreal SHADOW_SCALE_MAX           = 16;
+const int SHADOW_CACHE_SIZE_KB         = 10240;
+
+namespace
+{
+    // Nodes are also rendered on worker threads (eg. previews) so QPixmapCache can't be used
+    QMutex shadowCacheMutex;
+    QCache<QByteArray, QImage> shadowCache(SHADOW_CACHE_SIZE_KB);
+
+    /**
+     * Blurs the alpha channel of a premultiplied image, the color is discarded.
+     * Three box blur passes in each direction approximate a gaussian blur with a
+     * standard deviation of radius / 2. Outside of the image is transparent.
+     */
+    void blurAlpha(QImage& image, qreal radius)
+    {
+        const qreal sigma = radius / 2;
+        const int boxRadius = qRound((qSqrt(4 * sigma * sigma + 1) - 1) / 2);
+        const int boxSize = 2 * boxRadius + 1;
+        const int width = image.width();
+        const int height = image.height();
+
+        std::vector<int> alpha(static_cast<std::size_t>(width) * height);
+        for (int y = 0; y < height; y++) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            for (int x = 0; x < width; x++) {
+                alpha[y * width + x] = qAlpha(line[x]);
+            }
+        }
+
+        // Moving sum over the window [i - boxRadius, i + boxRadius]
+        std::vector<int> values(qMax(width, height));
+        auto boxBlur = [&](int start, int stride, int count) {
+            int sum = 0;
+            for (int i = 0; i < count; i++) {
+                values[i] = alpha[start + i * stride];
+                if (i <= boxRadius) {
+                    sum += values[i];
+                }
+            }
+            for (int i = 0; i < count; i++) {
+                alpha[start + i * stride] = (sum + boxSize / 2) / boxSize;
+                if (i + boxRadius + 1 < count) {
+                    sum += values[i + boxRadius + 1];
+                }
+                if (i - boxRadius >= 0) {
+                    sum -= values[i - boxRadius];
+                }
+            }
+        };
+        if (boxRadius > 0) {
+            for (int pass = 0; pass < 3; pass++) {
+                for (int y = 0; y < height; y++) {
+                    boxBlur(y * width, 1, width);
+                }
+                for (int x = 0; x < width; x++) {
+                    boxBlur(x, width, height);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; y++) {
+            QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+            for (int x = 0; x < width; x++) {
+                line[x] = qRgba(0, 0, 0, alpha[y * width + x]);
+            }
+        }
+    }
+}
+
 Node::Node(int type, QGraphicsItem* parent) :
     Item(type, parent),
     _mode(None),
@@ -31,7 +109,13 @@ Node::Node(int type, QGraphicsItem* parent) :
     _allowMouseRotate(true),
     _connectorsMovable(false),
     _connectorsSnapPolicy(Connector::NodeSizerectOutline),
-    _connectorsSnapToGrid(true)
+    _connectorsSnapToGrid(true),
+    _shadowEnabled(false),
+    _shadowColor(DEFAULT_SHADOW_COLOR),
+    _shadowOffset(DEFAULT_SHADOW_OFFSET),
+    _shadowBlurRadius(DEFAULT_SHADOW_BLUR_RADIUS),
+    _shadowValid(false),
+    _connectorRelocationDepth(0)
 {
     connect(this, &Node::settingsChanged, this, &Node::propagateSettings);
 }
@@ -141,6 +225,69 @@ void Node::copyAttributes(Node& dest) const
     dest._connectorsSnapPolicy = _connectorsSnapPolicy;
     dest._connectorsSnapToGrid = _connectorsSnapToGrid;
     dest._specialConnectors = _specialConnectors;
+    dest._shadowEnabled = _shadowEnabled;
+    dest._shadowColor = _shadowColor;
+    dest._shadowOffset = _shadowOffset;
+    dest._shadowBlurRadius = _shadowBlurRadius;
+    dest.invalidateShadow();
+}
+
+/**
+ * Enables a drop shadow below the body. This is a cheap replacement for a
+ * QGraphicsDropShadowEffect as the blurred shadow is only rendered once and
+ * shared between all nodes of the same shape.
+ */
+void Node::setShadowEnabled(bool enabled)
+{
+    if (_shadowEnabled == enabled) {
+        return;
+    }
+
+    prepareGeometryChange();
+    _shadowEnabled = enabled;
+    update();
+}
+
+bool Node::shadowEnabled() const
+{
+    return _shadowEnabled;
+}
+
+void Node::setShadowColor(const QColor& color)
+{
+    _shadowColor = color;
+    invalidateShadow();
+    update();
+}
+
+QColor Node::shadowColor() const
+{
+    return _shadowColor;
+}
+
+void Node::setShadowOffset(const QPointF& offset)
+{
+    prepareGeometryChange();
+    _shadowOffset = offset;
+    update();
+}
+
+QPointF Node::shadowOffset() const
+{
+    return _shadowOffset;
+}
+
+void Node::setShadowBlurRadius(qreal radius)
+{
+    prepareGeometryChange();
+    _shadowBlurRadius = qMax(0.0, radius);
+    invalidateShadow();
+    update();
+}
+
+qreal Node::shadowBlurRadius() const
+{
+    return _shadowBlurRadius;
 }
 
 Node::Mode Node::mode() const
@@ -165,8 +312,10 @@ void Node::setSize(const QSizeF& size)
     prepareGeometryChange();
 
     _size = size;
+    invalidateShadow();
 
     // Move connectors
+    beginConnectorRelocation();
     for (const auto& connector: connectors()) {
         if (qFuzzyCompare(connector->posX(), oldSize.width()) ||
             connector->posX() > size.width())
@@ -179,6 +328,7 @@ void Node::setSize(const QSizeF& size)
             connector->setY(size.height());
         }
     }
+    endConnectorRelocation();
 
     setTransformOriginPoint(sizeRect().center());
 
@@ -335,6 +485,46 @@ QList<std::shared_ptr<Connector>> Node::connectors() const
     return _connectors;
 }
 
+/**
+ * Stops the connectors from notifying the wire manager each time they move.
+ * Once the outermost relocation ends the attached wires are updated in a
+ * single pass. Calls can be nested.
+ */
+void Node::beginConnectorRelocation()
+{
+    _connectorRelocationDepth++;
+}
+
+void Node::endConnectorRelocation()
+{
+    Q_ASSERT(_connectorRelocationDepth > 0);
+    if (--_connectorRelocationDepth > 0) {
+        return;
+    }
+
+    // Ignore if it's not in a scene
+    if (!scene()) {
+        return;
+    }
+
+    QVector<const wire_system::connectable*> moved;
+    moved.reserve(_connectors.count() + _specialConnectors.count());
+    for (const auto& connector : _connectors) {
+        moved << connector.get();
+    }
+    for (const auto& connector : _specialConnectors) {
+        moved << connector.get();
+    }
+    scene()->wire_manager()->connectors_moved(moved);
+
+    update();
+}
+
+bool Node::isRelocatingConnectors() const
+{
+    return _connectorRelocationDepth > 0;
+}
+
 QList<QPointF> Node::connectionPointsRelative() const
 {
     QList<QPointF> list;
@@ -712,6 +902,11 @@ QRectF Node::boundingRect() const
         rect = rect.united(rotationHandle());
     }
 
+    // Shadow
+    if (_shadowEnabled) {
+        rect = rect.united(shadowRect());
+    }
+
     return rect;
 }
 
@@ -720,6 +915,8 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     Q_UNUSED(option)
     Q_UNUSED(widget)
 
+    const qreal opacity = painter->opacity();
+
     // Draw the bounding rect if debug mode is enabled
     if (_settings.debug) {
         painter->setPen(Qt::NoPen);
@@ -727,6 +924,9 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
         painter->drawRect(boundingRect());
     }
 
+    // Shadow
+    paintShadow(*painter);
+
     // Highlight rectangle
     if (isHighlighted()) {
         // Highlight pen
@@ -741,12 +941,12 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
         // Highlight rectangle
         painter->setPen(highlightPen);
         painter->setBrush(highlightBrush);
-        painter->setOpacity(0.5);
+        painter->setOpacity(opacity * 0.5);
         int adj = _settings.highlightRectPadding;
         painter->drawRoundedRect(sizeRect().adjusted(-adj, -adj, adj, adj), _settings.gridSize/2, _settings.gridSize/2);
     }
 
-    painter->setOpacity(1.0);
+    painter->setOpacity(opacity);
 
     // Body pen
     QPen bodyPen;
@@ -775,6 +975,155 @@ void Node::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     }
 }
 
+/**
+ * Returns the outline of the body which casts the shadow. The default is the
+ * rounded size rect as painted by Node::paint().
+ */
+QPainterPath Node::shadowPath() const
+{
+    QPainterPath path;
+    path.addRoundedRect(sizeRect(), _settings.gridSize/2, _settings.gridSize/2);
+
+    return path;
+}
+
+/**
+ * Returns the area covered by the shadow in item coordinates. The offset is
+ * in scene coordinates so that the shadow doesn't turn with the node.
+ */
+QRectF Node::shadowRect() const
+{
+    const qreal offset = qSqrt(QPointF::dotProduct(_shadowOffset, _shadowOffset));
+    const qreal adj = offset + _shadowBlurRadius;
+
+    QPainterPath path;
+    QByteArray key;
+    cachedShadow(path, key);
+
+    return path.boundingRect().adjusted(-adj, -adj, adj, adj);
+}
+
+/**
+ * Discards the cached shadowPath(). Subclasses have to call this if their
+ * shadowPath() changes for other reasons than a new size, rotation, settings
+ * or shadow parameters.
+ */
+void Node::invalidateShadow()
+{
+    QMutexLocker locker(&_shadowMutex);
+    _shadowValid = false;
+}
+
+/**
+ * Returns the shadowPath() and the part of the shadow cache key describing it,
+ * both are only rebuilt after invalidateShadow().
+ */
+void Node::cachedShadow(QPainterPath& path, QByteArray& key) const
+{
+    QMutexLocker locker(&_shadowMutex);
+    if (!_shadowValid) {
+        _shadowPath = shadowPath();
+
+        // This contains the exact parameters rather than a hash so that
+        // different shapes can never end up with the same shadow.
+        _shadowKey.clear();
+        QDataStream stream(&_shadowKey, QIODevice::WriteOnly);
+        stream << _shadowBlurRadius << _shadowColor.rgba() << _shadowPath.elementCount();
+        for (int i = 0; i < _shadowPath.elementCount(); i++) {
+            const QPainterPath::Element& element = _shadowPath.elementAt(i);
+            stream << element.x << element.y << qint32(element.type);
+        }
+        _shadowValid = true;
+    }
+
+    path = _shadowPath;
+    key = _shadowKey;
+}
+
+/**
+ * Renders the blurred shadow of shadowPath() once per shape, color, radius and
+ * zoom level into a global image cache and composites it onto the painter.
+ * Subclasses reimplementing paint() should call this before painting the body.
+ * This is safe to call from any thread.
+ */
+void Node::paintShadow(QPainter& painter) const
+{
+    if (!_shadowEnabled || reducedQuality()) {
+        return;
+    }
+
+    QPainterPath path;
+    QByteArray shapeKey;
+    cachedShadow(path, shapeKey);
+    if (path.isEmpty()) {
+        return;
+    }
+
+    // Quantize the device scale to steps of sqrt(2) so that zooming doesn't constantly re-render
+    const QTransform& transform = painter.worldTransform();
+    const qreal dpr = painter.device() ? painter.device()->devicePixelRatioF() : 1.0;
+    const qreal deviceScale = qSqrt(qAbs(transform.determinant())) * dpr;
+    const qreal scale = qBound(SHADOW_SCALE_MIN, qPow(2.0, qCeil(std::log2(qMax(deviceScale, SHADOW_SCALE_MIN)) * 2) / 2.0), SHADOW_SCALE_MAX);
+
+    // Cache key
+    QByteArray key;
+    {
+        QDataStream stream(&key, QIODevice::WriteOnly);
+        stream << scale;
+    }
+    key += shapeKey;
+
+    // Render the shadow if it is not cached yet
+    const QRectF& pathRect = path.boundingRect();
+    const qreal margin = _shadowBlurRadius;
+    const QRectF& sourceRect = pathRect.adjusted(-margin, -margin, margin, margin);
+    QImage image;
+    {
+        QMutexLocker locker(&shadowCacheMutex);
+        if (const QImage* cached = shadowCache.object(key)) {
+            image = *cached;
+        }
+    }
+    if (image.isNull()) {
+        const QSize& size = (sourceRect.size() * scale).toSize().expandedTo(QSize(1, 1));
+
+        // Shape
+        QImage shape(size, QImage::Format_ARGB32_Premultiplied);
+        shape.fill(Qt::transparent);
+        {
+            QPainter p(&shape);
+            p.setRenderHint(QPainter::Antialiasing, true);
+            p.scale(scale, scale);
+            p.translate(-sourceRect.topLeft());
+            p.fillPath(path, Qt::black);
+        }
+
+        // Blur
+        blurAlpha(shape, _shadowBlurRadius * scale);
+
+        // Colorize
+        {
+            QPainter p(&shape);
+            p.setCompositionMode(QPainter::CompositionMode_SourceIn);
+            p.fillRect(shape.rect(), _shadowColor);
+        }
+
+        image = shape;
+        QMutexLocker locker(&shadowCacheMutex);
+        shadowCache.insert(key, new QImage(shape), qMax(1, shape.bytesPerLine() * shape.height() / 1024));
+    }
+
+    // The offset is in scene coordinates, map it into the rotated item coordinates
+    QTransform rotation;
+    rotation.rotate(-this->rotation());
+    const QPointF& offset = rotation.map(_shadowOffset);
+
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.drawImage(sourceRect.translated(offset), image, QRectF(image.rect()));
+    painter.restore();
+}
+
 void Node::update()
 {
     // The item class sets the origin to the center of the bounding box
@@ -813,6 +1162,10 @@ QVariant Node::itemChange(QGraphicsItem::GraphicsItemChange change, const QVaria
         return newPos;
     }
 
+    case QGraphicsItem::ItemRotationHasChanged:
+        invalidateShadow();
+        return Item::itemChange(change, value);
+
     default:
         return Item::itemChange(change, value);
     }
@@ -872,6 +1225,9 @@ void Node::paintRotateHandle(QPainter& painter)
 
 void Node::propagateSettings()
 {
+    // The default shadow path depends on the grid size
+    invalidateShadow();
+
     for (const auto& connector : connectors()) {
         connector->setSettings(_settings);
     }
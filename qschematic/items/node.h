@@ -1,6 +1,10 @@
 #pragma once
 
 #include <QList>
+#include <QByteArray>
+#include <QColor>
+#include <QMutex>
+#include <QPainterPath>
 #include "item.h"
 #include "connector.h"
 #include "../types.h"
@@ -56,6 +60,9 @@ namespace QSchematic {
         bool removeConnector(const std::shared_ptr<Connector>& connector);
         void clearConnectors();
         QList<std::shared_ptr<Connector>> connectors() const;
+        void beginConnectorRelocation();
+        void endConnectorRelocation();
+        bool isRelocatingConnectors() const;
         QList<QPointF> connectionPointsRelative() const;
         QList<QPointF> connectionPointsAbsolute() const;
         void setConnectorsMovable(bool enabled);
@@ -65,6 +72,14 @@ namespace QSchematic {
         void setConnectorsSnapToGrid(bool enabled);
         bool connectorsSnapToGrid() const;
         void alignConnectorLabels() const;
+        void setShadowEnabled(bool enabled);
+        bool shadowEnabled() const;
+        void setShadowColor(const QColor& color);
+        QColor shadowColor() const;
+        void setShadowOffset(const QPointF& offset);
+        QPointF shadowOffset() const;
+        void setShadowBlurRadius(qreal radius);
+        qreal shadowBlurRadius() const;
 
         /**
          * @brief not really an event per se, but this seems the best way to
@@ -92,9 +107,14 @@ namespace QSchematic {
         QRectF rotationHandle() const;
         virtual void paintResizeHandles(QPainter& painter);
         virtual void paintRotateHandle(QPainter& painter);
+        virtual QPainterPath shadowPath() const;
+        QRectF shadowRect() const;
+        void paintShadow(QPainter& painter) const;
+        void invalidateShadow();
 
     private:
         void propagateSettings();
+        void cachedShadow(QPainterPath& path, QByteArray& key) const;
 
         Mode _mode;
         QPointF _lastMousePosWithGridMove;
@@ -107,6 +127,15 @@ namespace QSchematic {
         bool _connectorsSnapToGrid;
         QList<std::shared_ptr<Connector>> _connectors;
         QList<std::shared_ptr<Connector>> _specialConnectors;  // Ignored in serialization and deep-copy
+        bool _shadowEnabled;
+        QColor _shadowColor;
+        QPointF _shadowOffset;
+        qreal _shadowBlurRadius;
+        mutable QMutex _shadowMutex;                            // Painting can happen on worker threads
+        mutable QPainterPath _shadowPath;
+        mutable QByteArray _shadowKey;
+        mutable bool _shadowValid;
+        int _connectorRelocationDepth;
     };
 
 }
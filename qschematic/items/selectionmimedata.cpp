@@ -0,0 +1,236 @@
+#include <sstream>
+#include <QHash>
+#ifdef USE_GPDS
+#include <gpds/archiver_xml.hpp>
+#endif
+#include "selectionmimedata.h"
+#include "itemfactory.h"
+#include "item.h"
+#include "node.h"
+#include "connector.h"
+#include "wire.h"
+#include "../scene.h"
+#include "../wire_system/manager.h"
+#include "../wire_system/net.h"
+
+using namespace QSchematic;
+
+SelectionMimeData::SelectionMimeData(const Scene& scene, const std::vector<std::shared_ptr<Item>>& items)
+{
+    auto manager = scene.wire_manager();
+
+    // Split the selection and remember where everything ended up
+    QHash<const wire_system::wire*, int> wireIndices;
+    QVector<std::shared_ptr<Item>> originals;
+    QVector<std::shared_ptr<Wire>> originalWires;
+    for (const auto& item : items) {
+        if (!item) {
+            continue;
+        }
+        if (auto wire = std::dynamic_pointer_cast<Wire>(item)) {
+            wireIndices.insert(wire.get(), originalWires.count());
+            originalWires << wire;
+        } else {
+            originals << item;
+        }
+    }
+
+    SelectionPayload payload;
+    payload.itemCount = originals.count();
+    payload.wireCount = originalWires.count();
+
+    // Items
+    for (int i = 0; i < originals.count(); i++) {
+        const auto& item = originals.at(i);
+
+        // Wires attached to the connectors
+        auto node = std::dynamic_pointer_cast<Node>(item);
+        if (!node) {
+            continue;
+        }
+        const auto& connectors = node->connectors();
+        for (int c = 0; c < connectors.count(); c++) {
+            const auto it = wireIndices.constFind(manager->attached_wire(connectors.at(c).get()));
+            if (it != wireIndices.cend()) {
+                payload.attachments.push_back({ i, c, it.value(), manager->attached_point(connectors.at(c).get()) });
+            }
+        }
+    }
+
+    // Wires
+    QHash<const wire_system::net*, int> netIndices;
+    for (int i = 0; i < originalWires.count(); i++) {
+        const auto& wire = originalWires.at(i);
+
+        // Net
+        const auto& net = wire->net();
+        auto netIt = netIndices.constFind(net.get());
+        if (netIt == netIndices.cend()) {
+            netIt = netIndices.insert(net.get(), payload.nets.count());
+            payload.nets.push_back({ net ? net->name() : QString(), { } });
+        }
+        payload.nets[netIt.value()].wires << i;
+
+        // Wires with a point on this one, the points aren't serialized as junctions
+        for (const auto& connectedWire : wire->connected_wires()) {
+            const auto it = wireIndices.constFind(connectedWire);
+            if (it == wireIndices.cend()) {
+                continue;
+            }
+            const auto& points = connectedWire->points();
+            for (int point = 0; point < points.count(); point++) {
+                if (points.at(point).is_junction() && wire->point_is_on_wire(points.at(point).toPointF())) {
+                    payload.junctions.push_back({ i, it.value(), point });
+                }
+            }
+        }
+    }
+
+    // The items themselves
+#ifdef USE_GPDS
+    gpds::container itemsContainer;
+    for (const auto& item : originals) {
+        itemsContainer.add_value("item", item->to_container());
+    }
+    for (const auto& wire : originalWires) {
+        itemsContainer.add_value("wire", wire->to_container());
+    }
+
+    std::stringstream stream;
+    gpds::archiver_xml ar;
+    ar.save(stream, itemsContainer, "selection");
+    payload.items = QByteArray::fromStdString(stream.str());
+#else
+    _items.reserve(originals.count());
+    for (const auto& item : originals) {
+        _items << item->deepCopy();
+    }
+    _wires.reserve(originalWires.count());
+    for (const auto& wire : originalWires) {
+        _wires << std::static_pointer_cast<Wire>(wire->deepCopy());
+    }
+#endif
+
+    setData(MIME_TYPE_SELECTION, payload.encode());
+}
+
+/**
+ * Creates new items from the payload of the mime data, moved by offset.
+ * Returns false if the payload is missing or invalid.
+ */
+bool SelectionMimeData::selection(const QMimeData& mimeData, Selection& selection, const QPointF& offset)
+{
+    selection = Selection();
+
+    SelectionPayload payload;
+    if (!SelectionPayload::decode(mimeData.data(MIME_TYPE_SELECTION), payload)) {
+        return false;
+    }
+    if (!createItems(mimeData, payload, selection)) {
+        selection = Selection();
+        return false;
+    }
+
+    // The payload only knows the number of items, check the connectors and points
+    for (const Attachment& attachment : payload.attachments) {
+        auto node = std::dynamic_pointer_cast<Node>(selection.items.at(attachment.item));
+        if (!node || attachment.connector < 0 || attachment.connector >= node->connectors().count()) {
+            selection = Selection();
+            return false;
+        }
+        if (attachment.point >= selection.wires.at(attachment.wire)->points_count()) {
+            selection = Selection();
+            return false;
+        }
+    }
+    for (const Junction& junction : payload.junctions) {
+        if (junction.point >= selection.wires.at(junction.connectedWire)->points_count()) {
+            selection = Selection();
+            return false;
+        }
+    }
+
+    // Items
+    for (const auto& item : selection.items) {
+        item->setPos(item->pos() + offset);
+    }
+
+    // Wires
+    for (const auto& wire : selection.wires) {
+        QVector<wire_system::point> points;
+        points.reserve(wire->points_count());
+        for (const auto& point : wire->points()) {
+            points << wire_system::point(point.toPointF() + offset);
+        }
+
+        wire->setPos(wire->pos() + offset);
+        wire->set_points(points);
+    }
+    for (const Junction& junction : payload.junctions) {
+        selection.wires.at(junction.connectedWire)->set_point_is_junction(junction.point, true);
+    }
+
+    selection.nets = payload.nets;
+    selection.attachments = payload.attachments;
+    selection.junctions = payload.junctions;
+
+    return true;
+}
+
+/**
+ * Creates the items and wires described by the payload, in payload order.
+ */
+bool SelectionMimeData::createItems(const QMimeData& mimeData, const SelectionPayload& payload, Selection& selection)
+{
+#ifdef USE_GPDS
+    Q_UNUSED(mimeData)
+
+    gpds::container itemsContainer;
+    std::stringstream stream(payload.items.toStdString());
+    gpds::archiver_xml ar;
+    ar.load(stream, itemsContainer, "selection");
+
+    const auto& itemContainers = itemsContainer.get_values<gpds::container*>("item");
+    const auto& wireContainers = itemsContainer.get_values<gpds::container*>("wire");
+    if (int(itemContainers.size()) != payload.itemCount || int(wireContainers.size()) != payload.wireCount) {
+        return false;
+    }
+
+    selection.items.reserve(payload.itemCount);
+    for (const gpds::container* container : itemContainers) {
+        auto item = container ? ItemFactory::instance().from_container(*container) : nullptr;
+        if (!item) {
+            return false;
+        }
+        item->from_container(*container);
+        selection.items << item;
+    }
+
+    selection.wires.reserve(payload.wireCount);
+    for (const gpds::container* container : wireContainers) {
+        auto wire = container ? std::dynamic_pointer_cast<Wire>(ItemFactory::instance().from_container(*container)) : nullptr;
+        if (!wire) {
+            return false;
+        }
+        wire->from_container(*container);
+        selection.wires << wire;
+    }
+#else
+    // Only the deep copies of this process are available
+    const auto* copied = qobject_cast<const SelectionMimeData*>(&mimeData);
+    if (!copied || copied->_items.count() != payload.itemCount || copied->_wires.count() != payload.wireCount) {
+        return false;
+    }
+
+    selection.items.reserve(copied->_items.count());
+    for (const auto& original : copied->_items) {
+        selection.items << original->deepCopy();
+    }
+    selection.wires.reserve(copied->_wires.count());
+    for (const auto& original : copied->_wires) {
+        selection.wires << std::static_pointer_cast<Wire>(original->deepCopy());
+    }
+#endif
+
+    return true;
+}
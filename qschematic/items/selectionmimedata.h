@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QMimeData>
+#include <QVector>
+#include "qschematic_export.h"
+#include "../utils/selectionpayload.h"
+
+namespace QSchematic
+{
+    class Scene;
+    class Item;
+    class Wire;
+
+    const QString MIME_TYPE_SELECTION = "qschematic/selection";
+
+    /**
+     * A copied selection of items. Besides the items it keeps the nets of the
+     * wires, the wires attached to connectors and the junctions between the
+     * wires so that nothing has to be rediscovered when pasting.
+     *
+     * Everything is stored in one binary payload (MIME_TYPE_SELECTION), the
+     * items are serialized through their to_container() and each paste
+     * creates new items from those bytes. The selection can therefore be
+     * pasted from any QMimeData carrying the payload, eg. the one handed back
+     * by the clipboard of another process. Without GPDS the items can't be
+     * serialized, they are deep copied instead and can only be pasted from
+     * the same SelectionMimeData.
+     */
+    class QSCHEMATIC_EXPORT SelectionMimeData :
+        public QMimeData
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SelectionMimeData)
+
+    public:
+        using Attachment = SelectionPayload::Attachment;
+        using Junction = SelectionPayload::Junction;
+        using Net = SelectionPayload::Net;
+
+        struct Selection
+        {
+            QVector<std::shared_ptr<Item>> items;       // Everything but the wires
+            QVector<std::shared_ptr<Wire>> wires;
+            QVector<Net> nets;
+            QVector<Attachment> attachments;
+            QVector<Junction> junctions;
+        };
+
+        SelectionMimeData(const Scene& scene, const std::vector<std::shared_ptr<Item>>& items);
+        virtual ~SelectionMimeData() override = default;
+
+        static bool selection(const QMimeData& mimeData, Selection& selection, const QPointF& offset);
+
+    private:
+        static bool createItems(const QMimeData& mimeData, const SelectionPayload& payload, Selection& selection);
+
+#ifndef USE_GPDS
+        QVector<std::shared_ptr<Item>> _items;
+        QVector<std::shared_ptr<Wire>> _wires;
+#endif
+    };
+
+}
@@ -191,3 +191,8 @@ QRectF SplineWire::boundingRect() const
 {
     return shape().boundingRect();
 }
+
+bool SplineWire::hasPolylineShape() const
+{
+    return false;
+}
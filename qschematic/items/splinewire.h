@@ -18,5 +18,8 @@ namespace QSchematic
         virtual QPainterPath path() const;
         virtual QPainterPath shape() const override;
         virtual QRectF boundingRect() const override;
+
+    protected:
+        virtual bool hasPolylineShape() const override;
     };
 }
@@ -25,6 +25,44 @@ const QColor COLOR_SELECTED            = QColor("#0f16af");
 
 using namespace QSchematic;
 
+namespace
+{
+
+    /**
+     * Returns whether the path is an axis aligned rectangle as passed by
+     * QGraphicsScene::items(QRectF) and the rubber band selection.
+     */
+    bool pathIsRect(const QPainterPath& path, QRectF& rect)
+    {
+        const int count = path.elementCount();
+        if (count != 4 && count != 5) {
+            return false;
+        }
+
+        QPointF corners[5];
+        for (int i = 0; i < count; i++) {
+            const QPainterPath::Element& element = path.elementAt(i);
+            if (i == 0 ? !element.isMoveTo() : !element.isLineTo()) {
+                return false;
+            }
+            corners[i] = element;
+        }
+        if (count == 5 && corners[4] != corners[0]) {
+            return false;
+        }
+
+        const bool horizontalFirst = corners[0].y() == corners[1].y() && corners[1].x() == corners[2].x() && corners[2].y() == corners[3].y() && corners[3].x() == corners[0].x();
+        const bool verticalFirst = corners[0].x() == corners[1].x() && corners[1].y() == corners[2].y() && corners[2].x() == corners[3].x() && corners[3].y() == corners[0].y();
+        if (!horizontalFirst && !verticalFirst) {
+            return false;
+        }
+
+        rect = QRectF(corners[0], corners[2]).normalized();
+        return true;
+    }
+
+}
+
 class PointWithIndex {
 public:
     PointWithIndex(int index, const QPoint& point) : index(index), point(point) {}
@@ -135,6 +173,25 @@ void Wire::update()
     Item::update();
 }
 
+/**
+ * Sets the color used to present a live value on this wire. An invalid color
+ * restores the default color. Only repaints, the geometry is unaffected.
+ */
+void Wire::setValueColor(const QColor& color)
+{
+    if (_valueColor == color) {
+        return;
+    }
+
+    _valueColor = color;
+    QGraphicsObject::update();
+}
+
+QColor Wire::valueColor() const
+{
+    return _valueColor;
+}
+
 QRectF Wire::boundingRect() const
 {
     return _rect.adjusted(-BOUNDING_RECT_PADDING, -BOUNDING_RECT_PADDING, BOUNDING_RECT_PADDING, BOUNDING_RECT_PADDING);
@@ -155,6 +212,127 @@ QPainterPath Wire::shape() const
     return resultPath;
 }
 
+/**
+ * Hit-tests the point against the same area as shape() (the polyline stroked
+ * with a width of WIRE_SHAPE_PADDING and flat caps) without creating the path.
+ */
+bool Wire::contains(const QPointF& point) const
+{
+    if (!hasPolylineShape()) {
+        return Item::contains(point);
+    }
+    if (!acceptsHitTest()) {
+        return false;
+    }
+
+    const QVector<QPointF>& points = pointsRelative();
+    const qreal tolerance = WIRE_SHAPE_PADDING / 2;
+    for (int i = 0; i < points.count() - 1; i++) {
+        const QPointF& p1 = points.at(i);
+        const QPointF& p2 = points.at(i + 1);
+
+        // The caps are flat, the shape doesn't extend beyond the ends of the wire
+        const QPointF direction = p2 - p1;
+        if (i == 0 && QPointF::dotProduct(point - p1, direction) < 0) {
+            continue;
+        }
+        if (i == points.count() - 2 && QPointF::dotProduct(point - p2, direction) > 0) {
+            continue;
+        }
+
+        if (Utils::distanceToLineSquared(QLineF(p1, p2), point) <= tolerance * tolerance) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Wires are tested against each other segment by segment, everything else goes
+ * through collidesWithPath().
+ */
+bool Wire::collidesWithItem(const QGraphicsItem* other, Qt::ItemSelectionMode mode) const
+{
+    const auto* otherWire = dynamic_cast<const Wire*>(other);
+    if (!otherWire || otherWire == this || mode != Qt::IntersectsItemShape || !hasPolylineShape() || !otherWire->hasPolylineShape()) {
+        return Item::collidesWithItem(other, mode);
+    }
+
+    if (!acceptsHitTest()) {
+        return false;
+    }
+    if (!boundingRect().intersects(mapRectFromItem(other, other->boundingRect()))) {
+        return false;
+    }
+
+    const QVector<QPointF>& points = pointsRelative();
+    QVector<QPointF> otherPoints;
+    otherPoints.reserve(otherWire->points_count());
+    for (const QPointF& otherPoint : otherWire->pointsRelative()) {
+        otherPoints << mapFromItem(other, otherPoint);
+    }
+
+    // Both shapes extend by half the padding
+    const qreal tolerance = WIRE_SHAPE_PADDING;
+    for (int i = 0; i < points.count() - 1; i++) {
+        const QLineF segment(points.at(i), points.at(i + 1));
+        for (int j = 0; j < otherPoints.count() - 1; j++) {
+            if (Utils::distanceBetweenLinesSquared(segment, QLineF(otherPoints.at(j), otherPoints.at(j + 1))) <= tolerance * tolerance) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Rectangles (eg. rubber band selection) are tested analytically, other paths
+ * are tested against shape().
+ */
+bool Wire::collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode) const
+{
+    QRectF rect;
+    if ((mode != Qt::IntersectsItemShape && mode != Qt::ContainsItemShape) || !hasPolylineShape() || !pathIsRect(path, rect)) {
+        return Item::collidesWithPath(path, mode);
+    }
+
+    if (!acceptsHitTest()) {
+        return false;
+    }
+
+    // The shape of a wire without segments is empty
+    const QVector<QPointF>& points = pointsRelative();
+    if (points.count() < 2) {
+        return false;
+    }
+
+    const qreal tolerance = WIRE_SHAPE_PADDING / 2;
+    if (mode == Qt::ContainsItemShape) {
+        return rect.contains(_rect.adjusted(-tolerance, -tolerance, tolerance, tolerance));
+    }
+
+    const QRectF& grownRect = rect.adjusted(-tolerance, -tolerance, tolerance, tolerance);
+    for (int i = 0; i < points.count() - 1; i++) {
+        if (Utils::lineIntersectsRect(QLineF(points.at(i), points.at(i + 1)), grownRect)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Returns whether shape() is the stroked polyline. The analytic hit-tests rely
+ * on this, subclasses with a different shape (eg. curves) return false to fall
+ * back to testing against shape().
+ */
+bool Wire::hasPolylineShape() const
+{
+    return true;
+}
+
 QVector<point> Wire::wirePointsRelative() const
 {
     QVector<point> relativePoints(m_points);
@@ -468,6 +646,8 @@ void Wire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
+    const qreal opacity = painter->opacity();
+
     QPen penLine;
     penLine.setStyle(Qt::SolidLine);
     penLine.setCapStyle(Qt::RoundCap);
@@ -476,6 +656,8 @@ void Wire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
         penColor = COLOR_SELECTED;
     } else if (isHighlighted()) {
         penColor = COLOR_HIGHLIGHTED;
+    } else if (_valueColor.isValid()) {
+        penColor = _valueColor;
     } else {
         penColor = COLOR;
     }
@@ -490,7 +672,7 @@ void Wire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
 
     QBrush brushJunction;
     brushJunction.setStyle(Qt::SolidPattern);
-    brushJunction.setColor(isHighlighted() ? COLOR_HIGHLIGHTED : COLOR);
+    brushJunction.setColor(isHighlighted() ? COLOR_HIGHLIGHTED : (_valueColor.isValid() ? _valueColor : COLOR));
 
     QPen penHandle;
     penHandle.setColor(Qt::black);
@@ -506,19 +688,24 @@ void Wire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     const auto& points = pointsRelative();
     painter->drawPolyline(points.constData(), points.count());
 
-    // Draw the junction poins
+    // Draw the junction poins (squares are a lot cheaper while interacting)
     int junctionRadius = 4;
+    const bool simpleJunctions = reducedQuality();
     for (const point& wirePoint : wirePointsRelative()) {
         if (wirePoint.is_junction()) {
             painter->setPen(penJunction);
             painter->setBrush(brushJunction);
-            painter->drawEllipse(wirePoint.toPointF(), junctionRadius, junctionRadius);
+            if (simpleJunctions) {
+                painter->drawRect(QRectF(wirePoint.x() - junctionRadius, wirePoint.y() - junctionRadius, 2*junctionRadius, 2*junctionRadius));
+            } else {
+                painter->drawEllipse(wirePoint.toPointF(), junctionRadius, junctionRadius);
+            }
         }
     }
 
     // Draw the handles (if selected)
     if (isSelected()) {
-        painter->setOpacity(0.5);
+        painter->setOpacity(opacity * 0.5);
         painter->setPen(penHandle);
         painter->setBrush(brushHandle);
         for (const QPointF& point : points) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAction>
+#include <QColor>
 
 #include "wire_system/point.h"
 #include "wire_system/wire.h"
@@ -34,6 +35,9 @@ namespace QSchematic {
         virtual std::shared_ptr<Item> deepCopy() const override;
         virtual QRectF boundingRect() const override;
         virtual QPainterPath shape() const override;
+        virtual bool contains(const QPointF& point) const override;
+        virtual bool collidesWithItem(const QGraphicsItem* other, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
+        virtual bool collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
 
         void prepend_point(const QPointF& point) override;
         void append_point(const QPointF& point) override;
@@ -46,6 +50,8 @@ namespace QSchematic {
         void move_point_to(int index, const QPointF& moveTo) override;
         bool movingWirePoint() const;
         void rename_net();
+        void setValueColor(const QColor& color);
+        QColor valueColor() const;
 
     signals:
         void pointMoved(Wire& wire, point& point);
@@ -55,6 +61,7 @@ namespace QSchematic {
         void copyAttributes(Wire& dest) const;
         void calculateBoundingRect();
         void setRenameAction(QAction* action);
+        virtual bool hasPolylineShape() const;
 
         virtual void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
         virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
@@ -81,6 +88,7 @@ namespace QSchematic {
         QPointF _prevMousePos;
         QPointF _offset;
         QAction* _renameAction;
+        QColor _valueColor;
     };
 
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <utils.h>
 #include <QVector2D>
 #include "connector.h"
@@ -107,12 +108,15 @@ bool WireNet::addWire(const std::shared_ptr<wire>& wire)
         connect(wire_net.get(), &Wire::pointMoved, this, &WireNet::wirePointMoved);
         connect(wire_net.get(), &Wire::highlightChanged, this, &WireNet::wireHighlightChanged);
         connect(wire_net.get(), &Wire::toggleLabelRequested, this, &WireNet::toggleLabel);
-        connect(wire_net.get(), &Wire::moved, this, [=] { updateLabelPos(); });
+        const wire_system::wire* rawWire = wire.get();
+        connect(wire_net.get(), &Wire::moved, this, [this, rawWire] { wireChanged(rawWire); });
     }
 
 
     updateLabelPos(true);
 
+    emit wireAdded(wire.get());
+
     return true;
 }
 
@@ -120,10 +124,19 @@ bool WireNet::removeWire(const std::shared_ptr<wire> wire)
 {
     if (auto wire_net = std::dynamic_pointer_cast<Wire>(wire)) {
         disconnect(wire_net.get(), nullptr, this, nullptr);
+
+        // The value presented on this net doesn't apply anymore. A net the wire
+        // joins restyles it if it has a value (see ValueOverlay).
+        wire_net->setValueColor(QColor());
     }
     net::removeWire(wire);
+    if (_labelAnchor.wire == wire.get()) {
+        _labelAnchor = LabelAnchor();
+    }
     updateLabelPos(true);
 
+    emit wireRemoved(wire.get());
+
     return true;
 }
 
@@ -136,11 +149,16 @@ void WireNet::simplify()
 
 void WireNet::set_name(const QString& name)
 {
+    const bool changed = (name != this->name());
     net::set_name(name);
 
     _label->setText(this->name());
     _label->setVisible(!this->name().isEmpty());
     updateLabelPos(true);
+
+    if (changed) {
+        emit nameChanged();
+    }
 }
 
 void WireNet::setHighlighted(bool highlighted)
@@ -241,11 +259,50 @@ std::shared_ptr<Label> WireNet::label()
 
 void WireNet::wirePointMoved(Wire& wire, const point& point)
 {
-    updateLabelPos();
+    Q_UNUSED(point)
+
+    wireChanged(&wire);
+}
+
+/**
+ * Keeps the label attached to its anchor. Changes to other wires don't affect
+ * the anchor and are ignored.
+ */
+void WireNet::wireChanged(const wire* wire)
+{
+    if (!_labelAnchor.wire || _labelAnchor.wire == wire) {
+        updateLabelAnchor();
+    }
+}
+
+/**
+ * Moves the connection point of the label along with the segment it is anchored
+ * to. Only if that segment is gone the closest segment is searched again.
+ */
+void WireNet::updateLabelAnchor() const
+{
+    // Ignore if the label is not visible
+    if (!_label->isVisible()) {
+        return;
+    }
+
+    const auto* wire = _labelAnchor.wire;
+    if (!wire || wire->points_count() - 1 != _labelAnchor.segmentCount || _labelAnchor.segment >= _labelAnchor.segmentCount) {
+        updateLabelPos();
+        return;
+    }
+
+    const auto& points = wire->points();
+    const QPointF& p1 = points.at(_labelAnchor.segment).toPointF();
+    const QPointF& p2 = points.at(_labelAnchor.segment + 1).toPointF();
+    setLabelConnectionPoint(p1 + (p2 - p1) * _labelAnchor.parameter);
 }
 
 /**
  * Update the label's connection point and its parent if updateParent is true.
+ * This searches the whole net for the segment closest to the label, wires
+ * whose bounding rect is further away than the closest segment found so far
+ * are skipped.
  */
 void WireNet::updateLabelPos(bool updateParent) const
 {
@@ -253,39 +310,78 @@ void WireNet::updateLabelPos(bool updateParent) const
     if (!_label->isVisible()) {
         return;
     }
+
+    // Visit the wires closest to the label first so that the others can be pruned
+    const QPointF labelPos = _label->textRect().center() + _label->scenePos();
+    auto rectDistance = [&labelPos](const QRectF& rect) {
+        const qreal dx = std::max({ rect.left() - labelPos.x(), qreal(0), labelPos.x() - rect.right() });
+        const qreal dy = std::max({ rect.top() - labelPos.y(), qreal(0), labelPos.y() - rect.bottom() });
+        return dx * dx + dy * dy;
+    };
+    QVector<QPair<qreal, std::shared_ptr<Wire>>> candidates;
+    for (const auto& wire : wires()) {
+        if (auto wireItem = std::dynamic_pointer_cast<Wire>(wire)) {
+            candidates.append({ rectDistance(wireItem->sceneBoundingRect()), wireItem });
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
     // Find closest point
-    QPointF labelPos = _label->textRect().center() + _label->scenePos();
     QPointF closestPoint;
-    std::shared_ptr<wire> closestWire;
-    for (const auto& wire : wires()) {
-        for (const auto& segment: wire->line_segments()) {
+    qreal closestDistance = 0;
+    std::shared_ptr<Wire> closestWire;
+    LabelAnchor anchor;
+    for (const auto& candidate : candidates) {
+        if (closestWire && candidate.first > closestDistance) {
+            break;
+        }
+
+        const auto& points = candidate.second->points();
+        for (int i = 0; i < points.count() - 1; i++) {
             // Find closest point on segment
-            QPointF p = Utils::pointOnLineClosestToPoint(segment.p1(), segment.p2(), labelPos);
-            float distance1 = QVector2D(labelPos - closestPoint).lengthSquared();
-            float distance2 = QVector2D(labelPos - p).lengthSquared();
-            if (closestPoint.isNull() || distance1 > distance2) {
+            const QPointF p1 = points.at(i).toPointF();
+            const QPointF p2 = points.at(i + 1).toPointF();
+            const QPointF p = Utils::pointOnLineClosestToPoint(p1, p2, labelPos);
+            const qreal distance = QVector2D(labelPos - p).lengthSquared();
+            if (!closestWire || distance < closestDistance) {
                 closestPoint = p;
-                closestWire = wire;
+                closestDistance = distance;
+                closestWire = candidate.second;
+
+                const QVector2D direction(p2 - p1);
+                anchor.wire = closestWire.get();
+                anchor.segment = i;
+                anchor.parameter = direction.isNull() ? 0 : QVector2D::dotProduct(QVector2D(p - p1), direction) / direction.lengthSquared();
+                anchor.segmentCount = points.count() - 1;
             }
         }
     }
     // If there are no wires left in the net it will be hidden anyway
     if (!closestWire) {
+        _labelAnchor = LabelAnchor();
         return;
     }
+    _labelAnchor = anchor;
+
     // Update the parent if requested
-    auto closestWireItem = std::dynamic_pointer_cast<Wire>(closestWire);
-    if (updateParent && _label->parentItem() != closestWireItem.get()) {
-        _label->setParentItem(closestWireItem.get());
-        _label->setPos(labelPos - _label->textRect().center() - closestWireItem->scenePos());
+    if (updateParent && _label->parentItem() != closestWire.get()) {
+        _label->setParentItem(closestWire.get());
+        _label->setPos(labelPos - _label->textRect().center() - closestWire->scenePos());
     }
+
     // Update the connection point
+    setLabelConnectionPoint(closestPoint);
+}
+
+void WireNet::setLabelConnectionPoint(const QPointF& point) const
+{
     if (_label->parentItem()) {
-        _label->setConnectionPoint(closestPoint - _label->parentItem()->pos());
+        _label->setConnectionPoint(point - _label->parentItem()->pos());
     } else {
-        _label->setConnectionPoint(closestPoint);
+        _label->setConnectionPoint(point);
     }
-
 }
 
 void WireNet::labelHighlightChanged(const Item& item, bool highlighted)
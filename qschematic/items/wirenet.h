@@ -50,6 +50,7 @@ namespace QSchematic {
         void setHighlighted(bool highlighted);
         void setScene(Scene* scene);
         void updateLabelPos(bool updateParent = false) const;
+        void updateLabelAnchor() const;
         void wirePointMoved(Wire& wire, const point& point);
 
         QList<line> lineSegments() const;
@@ -59,6 +60,9 @@ namespace QSchematic {
     signals:
         void highlightChanged(bool highlighted);
         void contextMenuRequested(const QPoint& pos);
+        void nameChanged();
+        void wireAdded(const wire_system::wire* wire);
+        void wireRemoved(const wire_system::wire* wire);
 
     private slots:
         void labelHighlightChanged(const Item& item, bool highlighted);
@@ -66,11 +70,26 @@ namespace QSchematic {
         void toggleLabel();
 
     private:
+        /**
+         * Where the label is connected to the net: a position along a segment
+         * of a wire. segmentCount detects points being added or removed.
+         */
+        struct LabelAnchor
+        {
+            const wire_system::wire* wire = nullptr;
+            int segment = -1;
+            qreal parameter = 0;
+            int segmentCount = 0;
+        };
+
         QList<std::shared_ptr<WireNet>> nets() const;
         void highlight_global_net(bool highlighted);
+        void wireChanged(const wire* wire);
+        void setLabelConnectionPoint(const QPointF& point) const;
 
         std::shared_ptr<Label> _label;
         Scene* _scene{};
+        mutable LabelAnchor _labelAnchor;
     };
 
 }
@@ -0,0 +1,80 @@
+#include <QtGlobal>
+#include "layer.h"
+
+using namespace QSchematic;
+
+bool Layer::State::operator==(const State& other) const
+{
+    return visible == other.visible && locked == other.locked && qFuzzyCompare(opacity, other.opacity);
+}
+
+bool Layer::State::operator!=(const State& other) const
+{
+    return !(*this == other);
+}
+
+Layer::Layer(const QString& name) :
+    _name(name)
+{
+}
+
+#ifdef USE_GPDS
+gpds::container Layer::to_container() const
+{
+    gpds::container root;
+    root.add_value("name", _name.toStdString());
+    root.add_value("visible", _state.visible);
+    root.add_value("locked", _state.locked);
+    root.add_value("opacity", _state.opacity);
+
+    return root;
+}
+
+void Layer::from_container(const gpds::container& container)
+{
+    _name = QString::fromStdString(container.get_value<std::string>("name").value_or(""));
+    _state.visible = container.get_value<bool>("visible").value_or(true);
+    _state.locked = container.get_value<bool>("locked").value_or(false);
+    _state.opacity = container.get_value<double>("opacity").value_or(1.0);
+}
+#endif
+
+QString Layer::name() const
+{
+    return _name;
+}
+
+/**
+ * Changes the flags of the layer. This doesn't trigger a repaint, use
+ * Scene::setLayerState() to get an undoable change including the repaint.
+ */
+void Layer::setState(const State& state)
+{
+    _state = state;
+    _state.opacity = qBound(0.0, _state.opacity, 1.0);
+}
+
+const Layer::State& Layer::state() const
+{
+    return _state;
+}
+
+bool Layer::isVisible() const
+{
+    return _state.visible;
+}
+
+bool Layer::isLocked() const
+{
+    return _state.locked;
+}
+
+qreal Layer::opacity() const
+{
+    return _state.opacity;
+}
+
+bool Layer::isHitTestable() const
+{
+    return _state.visible && !_state.locked;
+}
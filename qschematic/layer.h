@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QString>
+#ifdef USE_GPDS
+#include <gpds/container.hpp>
+#endif
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    /**
+     * A named group of items sharing visibility, lockedness and opacity. The
+     * scene applies the visibility and opacity to the member items (see
+     * Item::applyLayer()), the lockedness is consulted when hit-testing.
+     * Items become members either explicitly (Item::setLayer()) or by their
+     * type (Scene::setLayerForType()).
+     */
+    class QSCHEMATIC_EXPORT Layer
+    {
+    public:
+        struct State
+        {
+            bool visible = true;
+            bool locked = false;        // Excluded from hit-testing and selection
+            qreal opacity = 1.0;
+
+            bool operator==(const State& other) const;
+            bool operator!=(const State& other) const;
+        };
+
+        explicit Layer(const QString& name);
+        Layer(const Layer& other) = delete;
+        Layer(Layer&& other) = delete;
+        virtual ~Layer() = default;
+
+        Layer& operator=(const Layer& rhs) = delete;
+        Layer& operator=(Layer&& rhs) = delete;
+
+#ifdef USE_GPDS
+        gpds::container to_container() const;
+        void from_container(const gpds::container& container);
+#endif
+
+        QString name() const;
+        void setState(const State& state);
+        const State& state() const;
+        bool isVisible() const;
+        bool isLocked() const;
+        qreal opacity() const;
+        bool isHitTestable() const;
+
+    private:
+        QString _name;
+        State _state;
+    };
+
+}
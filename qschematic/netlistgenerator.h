@@ -1,9 +1,22 @@
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <QLineF>
+#include <QRectF>
+#include <QSet>
 #include "netlist.h"
 #include "scene.h"
+#include "sceneextents.h"
+#include "utils.h"
 #include "items/wirenet.h"
+#include "items/wire.h"
 #include "items/node.h"
+#include "items/connector.h"
+#include "items/label.h"
+#include "items/buswire.h"
+#include "items/busripper.h"
+#include "utils/netlistcore.h"
 #include "qschematic_export.h"
 
 namespace QSchematic
@@ -19,127 +32,204 @@ namespace QSchematic
         template<typename TNode = Node*, typename TConnector = Connector*, typename TWire = Wire*, typename TNet = Net<TWire, TNode, TConnector>>
         static bool generate(Netlist<TNode, TConnector, TWire, TNet>& netlist, const Scene& scene)
         {
-            struct GlobalNet
-            {
-                QString name;
-                QList<std::shared_ptr<WireNet>> wireNets;
-            };
-
-            // Add all nodes
+            // Add all nodes. Bus rippers only join nets, they aren't components.
             std::vector<TNode> nodes;
             for ( const auto& node : scene.nodes() ) {
                 // Sanity check
-                if ( !node ) {
+                if ( !node || isBusRipper(node.get()) ) {
                     continue;
                 }
 
                 nodes.push_back( static_cast<TNode>( node.get() ) );
             }
 
-            // Create a list of global nets (WireNets that share the same net name)
-            std::vector<GlobalNet> globalNets;
-            unsigned anonNetCounter = 0;
-            for (const auto& net : scene.wire_manager()->nets()) {
+            // Export nets
+            const auto& globalNets = NetlistCore::generate(*scene.wire_manager(), buses(scene));
+            std::vector<TNet> nets = exportNets<TNode, TConnector, TWire, TNet>(globalNets, [](Node*) { });
 
-                auto wireNet = std::dynamic_pointer_cast<WireNet>(net);
+            // Set the netlist
+            netlist.set( std::move( nodes ), std::move( nets ) );
 
-                // Sanity check
-                if (!wireNet) {
+            return true;
+        }
+
+        /**
+         * Generates only the nets connected to the given nodes. Connectivity is
+         * followed outwards from their connectors so the cost depends on the
+         * size of those nets rather than on the size of the scene. Named nets
+         * (and ripped bus members) include every wire net sharing the name,
+         * these are found through the name index of the wire manager and the
+         * bus ripper index of the scene.
+         *
+         * The nodes of the netlist are the given ones plus the ones reached
+         * through the nets. Unnamed nets are numbered within the result only.
+         */
+        template<typename TNode = Node*, typename TConnector = Connector*, typename TWire = Wire*, typename TNet = Net<TWire, TNode, TConnector>>
+        static bool generate(Netlist<TNode, TConnector, TWire, TNet>& netlist, const Scene& scene, const QList<std::shared_ptr<Node>>& nodes)
+        {
+            std::vector<const Node*> scopeNodes;
+            QVector<const wire_system::net*> seeds;
+            for (const auto& node : nodes) {
+                if (!node) {
                     continue;
                 }
-
-                // Figure out whether we need a new global net
-                bool createNewNet = true;
-                for (auto& globalNet : globalNets) {
-                    if (wireNet->name().isEmpty()) {
-                        createNewNet = true;
-                        break;
-                    }
-                    if (QString::compare(globalNet.name, wireNet->name()) == 0) {
-                        globalNet.wireNets.append(wireNet);
-                        createNewNet = false;
-                        break;
+                scopeNodes.push_back(node.get());
+                for (const auto& connector : node->connectors()) {
+                    if (auto* wire = scene.wire_manager()->attached_wire(connector.get())) {
+                        seeds.append(wire->net().get());
                     }
                 }
+            }
 
-                // Create a new net if supposed to
-                if (createNewNet) {
-                    GlobalNet newGlobalNet;
-                    newGlobalNet.wireNets.append(wireNet);
-                    newGlobalNet.name = wireNet->name();
+            return generateScoped(netlist, scene, scopeNodes, seeds);
+        }
 
-                    // Prevent empty names
-                    if (newGlobalNet.name.isEmpty()) {
-                        newGlobalNet.name = QString("N%1").arg(anonNetCounter++, 3, 10, QChar('0'));
+        /**
+         * Generates only the nets intersecting the rectangle (in scene
+         * coordinates), either with a segment of one of their wires or through
+         * a node. See the overload taking nodes for details.
+         */
+        template<typename TNode = Node*, typename TConnector = Connector*, typename TWire = Wire*, typename TNet = Net<TWire, TNode, TConnector>>
+        static bool generate(Netlist<TNode, TConnector, TWire, TNet>& netlist, const Scene& scene, const QRectF& rect)
+        {
+            std::vector<const Node*> scopeNodes;
+            QVector<const wire_system::net*> seeds;
+
+            // The extents index only returns what is in the rectangle
+            for (Item* item : scene.sceneExtents()->items(rect)) {
+                if (auto* node = dynamic_cast<Node*>(item)) {
+                    scopeNodes.push_back(node);
+                    for (const auto& connector : node->connectors()) {
+                        if (auto* wire = scene.wire_manager()->attached_wire(connector.get())) {
+                            seeds.append(wire->net().get());
+                        }
+                    }
+                } else if (auto* wire = dynamic_cast<Wire*>(item)) {
+                    // The extents are bounding rects, check the segments themselves
+                    const auto& points = wire->pointsAbsolute();
+                    for (int i = 1; i < points.count(); i++) {
+                        if (Utils::lineIntersectsRect(QLineF(points.at(i-1), points.at(i)), rect)) {
+                            seeds.append(wire->net().get());
+                            break;
+                        }
                     }
+                }
+            }
 
-                    globalNets.push_back(newGlobalNet);
+            return generateScoped(netlist, scene, scopeNodes, seeds);
+        }
+
+    private:
+        template<typename TNode, typename TConnector, typename TWire, typename TNet>
+        static bool generateScoped(Netlist<TNode, TConnector, TWire, TNet>& netlist, const Scene& scene, const std::vector<const Node*>& scopeNodes, const QVector<const wire_system::net*>& seeds)
+        {
+            std::vector<TNode> nodes;
+            QSet<const Node*> knownNodes;
+            auto addNode = [&nodes, &knownNodes](const Node* node) {
+                if (!knownNodes.contains(node) && !isBusRipper(node)) {
+                    knownNodes.insert(node);
+                    nodes.push_back(static_cast<TNode>(const_cast<Node*>(node)));
                 }
+            };
+            for (const auto* node : scopeNodes) {
+                addNode(node);
             }
 
             // Export nets
+            const auto& globalNets = NetlistCore::generate(*scene.wire_manager(), buses(scene), seeds);
+            std::vector<TNet> nets = exportNets<TNode, TConnector, TWire, TNet>(globalNets, addNode);
+
+            netlist.set(std::move(nodes), std::move(nets));
+
+            return true;
+        }
+
+        // Maps the wires and connectors of the global nets back onto the items
+        template<typename TNode, typename TConnector, typename TWire, typename TNet>
+        static std::vector<TNet> exportNets(const QVector<NetlistCore::GlobalNet>& globalNets, const std::function<void(Node*)>& addNode)
+        {
             std::vector<TNet> nets;
+            nets.reserve(globalNets.count());
             for (const auto& globalNet : globalNets) {
-                // Create the new Net
                 TNet net;
                 net.name = globalNet.name;
 
-                // Build a list of all wire net points in scene coordinates
-                QList<QPointF> wireScenePoints;
-                for (const auto& wireNet : globalNet.wireNets) {
-                    wireScenePoints << wireNet->points();
-
-                    // Store wires
-                    for ( const auto& wire : wireNet->wires()) {
-                        TWire w = qobject_cast<TWire>( std::dynamic_pointer_cast<Wire>(wire).get() );
-                        if ( w ) {
-                            net.wires.push_back( w );
-                        }
+                // Store wires
+                for (const auto* wire : globalNet.wires) {
+                    TWire w = qobject_cast<TWire>(const_cast<Wire*>(dynamic_cast<const Wire*>(wire)));
+                    if (w) {
+                        net.wires.push_back(w);
                     }
                 }
 
-                // Build a list of all connectors
-                for (auto& node : scene.nodes()) {
-                    // Convert to template node type
-                    TNode templateNode = qgraphicsitem_cast<TNode>(node.get());
-                    if (!templateNode) {
+                // Create the Connector/Node pairs
+                for (const auto* connectable : globalNet.connectors) {
+                    auto* connector = const_cast<Connector*>(dynamic_cast<const Connector*>(connectable));
+                    auto* node = connector ? dynamic_cast<Node*>(connector->parentItem()) : nullptr;
+                    if (!node) {
+                        continue;
+                    }
+                    TNode templateNode = qgraphicsitem_cast<TNode>(node);
+                    TConnector templateConnector = qgraphicsitem_cast<TConnector>(connector);
+                    if (!templateNode || !templateConnector) {
                         continue;
                     }
 
-                    // Loop through all Node's connectors
-                    for (auto& connector : node->connectors()) {
-                        // Convert to template connector type
-                        TConnector templateConnector = qgraphicsitem_cast<TConnector>(connector.get());
-                        if (!templateConnector) {
-                            continue;
-                        }
+                    addNode(node);
+                    net.nodes.push_back(templateNode);
+                    net.connectors.push_back(templateConnector);
+                    net.connectorNodePairs.emplace(std::pair<TConnector, TNode>(templateConnector, templateNode));
+                }
 
-                        // Create the Connector/Node pairs
-                        const auto* wire = scene.wire_manager()->attached_wire(connector.get());
-                        if (std::find(net.wires.begin(), net.wires.end(), wire) != net.wires.end()) {
+                nets.push_back(net);
+            }
 
-                            // Create list of all nodes in this net
-                            net.nodes.push_back(templateNode);
+            return nets;
+        }
 
-                            // Create a list of all connectors in this net
-                            net.connectors.push_back(templateConnector);
+        // Bus rippers are pseudo-nodes, they are neither components nor pins
+        static bool isBusRipper(const Node* node)
+        {
+            return dynamic_cast<const BusRipper*>(node) != nullptr;
+        }
 
-                            // Connector/Node pairs
-                            net.connectorNodePairs.emplace(std::pair<TConnector, TNode>(templateConnector, templateNode));
-                        }
+        // Describes the bus wires & rippers of the scene to the netlist core
+        static NetlistCore::Buses buses(const Scene& scene)
+        {
+            NetlistCore::Buses buses;
+            buses.isBus = [](const wire_system::wire& wire) {
+                return dynamic_cast<const BusWire*>(&wire) != nullptr;
+            };
+            buses.ripper = [](const wire_system::connectable& connectable) -> std::optional<NetlistCore::Ripper> {
+                const auto* connector = dynamic_cast<const Connector*>(&connectable);
+                const auto* ripper = connector ? dynamic_cast<const BusRipper*>(connector->parentItem()) : nullptr;
+                if (!ripper) {
+                    return std::nullopt;
+                }
+                return NetlistCore::Ripper { connector, ripper->member(), ripper->tapPoint() };
+            };
+            buses.rippersOf = [&scene](const QString& member) {
+                QVector<NetlistCore::Ripper> rippers;
+                for (const auto& ripper : scene.busRippers(member)) {
+                    if (ripper->connector()) {
+                        rippers.append({ ripper->connector().get(), ripper->member(), ripper->tapPoint() });
                     }
                 }
+                return rippers;
+            };
+            buses.busesAt = [&scene](const QPointF& point) {
+                QVector<wire_system::wire*> busWires;
+                for (Item* item : scene.sceneExtents()->items(QRectF(point - QPointF(1, 1), QSizeF(2, 2)))) {
+                    if (auto* busWire = dynamic_cast<BusWire*>(item)) {
+                        busWires.append(busWire);
+                    }
+                }
+                return busWires;
+            };
 
-                nets.push_back( net );
-            }
-
-            // Set the netlist
-            netlist.set( std::move( nodes ), std::move( nets ) );
-
-            return true;
+            return buses;
         }
 
-    private:
         NetlistGenerator() = default;
         NetlistGenerator(const NetlistGenerator& other) = default;
         NetlistGenerator(NetlistGenerator&& other) = default;
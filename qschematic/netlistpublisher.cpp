@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <QUndoStack>
+#include "netlistpublisher.h"
+#include "netlist.h"
+#include "netlistgenerator.h"
+#include "scene.h"
+#include "items/node.h"
+#include "items/connector.h"
+#include "items/wire.h"
+#include "items/blockinstance.h"
+#include "utils/netlistsnapshot.h"
+
+#if !defined(__unix__) && !defined(__APPLE__)
+namespace QSchematic
+{
+    class NetlistSnapshotSegment
+    {
+    };
+}
+#endif
+
+using namespace QSchematic;
+
+const std::size_t INITIAL_CAPACITY = 64 * 1024;
+
+NetlistPublisher::NetlistPublisher(Scene* scene, const QString& name, QObject* parent) :
+    QObject(parent),
+    _scene(scene),
+    _name(name),
+    _segment(std::make_unique<NetlistSnapshotSegment>()),
+    _nextId(1),
+    _publishQueued(false)
+{
+    Q_ASSERT(scene);
+
+#if defined(__unix__) || defined(__APPLE__)
+    if (!_segment->create(_name.toStdString(), INITIAL_CAPACITY)) {
+        qWarning("NetlistPublisher: Could not create the shared memory segment \"%s\".", qPrintable(_name));
+    }
+#endif
+
+    connect(scene, &Scene::itemAdded, this, &NetlistPublisher::itemAdded);
+    connect(scene, &Scene::itemRemoved, this, &NetlistPublisher::itemRemoved);
+    connect(scene->undoStack(), &QUndoStack::indexChanged, this, &NetlistPublisher::publish);
+
+    publish();
+}
+
+NetlistPublisher::~NetlistPublisher() = default;
+
+/**
+ * Returns the name of the shared memory segment
+ */
+QString NetlistPublisher::name() const
+{
+    return _name;
+}
+
+bool NetlistPublisher::isOpen() const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return _segment->isOpen();
+#else
+    return false;
+#endif
+}
+
+/**
+ * Returns the sequence of the last published snapshot
+ */
+quint64 NetlistPublisher::sequence() const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return _segment->sequence();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Generates the netlist and publishes it. Readers that are still busy with
+ * the previous snapshot are not disturbed as it lives in the other buffer.
+ */
+void NetlistPublisher::publish()
+{
+    _publishQueued = false;
+
+#if defined(__unix__) || defined(__APPLE__)
+    if (!_scene || !_segment->isOpen()) {
+        return;
+    }
+
+    Netlist<> netlist;
+    NetlistGenerator::generate(netlist, *_scene);
+
+    NetlistSnapshotBuilder builder;
+    QHash<const Connector*, quint32> connectorIndices;
+    for (const Node* node : netlist.nodes()) {
+        builder.addNode(id(node), nodeName(*node).toStdString());
+        for (const auto& connector : node->connectors()) {
+            connectorIndices.insert(connector.get(), builder.addConnector(id(connector.get()), connectorName(*connector).toStdString()));
+        }
+    }
+    const auto& nets = netlist.nets();
+    for (std::size_t i = 0; i < nets.size(); i++) {
+        std::vector<std::uint32_t> connectors;
+        connectors.reserve(nets[i].connectors.size());
+        for (const Connector* connector : nets[i].connectors) {
+            connectors.push_back(connectorIndices.value(connector, NETLIST_SNAPSHOT_NONE));
+        }
+        builder.addNet(netId(nets[i].name, nets[i].wires, nets[i].connectors), nets[i].name.toStdString(), connectors);
+    }
+    const std::vector<char> snapshot = builder.data();
+
+    // Outgrown: Readers notice that the segment was retired and open the new one
+    if (snapshot.size() > _segment->capacity()) {
+        std::size_t capacity = _segment->capacity();
+        while (capacity < snapshot.size() * 2) {
+            capacity *= 2;
+        }
+        const std::uint64_t sequence = _segment->sequence();
+        _segment = std::make_unique<NetlistSnapshotSegment>();
+        if (!_segment->create(_name.toStdString(), capacity, sequence)) {
+            qWarning("NetlistPublisher: Could not create the shared memory segment \"%s\".", qPrintable(_name));
+            return;
+        }
+    }
+
+    if (_segment->publish(snapshot)) {
+        emit published(_segment->sequence());
+    }
+#endif
+}
+
+/**
+ * Returns the name of a node. The default implementation returns the instance
+ * name of block instances and an empty string otherwise.
+ */
+QString NetlistPublisher::nodeName(const Node& node) const
+{
+    if (auto blockInstance = qobject_cast<const BlockInstance*>(&node)) {
+        return blockInstance->instanceName();
+    }
+
+    return { };
+}
+
+/**
+ * Returns the name of a connector. The default implementation returns its text.
+ */
+QString NetlistPublisher::connectorName(const Connector& connector) const
+{
+    return connector.text();
+}
+
+void NetlistPublisher::itemAdded(const std::shared_ptr<const Item>& item)
+{
+    Q_UNUSED(item)
+
+    schedule();
+}
+
+void NetlistPublisher::itemRemoved(const std::shared_ptr<const Item>& item)
+{
+    // The address may be reused by a new item
+    _ids.remove(item.get());
+    if (auto node = std::dynamic_pointer_cast<const Node>(item)) {
+        for (const auto& connector : node->connectors()) {
+            _ids.remove(connector.get());
+        }
+    }
+
+    schedule();
+}
+
+/**
+ * Publishes once control returns to the event loop so that adding or removing
+ * many items at once only results in a single snapshot.
+ */
+void NetlistPublisher::schedule()
+{
+    if (!_publishQueued) {
+        _publishQueued = true;
+        QMetaObject::invokeMethod(this, &NetlistPublisher::publish, Qt::QueuedConnection);
+    }
+}
+
+quint32 NetlistPublisher::id(const void* object)
+{
+    auto it = _ids.constFind(object);
+    if (it == _ids.cend()) {
+        it = _ids.insert(object, _nextId++);
+    }
+
+    return it.value();
+}
+
+/**
+ * Unnamed nets are identified by the lowest id of their wires. Wires and
+ * connectors can only be part of one net so the ids don't collide.
+ */
+quint32 NetlistPublisher::netId(const QString& name, const std::vector<Wire*>& wires, const std::vector<Connector*>& connectors)
+{
+    if (!name.isEmpty()) {
+        auto it = _netIds.constFind(name);
+        if (it == _netIds.cend()) {
+            it = _netIds.insert(name, _nextId++);
+        }
+        return it.value();
+    }
+
+    quint32 result = NETLIST_SNAPSHOT_NONE;
+    for (const Wire* wire : wires) {
+        result = std::min(result, id(wire));
+    }
+
+    // Connectors that are connected without a wire
+    if (result == NETLIST_SNAPSHOT_NONE) {
+        for (const Connector* connector : connectors) {
+            result = std::min(result, id(connector));
+        }
+    }
+
+    return result;
+}
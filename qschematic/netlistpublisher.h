@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Scene;
+    class Item;
+    class Node;
+    class Connector;
+    class Wire;
+    class NetlistSnapshotSegment;
+
+    /**
+     * Publishes the netlist of a scene as a flat snapshot (see
+     * utils/netlistsnapshot.h) in a POSIX shared memory segment. Another
+     * process opens the segment with NetlistSnapshotSegment::open() and reads
+     * the snapshots in place instead of parsing Netlist::toJson().
+     *
+     * A new snapshot is published after every command executed by the undo
+     * stack and once control returns to the event loop after items were added
+     * or removed. Node and connector ids stay the same for as long as the item
+     * exists. Named nets keep their id, unnamed nets keep theirs for as long as
+     * the wire with the lowest id stays in the net.
+     *
+     * On platforms without POSIX shared memory isOpen() is always false.
+     */
+    class QSCHEMATIC_EXPORT NetlistPublisher :
+        public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(NetlistPublisher)
+
+    public:
+        NetlistPublisher(Scene* scene, const QString& name, QObject* parent = nullptr);
+        virtual ~NetlistPublisher() override;
+
+        QString name() const;
+        bool isOpen() const;
+        quint64 sequence() const;
+
+    public slots:
+        void publish();
+
+    signals:
+        void published(quint64 sequence);
+
+    protected:
+        virtual QString nodeName(const Node& node) const;
+        virtual QString connectorName(const Connector& connector) const;
+
+    private:
+        void itemAdded(const std::shared_ptr<const Item>& item);
+        void itemRemoved(const std::shared_ptr<const Item>& item);
+        void schedule();
+        quint32 id(const void* object);
+        quint32 netId(const QString& name, const std::vector<Wire*>& wires, const std::vector<Connector*>& connectors);
+
+        QPointer<Scene> _scene;
+        QString _name;
+        std::unique_ptr<NetlistSnapshotSegment> _segment;
+        QHash<const void*, quint32> _ids;
+        QHash<QString, quint32> _netIds;            // Named nets
+        quint32 _nextId;
+        bool _publishQueued;
+    };
+
+}
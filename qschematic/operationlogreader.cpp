@@ -0,0 +1,109 @@
+#include <QIODevice>
+#include "operationlogreader.h"
+
+using namespace QSchematic;
+
+OperationLogReader::OperationLogReader(QIODevice* device, QObject* parent) :
+    QObject(parent),
+    _sequence(0),
+    _diverged(false)
+{
+    setDevice(device);
+}
+
+void OperationLogReader::setDevice(QIODevice* device)
+{
+    if (_device) {
+        disconnect(_device, nullptr, this, nullptr);
+    }
+
+    _device = device;
+
+    if (_device) {
+        connect(_device, &QIODevice::readyRead, this, &OperationLogReader::readDevice);
+        readDevice();
+    }
+}
+
+QIODevice* OperationLogReader::device() const
+{
+    return _device;
+}
+
+void OperationLogReader::feed(const QByteArray& data)
+{
+    _codec.append(data);
+
+    const quint64 first = _sequence;
+    Operation operation;
+    while (_codec.next(operation)) {
+        // A reset starts over no matter what happened before
+        if (operation.type == Operation::Reset) {
+            _diverged = false;
+        } else if (_diverged) {
+            _sequence = operation.sequence;
+            continue;
+        } else if (_sequence != 0 && operation.sequence != _sequence + 1) {
+            _sequence = operation.sequence;
+            setDiverged();
+            continue;
+        }
+        _sequence = operation.sequence;
+
+        if (!_model.apply(operation)) {
+            setDiverged();
+            continue;
+        }
+        if (operation.type == Operation::Checksum && operation.checksum != _model.checksum()) {
+            setDiverged();
+        }
+    }
+
+    if (_codec.hasError()) {
+        setDiverged();
+    }
+
+    if (_sequence != first && !_diverged) {
+        emit applied(_sequence);
+    }
+}
+
+const OperationLogModel& OperationLogReader::model() const
+{
+    return _model;
+}
+
+/**
+ * Returns the sequence number of the last operation received
+ */
+quint64 OperationLogReader::sequence() const
+{
+    return _sequence;
+}
+
+bool OperationLogReader::isDiverged() const
+{
+    return _diverged;
+}
+
+void OperationLogReader::readDevice()
+{
+    if (!_device) {
+        return;
+    }
+
+    const QByteArray data = _device->readAll();
+    if (!data.isEmpty()) {
+        feed(data);
+    }
+}
+
+void OperationLogReader::setDiverged()
+{
+    if (_diverged) {
+        return;
+    }
+
+    _diverged = true;
+    emit diverged(_sequence);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include "utils/operationlog.h"
+#include "qschematic_export.h"
+
+class QIODevice;
+
+namespace QSchematic
+{
+
+    /**
+     * Applies an operation log written by an OperationLogWriter (typically in
+     * another process) to an OperationLogModel. Operations can arrive in
+     * arbitrary chunks, either from a device or by calling feed().
+     *
+     * Gaps in the sequence, operations that don't fit the state and checksum
+     * mismatches mark the replica as diverged. It stays that way until the
+     * writer resyncs.
+     */
+    class QSCHEMATIC_EXPORT OperationLogReader :
+        public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(OperationLogReader)
+
+    public:
+        explicit OperationLogReader(QIODevice* device = nullptr, QObject* parent = nullptr);
+        virtual ~OperationLogReader() override = default;
+
+        void setDevice(QIODevice* device);
+        QIODevice* device() const;
+        void feed(const QByteArray& data);
+        const OperationLogModel& model() const;
+        quint64 sequence() const;
+        bool isDiverged() const;
+
+    signals:
+        void applied(quint64 sequence);
+        void diverged(quint64 sequence);
+
+    private:
+        void readDevice();
+        void setDiverged();
+
+        QPointer<QIODevice> _device;
+        OperationCodec _codec;
+        OperationLogModel _model;
+        quint64 _sequence;
+        bool _diverged;
+    };
+
+}
@@ -0,0 +1,343 @@
+#include <utility>
+#include <QIODevice>
+#include <QUndoStack>
+#include "operationlogwriter.h"
+#include "scene.h"
+#include "items/item.h"
+#include "items/node.h"
+#include "items/connector.h"
+#include "items/wire.h"
+#include "items/wirenet.h"
+#include "wire_system/manager.h"
+#include "wire_system/net.h"
+
+using namespace QSchematic;
+
+const int DEFAULT_CHECKSUM_INTERVAL = 64;
+
+OperationLogWriter::OperationLogWriter(Scene* scene, QObject* parent) :
+    QObject(parent),
+    _scene(scene),
+    _flushQueued(false)
+{
+    Q_ASSERT(scene);
+
+    _encoder.setChecksumInterval(DEFAULT_CHECKSUM_INTERVAL);
+
+    connect(scene, &Scene::itemAdded, this, &OperationLogWriter::itemAdded);
+    connect(scene, &Scene::itemRemoved, this, &OperationLogWriter::itemRemoved);
+
+    // Every executed, undone or redone command results in one batch of operations
+    connect(scene->undoStack(), &QUndoStack::indexChanged, this, &OperationLogWriter::commandExecuted);
+
+    // The items that are already there
+    for (const auto& item : scene->items()) {
+        itemAdded(item);
+    }
+}
+
+/**
+ * Sets the device (eg. a QLocalSocket or a pipe) the operations are written
+ * to. The state is sent again from scratch so that the peer can start over.
+ */
+void OperationLogWriter::setDevice(QIODevice* device)
+{
+    _device = device;
+
+    resync();
+}
+
+QIODevice* OperationLogWriter::device() const
+{
+    return _device;
+}
+
+/**
+ * Sets after how many operations a checksum is written. 0 disables checksums.
+ */
+void OperationLogWriter::setChecksumInterval(int operations)
+{
+    _encoder.setChecksumInterval(operations);
+}
+
+int OperationLogWriter::checksumInterval() const
+{
+    return _encoder.checksumInterval();
+}
+
+/**
+ * Returns the state described by the operations written so far.
+ */
+const OperationLogModel& OperationLogWriter::model() const
+{
+    return _encoder.model();
+}
+
+quint64 OperationLogWriter::sequence() const
+{
+    return _encoder.sequence();
+}
+
+/**
+ * Writes the operations for everything that changed since the last flush.
+ * This happens automatically after each command and once control returns to
+ * the event loop, calling it manually is only required for immediate results.
+ */
+void OperationLogWriter::flush()
+{
+    _flushQueued = false;
+
+    if (!_scene) {
+        return;
+    }
+
+    auto manager = _scene->wire_manager();
+
+    // Removed items
+    for (const Item* item : qAsConst(_removed)) {
+        _encoder.removeItem(item);
+    }
+    _removed.clear();
+
+    // Added or changed items and wires. The attachments can only have changed
+    // for the nodes among them and for the nodes attached to the wires among them.
+    QSet<const Node*> attachmentNodes;
+    for (const Item* raw : qAsConst(_dirty)) {
+        const auto item = _present.value(raw).lock();
+        if (!item) {
+            continue;
+        }
+
+        if (auto wire = std::dynamic_pointer_cast<const Wire>(item)) {
+            const quint64 net = netId(std::const_pointer_cast<Wire>(wire)->net().get());
+            _encoder.updateWire(raw, item->type(), net, wire->pointsAbsolute());
+
+            for (const auto* connectable : manager->attached_connectors(wire.get())) {
+                if (const auto* connector = dynamic_cast<const Connector*>(connectable)) {
+                    if (const auto* node = dynamic_cast<const Node*>(connector->parentItem())) {
+                        attachmentNodes.insert(node);
+                    }
+                }
+            }
+            for (const auto& connector : _encoder.attachedTo(_encoder.findId(raw))) {
+                if (const auto* node = dynamic_cast<const Node*>(static_cast<const Item*>(_encoder.key(connector.first)))) {
+                    attachmentNodes.insert(node);
+                }
+            }
+            continue;
+        }
+
+        QSizeF size;
+        QVector<QPointF> connectors;
+        if (auto node = std::dynamic_pointer_cast<const Node>(item)) {
+            size = node->size();
+            for (const auto& connector : node->connectors()) {
+                connectors << connector->pos();
+            }
+            attachmentNodes.insert(node.get());
+        }
+        _encoder.updateItem(raw, item->type(), item->pos(), item->rotation(), size, connectors);
+    }
+    _dirty.clear();
+
+    // Nets
+    flushNets();
+
+    // Connector attachments
+    for (const Node* node : qAsConst(attachmentNodes)) {
+        const quint64 nodeId = _encoder.findId(static_cast<const Item*>(node));
+        if (!_encoder.model().items.contains(nodeId)) {
+            continue;
+        }
+
+        const auto& connectors = node->connectors();
+        for (int i = 0; i < connectors.count(); i++) {
+            const auto* wire = dynamic_cast<const Item*>(manager->attached_wire(connectors.at(i).get()));
+            const quint64 wireId = wire ? _encoder.findId(wire) : 0;
+            if (wireId != 0 && _encoder.model().wires.contains(wireId)) {
+                _encoder.setAttachment(nodeId, i, wireId, manager->attached_point(connectors.at(i).get()));
+            } else {
+                _encoder.setAttachment(nodeId, i, 0, 0);
+            }
+        }
+    }
+
+    // Let the peer detect divergence
+    _encoder.finish();
+
+    const QByteArray& frames = _encoder.takeFrames();
+    if (frames.isEmpty()) {
+        return;
+    }
+    if (_device) {
+        _device->write(frames);
+    }
+    emit operationsWritten(frames);
+}
+
+/**
+ * Makes the peer start over: its state is cleared and the current state of
+ * the scene is written again, followed by a checksum.
+ */
+void OperationLogWriter::resync()
+{
+    _encoder.reset();
+
+    for (WireNet* net : qAsConst(_nets)) {
+        disconnect(net, nullptr, this, nullptr);
+    }
+    _nets.clear();
+    _dirtyNets.clear();
+    _removed.clear();
+    for (auto it = _present.cbegin(); it != _present.cend(); ++it) {
+        _dirty.insert(it.key());
+    }
+
+    flush();
+}
+
+/**
+ * Writes the names of the nets that reported a change and releases the ids of
+ * the ones left without wires. The wires that moved to another net reported
+ * it through their nets and were written with the items.
+ */
+void OperationLogWriter::flushNets()
+{
+    const QSet<const wire_system::net*> dirtyNets = std::exchange(_dirtyNets, { });
+    for (const wire_system::net* net : dirtyNets) {
+        if (!_nets.contains(net)) {
+            continue;
+        }
+
+        if (net->wires().isEmpty()) {
+            releaseNet(net);
+        } else {
+            _encoder.renameNet(_encoder.findId(net), net->name());
+        }
+    }
+}
+
+void OperationLogWriter::commandExecuted()
+{
+    flush();
+}
+
+void OperationLogWriter::itemAdded(const std::shared_ptr<const Item>& item)
+{
+    if (!item) {
+        return;
+    }
+
+    const Item* raw = item.get();
+    _present.insert(raw, item);
+
+    auto mutableItem = std::const_pointer_cast<Item>(item);
+    connect(mutableItem.get(), &Item::moved, this, [this, raw] { markDirty(raw); });
+    connect(mutableItem.get(), &Item::rotated, this, [this, raw] { markDirty(raw); });
+    if (auto node = std::dynamic_pointer_cast<Node>(mutableItem)) {
+        connect(node.get(), &Node::sizeChanged, this, [this, raw] { markDirty(raw); });
+        for (const auto& connector : node->connectors()) {
+            connect(connector.get(), &Item::moved, this, [this, raw] { markDirty(raw); });
+        }
+    }
+    if (auto wire = std::dynamic_pointer_cast<Wire>(mutableItem)) {
+        connect(wire.get(), &Wire::pointMoved, this, [this, raw] { markDirty(raw); });
+    }
+
+    markDirty(raw);
+}
+
+void OperationLogWriter::itemRemoved(const std::shared_ptr<const Item>& item)
+{
+    if (!item) {
+        return;
+    }
+
+    const Item* raw = item.get();
+    _present.remove(raw);
+    _dirty.remove(raw);
+
+    auto mutableItem = std::const_pointer_cast<Item>(item);
+    disconnect(mutableItem.get(), nullptr, this, nullptr);
+    if (auto node = std::dynamic_pointer_cast<Node>(mutableItem)) {
+        for (const auto& connector : node->connectors()) {
+            disconnect(connector.get(), nullptr, this, nullptr);
+        }
+    }
+
+    // Items that never made it into the log don't have to be removed
+    if (_encoder.findId(raw) != 0) {
+        _removed.insert(raw);
+    }
+    markDirty(nullptr);
+}
+
+/**
+ * Remembers that the item changed. Changes that don't go through the undo
+ * stack are written once control returns to the event loop.
+ */
+void OperationLogWriter::markDirty(const Item* item)
+{
+    if (item) {
+        _dirty.insert(item);
+    }
+
+    if (!_flushQueued) {
+        _flushQueued = true;
+        QMetaObject::invokeMethod(this, &OperationLogWriter::flush, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Remembers that the name or the wires of the net changed.
+ */
+void OperationLogWriter::markNetDirty(const wire_system::net* net)
+{
+    if (net) {
+        _dirtyNets.insert(net);
+    }
+    markDirty(nullptr);
+}
+
+/**
+ * Returns the id of the net. Nets are followed from the moment they get one:
+ * a wire leaving or joining the net is written as a change of that wire and
+ * the name is written whenever it changes.
+ */
+quint64 OperationLogWriter::netId(const wire_system::net* net)
+{
+    if (!net) {
+        return 0;
+    }
+
+    if (!_nets.contains(net)) {
+        auto* wireNet = dynamic_cast<WireNet*>(const_cast<wire_system::net*>(net));
+        _nets.insert(net, wireNet);
+        _dirtyNets.insert(net);
+        if (wireNet) {
+            connect(wireNet, &WireNet::nameChanged, this, [this, net] { markNetDirty(net); });
+            connect(wireNet, &WireNet::wireAdded, this, [this, net](const wire_system::wire* wire) {
+                markDirty(dynamic_cast<const Item*>(wire));
+                markNetDirty(net);
+            });
+            connect(wireNet, &WireNet::wireRemoved, this, [this, net](const wire_system::wire* wire) {
+                markDirty(dynamic_cast<const Item*>(wire));
+                markNetDirty(net);
+            });
+
+            // The address of a deleted net may be reused
+            connect(wireNet, &QObject::destroyed, this, [this, net] { releaseNet(net); });
+        }
+    }
+
+    return _encoder.id(net);
+}
+
+void OperationLogWriter::releaseNet(const wire_system::net* net)
+{
+    if (WireNet* wireNet = _nets.take(net)) {
+        disconnect(wireNet, nullptr, this, nullptr);
+    }
+    _dirtyNets.remove(net);
+    _encoder.releaseId(net);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include "utils/operationlog.h"
+#include "qschematic_export.h"
+
+class QIODevice;
+
+namespace wire_system
+{
+    class net;
+}
+
+namespace QSchematic
+{
+
+    class Scene;
+    class Item;
+    class WireNet;
+
+    /**
+     * Derives an ordered operation log from the edits of a scene so that
+     * another process can mirror it (see OperationLogReader).
+     *
+     * Changes are collected as the items and nets report them and turned into
+     * operations each time the undo stack executes a command. Only the items
+     * and nets that reported a change are compared against the state sent so
+     * far. A checksum of that state is appended every checksumInterval()
+     * operations.
+     */
+    class QSCHEMATIC_EXPORT OperationLogWriter :
+        public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(OperationLogWriter)
+
+    public:
+        explicit OperationLogWriter(Scene* scene, QObject* parent = nullptr);
+        virtual ~OperationLogWriter() override = default;
+
+        void setDevice(QIODevice* device);
+        QIODevice* device() const;
+        void setChecksumInterval(int operations);
+        int checksumInterval() const;
+        const OperationLogModel& model() const;
+        quint64 sequence() const;
+
+    public slots:
+        void flush();
+        void resync();
+
+    signals:
+        void operationsWritten(const QByteArray& frames);
+
+    private:
+        void commandExecuted();
+        void itemAdded(const std::shared_ptr<const Item>& item);
+        void itemRemoved(const std::shared_ptr<const Item>& item);
+        void markDirty(const Item* item);
+        void markNetDirty(const wire_system::net* net);
+        void flushNets();
+        quint64 netId(const wire_system::net* net);
+        void releaseNet(const wire_system::net* net);
+
+        QPointer<Scene> _scene;
+        QPointer<QIODevice> _device;
+        OperationLogEncoder _encoder;
+        bool _flushQueued;
+        QHash<const Item*, std::weak_ptr<const Item>> _present;
+        QHash<const wire_system::net*, WireNet*> _nets;         // Nets that have an id
+        QSet<const Item*> _dirty;
+        QSet<const wire_system::net*> _dirtyNets;
+        QSet<const Item*> _removed;
+    };
+
+}
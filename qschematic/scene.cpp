@@ -1,33 +1,190 @@
 #include <algorithm>
+#include <array>
+#include <cmath>
 
 #include <QPainter>
 #include <QGraphicsSceneMouseEvent>
 #include <QUndoStack>
 #include <QMimeData>
 #include <QtMath>
+#include <QSet>
 #include <QTimer>
 
 #include "scene.h"
 #include "commands/commanditemmove.h"
 #include "commands/commanditemadd.h"
 #include "commands/commanditemremove.h"
+#include "commands/commandlayerchange.h"
+#include "commands/commandwiremerge.h"
+#include "commands/commandpaste.h"
 #include "items/itemfactory.h"
 #include "items/item.h"
 #include "items/itemmimedata.h"
+#include "items/selectionmimedata.h"
 #include "items/node.h"
 #include "items/label.h"
+#include "items/blockinstance.h"
+#include "items/busripper.h"
+#include "blocklibrary.h"
+#include "collisionservice.h"
+#include "sceneextents.h"
+#include "snapengine.h"
 #include "utils/itemscontainerutils.h"
+#include "utils/scenecontainerreader.h"
 
 using namespace QSchematic;
 
+const QColor COLOR_WIRE_PREVIEW = QColor("#000000");
+const qreal WIRE_PREVIEW_PADDING = 2;
+const qreal AUTO_SCENE_RECT_MARGIN = 0.25;          // Relative to the content size
+const int AUTO_SCENE_RECT_MARGIN_MIN = 10;          // In grid units
+const qreal AUTO_SCENE_RECT_SHRINK_RATIO = 4;       // Area of the scene rect compared to the wanted one
+
+namespace
+{
+
+    struct ChainLink
+    {
+        std::shared_ptr<Wire> wire;
+        bool reversed;
+    };
+    using WireChain = QVector<ChainLink>;
+
+    quint64 pointKey(const QPointF& point)
+    {
+        const QPoint& p = point.toPoint();
+
+        return (static_cast<quint64>(static_cast<quint32>(p.x())) << 32) | static_cast<quint32>(p.y());
+    }
+
+    /**
+     * Finds the chains of wires in the net that are joined end-to-end at points
+     * where nothing else is connected (no other wire, no connector).
+     */
+    QVector<WireChain> mergeableChains(const WireNet& net, wire_system::manager& manager)
+    {
+        struct End
+        {
+            int wire = -1;
+            int end = -1;       // 0: first point, 1: last point
+        };
+
+        QVector<std::shared_ptr<Wire>> wires;
+        for (const auto& rawWire : net.wires()) {
+            auto wire = std::dynamic_pointer_cast<Wire>(rawWire);
+            if (wire && wire->points_count() >= 2) {
+                wires << wire;
+            }
+        }
+        auto pointIndex = [&wires](const End& end) {
+            return end.end == 0 ? 0 : wires.at(end.wire)->points_count() - 1;
+        };
+
+        // Wire ends by position
+        QHash<quint64, QVector<End>> ends;
+        for (int i = 0; i < wires.count(); i++) {
+            ends[pointKey(wires.at(i)->points().first().toPointF())] << End{ i, 0 };
+            ends[pointKey(wires.at(i)->points().last().toPointF())] << End{ i, 1 };
+        }
+
+        // Find the joints that can be merged
+        QVector<std::array<End, 2>> partners(wires.count());
+        for (const auto& joint : ends) {
+            if (joint.count() != 2 || joint.at(0).wire == joint.at(1).wire) {
+                continue;
+            }
+
+            const auto& a = wires.at(joint.at(0).wire);
+            const auto& b = wires.at(joint.at(1).wire);
+            if (a->type() != b->type()) {
+                continue;
+            }
+            if (manager.point_is_attached(a.get(), pointIndex(joint.at(0))) || manager.point_is_attached(b.get(), pointIndex(joint.at(1)))) {
+                continue;
+            }
+
+            // No other wire may touch the joint
+            const QPointF& point = a->points().at(pointIndex(joint.at(0))).toPointF();
+            bool branching = false;
+            for (int i = 0; i < wires.count() && !branching; i++) {
+                branching = i != joint.at(0).wire && i != joint.at(1).wire && wires.at(i)->point_is_on_wire(point);
+            }
+            if (branching) {
+                continue;
+            }
+
+            partners[joint.at(0).wire][joint.at(0).end] = joint.at(1);
+            partners[joint.at(1).wire][joint.at(1).end] = joint.at(0);
+        }
+
+        // Walk the chains from their open ends, closed loops are left alone
+        QVector<WireChain> chains;
+        QVector<bool> visited(wires.count(), false);
+        for (int i = 0; i < wires.count(); i++) {
+            if (visited.at(i)) {
+                continue;
+            }
+
+            int entry;
+            if (partners.at(i)[0].wire == -1) {
+                entry = 0;
+            } else if (partners.at(i)[1].wire == -1) {
+                entry = 1;
+            } else {
+                continue;
+            }
+
+            WireChain chain;
+            int current = i;
+            while (current != -1 && !visited.at(current)) {
+                visited[current] = true;
+                chain << ChainLink{ wires.at(current), entry == 1 };
+
+                const End& next = partners.at(current)[1 - entry];
+                current = next.wire;
+                entry = next.end;
+            }
+
+            if (chain.count() > 1) {
+                chains << chain;
+            }
+        }
+
+        return chains;
+    }
+
+    QRectF polylineRect(const QVector<QPointF>& points)
+    {
+        if (points.isEmpty()) {
+            return { };
+        }
+
+        return QPolygonF(points).boundingRect().adjusted(-WIRE_PREVIEW_PADDING, -WIRE_PREVIEW_PADDING, WIRE_PREVIEW_PADDING, WIRE_PREVIEW_PADDING);
+    }
+
+}
+
 Scene::Scene(QObject* parent) :
     QGraphicsScene(parent),
     _mode(NormalMode),
-    _newWireSegment(false),
     _invertWirePosture(true),
     _movingNodes(false),
-    _highlightedItem(nullptr)
+    _highlightedItem(nullptr),
+    _hitTests(0),
+    _hitTestsLastMouseEvent(0),
+    _reducedQualityRequests(0),
+    _blockLibrary(std::make_shared<BlockLibrary>())
 {
+    // Node collisions
+    _collisionService = std::make_shared<CollisionService>();
+
+    // Content extents
+    _sceneExtents = std::make_shared<SceneExtents>();
+    connect(_sceneExtents.get(), &SceneExtents::boundsChanged, this, &Scene::updateAutoSceneRect);
+
+    // Magnetic snapping
+    _snapEngine = std::make_shared<SnapEngine>();
+
     // NOTE: still needed, BSP-indexer still crashes on a scene load when
     // the scene is already populated
     setItemIndexMethod(ItemIndexMethod::NoIndex);
@@ -67,6 +224,18 @@ gpds::container Scene::to_container() const
         scene.add_value("rect", r);
     }
 
+    // Layers
+    gpds::container layersList;
+    for (const auto& layer : _layers) {
+        gpds::container layerContainer = layer->to_container();
+        for (auto it = _layersByType.cbegin(); it != _layersByType.cend(); ++it) {
+            if (it.value() == layer) {
+                layerContainer.add_value("item_type", it.key());
+            }
+        }
+        layersList.add_value("layer", layerContainer);
+    }
+
     // Nodes
     gpds::container nodesList;
     for (const auto& node : nodes()) {
@@ -89,6 +258,12 @@ gpds::container Scene::to_container() const
     // Root
     gpds::container c;
     c.add_value("scene", scene);
+    if (_blockLibrary && !_blockLibrary->isEmpty()) {
+        c.add_value("block_library", _blockLibrary->to_container());
+    }
+    if (!_layers.isEmpty()) {
+        c.add_value("layers", layersList);
+    }
     c.add_value("nodes", nodesList);
     c.add_value("nets", netsList);
 
@@ -97,62 +272,75 @@ gpds::container Scene::to_container() const
 
 void Scene::from_container(const gpds::container& container)
 {
-    // Scene
-    {
-        const gpds::container* sceneContainer = container.get_value<gpds::container*>("scene").value_or(nullptr);
-        Q_ASSERT( sceneContainer );
-
-        // Rect
-        const gpds::container* rectContainer = sceneContainer->get_value<gpds::container*>("rect").value_or(nullptr);
-        if ( rectContainer ) {
-            QRect rect;
-            rect.setX(rectContainer->get_value<int>("x").value_or(0));
-            rect.setY(rectContainer->get_value<int>("y").value_or(0));
-            rect.setWidth(rectContainer->get_value<int>("width").value_or(0));
-            rect.setHeight(rectContainer->get_value<int>("height").value_or(0));
-
-            setSceneRect( rect );
-        }
+    // Block definitions
+    const gpds::container* blockLibraryContainer = container.get_value<gpds::container*>("block_library").value_or(nullptr);
+    if (blockLibraryContainer && _blockLibrary) {
+        _blockLibrary->from_container(*blockLibraryContainer);
     }
 
-    // Nodes
-    const gpds::container* nodesContainer = container.get_value<gpds::container*>("nodes").value_or(nullptr);
-    if ( nodesContainer ) {
-        for (const auto& nodeContainer : nodesContainer->get_values<gpds::container*>("node")) {
-            Q_ASSERT(nodeContainer);
-
-            auto node = ItemFactory::instance().from_container(*nodeContainer);
-            if (!node) {
-                qWarning("Scene::from_container(): Couldn't restore node. Skipping.");
+    // Layers
+    const gpds::container* layersContainer = container.get_value<gpds::container*>("layers").value_or(nullptr);
+    if (layersContainer) {
+        for (const gpds::container* layerContainer : layersContainer->get_values<gpds::container*>("layer")) {
+            Q_ASSERT(layerContainer);
+
+            Layer loaded(QString());
+            loaded.from_container(*layerContainer);
+            auto layer = addLayer(loaded.name());
+            if (!layer) {
                 continue;
             }
-            node->from_container(*nodeContainer);
-            addItem(node);
+            layer->setState(loaded.state());
+
+            for (int itemType : layerContainer->get_values<int>("item_type")) {
+                _layersByType.insert(itemType, layer);
+            }
         }
     }
 
-    // Nets
-    const gpds::container* netsContainer = container.get_value<gpds::container*>("nets").value_or(nullptr);
-    if ( netsContainer ) {
-        Q_ASSERT( netsContainer );
+    // The scene rect, nodes & nets are read like the headless Document does
+    SceneContainerReader reader;
+    reader.rect = [this](const QRect& rect) {
+        setSceneRect(rect);
+    };
+    reader.node = [this](const gpds::container& nodeContainer) {
+        auto node = ItemFactory::instance().from_container(nodeContainer);
+        if (!node) {
+            qWarning("Scene::from_container(): Couldn't restore node. Skipping.");
+            return;
+        }
+        node->from_container(nodeContainer);
 
-        for (const gpds::container* netContainer : netsContainer->get_values<gpds::container*>("net")) {
-            Q_ASSERT( netContainer );
+        // Resolve the block definition
+        if (auto instance = std::dynamic_pointer_cast<BlockInstance>(node)) {
+            if (auto library = blockLibrary()) {
+                instance->setDefinition(library->definition(instance->definitionName()));
+            }
+        }
 
-            auto net = std::make_shared<WireNet>();
-            net->setScene(this);
-            net->set_manager(wire_manager().get());
-            net->from_container( *netContainer );
+        addItem(node);
+    };
+    reader.net = [this](const gpds::container& netContainer) {
+        auto net = std::make_shared<WireNet>();
+        net->setScene(this);
+        net->set_manager(wire_manager().get());
+        net->from_container(netContainer);
 
-            m_wire_manager->add_net(net);
+        m_wire_manager->add_net(net);
+    };
+    reader.connectors = [this] {
+        QVector<const wire_system::connectable*> list;
+        for (const auto& connector : connectors()) {
+            list << connector.get();
         }
-    }
-
-    // Attach the wires to the nodes
-    generateConnections();
+        return list;
+    };
+    reader.read(container, *m_wire_manager);
 
-    // Find junctions
-    m_wire_manager->generate_junctions();
+    // Merge wire pieces
+    if (_settings.compactNetsOnLoad) {
+        compactNets();
+    }
 
     // Clear the undo history
     _undoStack->clear();
@@ -167,9 +355,12 @@ void Scene::setSettings(const Settings& settings)
 
     // Update settings of the wire manager
     m_wire_manager->set_settings(settings);
+    _collisionService->setSettings(settings);
+    _sceneExtents->setSettings(settings);
 
     // Store new settings
     _settings = settings;
+    updateAutoSceneRect();
 
     // Redraw
     renderCachedBackground();
@@ -191,12 +382,9 @@ void Scene::setMode(int mode)
     // Check what the previous mode was
     switch (_mode) {
 
-    // Discard current wire/bus
+    // Keep what has been drawn of the current wire/bus
     case WireMode:
-        if (_newWire) {
-            _newWire->simplify();
-        }
-        _newWire.reset();
+        finishCurrentWire();
         break;
 
     default:
@@ -242,6 +430,7 @@ void Scene::clear()
 {
     // Ensure no lingering lifespans kept in map-keys, selections or undocommands
     _initialItemPositions.clear();
+    discardCurrentWire();
     clearSelection();
     clearFocus();
     _undoStack->clear();
@@ -256,6 +445,15 @@ void Scene::clear()
     // Nets
     m_wire_manager->clear();
 
+    // Block definitions
+    if (_blockLibrary) {
+        _blockLibrary->clear();
+    }
+
+    // Layers
+    _layers.clear();
+    _layersByType.clear();
+
     // Now that all the top-level items are safeguarded we can call the underlying scene's clear()
     QGraphicsScene::clear();
 
@@ -288,6 +486,18 @@ bool Scene::addItem(const std::shared_ptr<Item>& item)
     // Store the shared pointer to keep the item alive for the QGraphicsScene
     _items << item;
 
+    // Keep track of the node geometry
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        _collisionService->addNode(node);
+    }
+    _sceneExtents->addItem(item);
+
+    // Keep track of the bus rippers for netlisting
+    if (auto ripper = std::dynamic_pointer_cast<BusRipper>(item)) {
+        _busRippers.insert(ripper->member(), ripper.get());
+        connect(ripper.get(), &BusRipper::memberChanged, this, &Scene::busRipperMemberChanged);
+    }
+
     // Let the world know
     emit itemAdded(item);
 
@@ -300,15 +510,7 @@ bool Scene::removeItem(const std::shared_ptr<Item> item)
     if (!item)
         return false;
 
-    // Figure out what area we need to update
-    auto itemBoundsToUpdate = item->mapRectToScene(item->boundingRect());
-
-    // NOTE: Sometimes ghosts remain (not drawn away) when they're active in some way at remove time, found below from looking at Qt-source code...
-    item->clearFocus();
-    item->setFocusProxy(nullptr);
-
-    // Remove from scene (if necessary)
-    QGraphicsScene::removeItem(item.get());
+    const QRectF itemBoundsToUpdate = takeOutItem(item);
 
     // Remove shared pointer from local list to reduce instance count
     _items.removeAll(item);
@@ -327,6 +529,72 @@ bool Scene::removeItem(const std::shared_ptr<Item> item)
     return true;
 }
 
+/**
+ * Removes several items at once. Unlike calling removeItem() for each of them
+ * the list of items is only walked once. Returns the number of removed items.
+ */
+int Scene::removeItems(const QVector<std::shared_ptr<Item>>& items)
+{
+    QSet<const Item*> removed;
+    QVector<std::shared_ptr<Item>> taken;
+    QRectF boundsToUpdate;
+    for (const auto& item : items) {
+        if (!item || removed.contains(item.get())) {
+            continue;
+        }
+        removed.insert(item.get());
+        taken << item;
+
+        boundsToUpdate |= takeOutItem(item);
+    }
+    if (taken.isEmpty()) {
+        return 0;
+    }
+
+    // Remove the shared pointers from the local list in one pass
+    _items.erase(std::remove_if(_items.begin(), _items.end(), [&removed](const std::shared_ptr<Item>& item) {
+        return removed.contains(item.get());
+    }), _items.end());
+
+    update(boundsToUpdate);
+
+    for (const auto& item : taken) {
+        emit itemRemoved(item);
+        _keep_alive_an_event_loop << item;
+    }
+
+    return taken.count();
+}
+
+/**
+ * Removes the item from the QGraphicsScene and from the indices of the scene
+ * but not from _items. Returns the scene area to update.
+ */
+QRectF Scene::takeOutItem(const std::shared_ptr<Item>& item)
+{
+    // Figure out what area we need to update
+    const QRectF itemBoundsToUpdate = item->mapRectToScene(item->boundingRect());
+
+    // NOTE: Sometimes ghosts remain (not drawn away) when they're active in some way at remove time, found below from looking at Qt-source code...
+    item->clearFocus();
+    item->setFocusProxy(nullptr);
+
+    // Remove from scene (if necessary)
+    QGraphicsScene::removeItem(item.get());
+
+    // Stop tracking the node geometry
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        _collisionService->removeNode(node);
+    }
+    _sceneExtents->removeItem(item);
+    if (auto ripper = std::dynamic_pointer_cast<BusRipper>(item)) {
+        _busRippers.remove(ripper->member(), ripper.get());
+        disconnect(ripper.get(), &BusRipper::memberChanged, this, &Scene::busRipperMemberChanged);
+    }
+
+    return itemBoundsToUpdate;
+}
+
 QList<std::shared_ptr<Item>> Scene::items() const
 {
     return _items;
@@ -448,20 +716,54 @@ QUndoStack* Scene::undoStack() const
     return _undoStack;
 }
 
+/**
+ * Returns the bus rippers tapping the given bus member. This is looked up in an
+ * index which follows BusRipper::setMember().
+ */
+QList<std::shared_ptr<BusRipper>> Scene::busRippers(const QString& member) const
+{
+    QList<std::shared_ptr<BusRipper>> list;
+    for (BusRipper* ripper : _busRippers.values(member)) {
+        list << ripper->sharedPtr<BusRipper>();
+    }
+
+    return list;
+}
+
 std::shared_ptr<wire_system::manager> Scene::wire_manager() const
 {
     return m_wire_manager;
 }
 
+std::shared_ptr<CollisionService> Scene::collisionService() const
+{
+    return _collisionService;
+}
+
+/**
+ * Returns the extents of the content which are maintained as items are added,
+ * removed or changed. Use this instead of iterating over all items.
+ */
+std::shared_ptr<SceneExtents> Scene::sceneExtents() const
+{
+    return _sceneExtents;
+}
+
+std::shared_ptr<SnapEngine> Scene::snapEngine() const
+{
+    return _snapEngine;
+}
+
 void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
 {
     event->accept();
+    _hitTests = 0;
 
     switch (_mode) {
     case NormalMode:
     {
         // Reset stuff
-        _newWire = {};
+        discardCurrentWire();
 
         // Handle selections
         QGraphicsScene::mousePressEvent(event);
@@ -504,6 +806,13 @@ void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
         // Store the initial cursor position
         _initialCursorPosition = event->scenePos();
 
+        // Prepare the magnetic snapping
+        _snapOffset = QVector2D();
+        _collisionOffset = QVector2D();
+        if (_movingNodes) {
+            _snapEngine->begin(*this, _initialItemPositions.keys());
+        }
+
         break;
     }
 
@@ -513,49 +822,20 @@ void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
         // Left mouse button
         if (event->button() == Qt::LeftButton) {
 
-            // Start a new wire if there isn't already one. Else continue the current one.
-            if (!_newWire) {
-                if (_wireFactory) {
-                    _newWire = _wireFactory();
-                } else {
-                    _newWire = std::make_shared<Wire>();
-                }
-                _undoStack->push(new CommandItemAdd(this, _newWire));
-                _newWire->setPos(_settings.snapToGrid(event->scenePos()));
-            }
             // Snap to grid
             const QPointF& snappedPos = _settings.snapToGrid(event->scenePos());
-            _newWire->append_point(snappedPos);
-            _newWireSegment = true;
-
-            // Attach point to connector if needed
-            bool wireAttached = false;
-            for (const auto& node: nodes()) {
-                for (const auto& connector: node->connectors()) {
-                    if (QVector2D(connector->scenePos() - snappedPos).length() < 1) {
-                        m_wire_manager->attach_wire_to_connector(_newWire.get(), _newWire->pointsAbsolute().indexOf(snappedPos),
-                                                                 connector.get());
-                        wireAttached = true;
-                        break;
-                    }
-                }
-            }
 
-            // Attach point to wire if needed
-            for (const auto& wire: m_wire_manager->wires()) {
-                // Skip current wire
-                if (wire == _newWire) {
-                    continue;
-                }
-                if (wire->point_is_on_wire(_newWire->pointsAbsolute().last())) {
-                    m_wire_manager->connect_wire(wire.get(), _newWire.get(), _newWire->pointsAbsolute().count() - 1);
-                    wireAttached = true;
-                    break;
-                }
+            // Start a new wire if there isn't already one. Else continue the current one.
+            // The wire only becomes an actual item once it's finished.
+            if (_newWirePoints.isEmpty()) {
+                _newWirePoints << snappedPos;
+            } else {
+                _newWirePoints << newWireSegment(_newWirePoints.last(), snappedPos);
             }
+            updateNewWirePreview(snappedPos);
 
             // Check if both ends of the wire are connected to something
-            if (wireAttached && _newWire->pointsAbsolute().count() > 1) {
+            if (_newWirePoints.count() > 1 && isWireEndpointTarget(snappedPos)) {
                 finishCurrentWire();
             }
 
@@ -566,11 +846,13 @@ void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
     }
 
     _lastMousePos = event->scenePos();
+    _hitTestsLastMouseEvent = _hitTests;
 }
 
 void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
 {
     event->accept();
+    _hitTests = 0;
 
     switch (_mode) {
     case NormalMode:
@@ -638,6 +920,12 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
                 }
             }
         }
+
+        // Done snapping
+        _snapEngine->end();
+        _snapOffset = QVector2D();
+        _collisionOffset = QVector2D();
+
         break;
     }
 
@@ -660,6 +948,7 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
     }
 
     _lastMousePos = event->lastScenePos();
+    _hitTestsLastMouseEvent = _hitTests;
 }
 
 void Scene::updateNodeConnections(const Node* node) const
@@ -737,9 +1026,21 @@ void Scene::wirePointMoved(wire& rawWire, int index)
     }
 }
 
+void Scene::busRipperMemberChanged(const QString& previousMember)
+{
+    auto* ripper = qobject_cast<BusRipper*>(sender());
+    if (!ripper) {
+        return;
+    }
+
+    _busRippers.remove(previousMember, ripper);
+    _busRippers.insert(ripper->member(), ripper);
+}
+
 void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
 {
     event->accept();
+    _hitTests = 0;
 
     // Retrieve the new mouse position
     QPointF newMousePos = event->scenePos();
@@ -769,6 +1070,8 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
                     }
                 }
                 itemsToMove = wiresToMove << itemsToMove;
+                _snapOffset = _snapEngine->snap(QVector2D(newMousePos - _initialCursorPosition));
+                _collisionOffset = dragCollisionOffset(itemsToMove, newMousePos - _initialCursorPosition + _snapOffset.toPointF());
                 for (const auto& item : itemsToMove) {
                     // Calculate by how much the item was moved
                     QPointF moveBy = _initialItemPositions.value(item) + newMousePos - _initialCursorPosition - item->pos();
@@ -825,56 +1128,12 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
     case WireMode:
     {
         // Make sure that there's a wire
-        if (!_newWire) {
+        if (_newWirePoints.isEmpty()) {
             break;
         }
 
-        // Transform mouse coordinates to grid positions (snapped to nearest grid point)
-        const QPointF& snappedPos = _settings.snapToGrid(event->scenePos());
-
-        // Add a new wire segment. Only allow straight angles (if supposed to)
-        if (_settings.routeStraightAngles) {
-            if (_newWireSegment) {
-                // Remove the last point if there was a previous segment
-                if (_newWire->pointsRelative().count() > 1) {
-                    _newWire->removeLastPoint();
-                }
-
-                // Create the intermediate point that creates the straight angle
-                point prevNode(_newWire->pointsAbsolute().at(_newWire->pointsAbsolute().count() - 1));
-                QPointF corner(prevNode.x(), snappedPos.y());
-                if (_invertWirePosture) {
-                    corner.setX(snappedPos.x());
-                    corner.setY(prevNode.y());
-                }
-
-                // Add the two new points
-                _newWire->append_point(corner);
-                _newWire->append_point(snappedPos);
-
-                _newWireSegment = false;
-            } else {
-                // Create the intermediate point that creates the straight angle
-                point p1(_newWire->pointsAbsolute().at(_newWire->pointsAbsolute().count() - 3));
-                QPointF p2(p1.x(), snappedPos.y());
-                QPointF p3(snappedPos);
-                if (_invertWirePosture) {
-                    p2.setX(p3.x());
-                    p2.setY(p1.y());
-                }
-
-                // Modify the actual wire
-                _newWire->move_point_to(_newWire->pointsAbsolute().count() - 2, p2);
-                _newWire->move_point_to(_newWire->pointsAbsolute().count() - 1, p3);
-            }
-        } else {
-            // Don't care about angles and stuff. Fuck geometry, right?
-            if (_newWire->pointsAbsolute().count() > 1) {
-                _newWire->move_point_to(_newWire->pointsAbsolute().count() - 1, snappedPos);
-            } else {
-                _newWire->append_point(snappedPos);
-            }
-        }
+        // Only the preview follows the mouse, the wire system isn't involved until the wire is finished
+        updateNewWirePreview(_settings.snapToGrid(event->scenePos()));
 
         break;
     }
@@ -883,6 +1142,7 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
 
     // Save the last mouse position
     _lastMousePos = newMousePos;
+    _hitTestsLastMouseEvent = _hitTests;
 }
 
 void Scene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
@@ -899,26 +1159,9 @@ void Scene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
     case WireMode:
     {
 
-        // Only do something if there's a wire
-        if (_newWire && _newWire->pointsRelative().count() > 1) {
-
-            // Get rid of the last point as mouseDoubleClickEvent() is following mousePressEvent()
-            _newWire->removeLastPoint();
-
-            // Attach point to wire if needed
-            for (const auto& wire: m_wire_manager->wires()) {
-                // Skip current wire
-                if (wire == _newWire) {
-                    continue;
-                }
-                if (wire->point_is_on_wire(_newWire->pointsAbsolute().last())) {
-                    m_wire_manager->connect_wire(wire.get(), _newWire.get(), _newWire->pointsAbsolute().count() - 1);
-                }
-            }
-
-            // Finish the current wire
+        // Only do something if there's a wire. The point has already been added by mousePressEvent()
+        if (_newWirePoints.count() > 1) {
             finishCurrentWire();
-
             return;
         }
 
@@ -983,6 +1226,9 @@ void Scene::dropEvent(QGraphicsSceneDragDropEvent* event)
 
         // Add to the scene
         item->setPos(event->scenePos());
+        if (auto node = std::dynamic_pointer_cast<Node>(item); node && _settings.preventNodeOverlap) {
+            node->setPos(_collisionService->nearestFreePosition(*node, event->scenePos()));
+        }
         _undoStack->push(new CommandItemAdd(this, std::move(item)));
     }
 }
@@ -996,9 +1242,69 @@ void Scene::drawBackground(QPainter* painter, const QRectF& rect)
 
 QVector2D Scene::itemsMoveSnap(const std::shared_ptr<Item>& items, const QVector2D& moveBy) const
 {
-    Q_UNUSED(items);
+    Q_UNUSED(items)
+
+    // Magnetic snapping and overlap prevention, the same offset for all dragged items
+    return moveBy + _snapOffset + _collisionOffset;
+}
+
+/**
+ * Returns the offset that keeps the dragged nodes from overlapping other nodes
+ * when the items are moved by moveBy from their initial positions. The whole
+ * selection is moved as one, so it's a single search for all nodes.
+ */
+QVector2D Scene::dragCollisionOffset(const QVector<std::shared_ptr<Item>>& items, const QPointF& moveBy) const
+{
+    if (!_settings.preventNodeOverlap) {
+        return { };
+    }
+
+    QVector<QRectF> rects;
+    QSet<const Node*> moving;
+    for (const auto& item : items) {
+        const Node* node = dynamic_cast<const Node*>(item.get());
+        if (!node) {
+            continue;
+        }
+
+        QPointF target = _initialItemPositions.value(item) + moveBy;
+        if (node->snapToGrid()) {
+            target = _settings.snapToGrid(target);
+        }
+        rects << CollisionService::sceneRect(*node).translated(target - node->pos());
+        moving.insert(node);
+    }
+    if (rects.isEmpty()) {
+        return { };
+    }
+
+    // The nodes being dragged along don't count as obstacles
+    return QVector2D(_collisionService->nearestFreeOffset(rects, [&moving](const Node& other) {
+        return moving.contains(&other);
+    }));
+}
+
+void Scene::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    QGraphicsScene::drawForeground(painter, rect);
+
+    // Preview of the wire that is being drawn
+    if (_newWirePoints.isEmpty()) {
+        return;
+    }
 
-    return moveBy;
+    QPen pen;
+    pen.setStyle(Qt::SolidLine);
+    pen.setCapStyle(Qt::RoundCap);
+    pen.setWidth(1);
+    pen.setColor(COLOR_WIRE_PREVIEW);
+
+    painter->save();
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPolyline(_newWirePoints.constData(), _newWirePoints.count());
+    painter->drawPolyline(_newWirePreview.constData(), _newWirePreview.count());
+    painter->restore();
 }
 
 void Scene::renderCachedBackground()
@@ -1061,6 +1367,41 @@ void Scene::renderCachedBackground()
     update();
 }
 
+/**
+ * Fits the scene rect to the content if Settings::autoSceneRect is set. To
+ * avoid rendering the background over and over the rect is given a generous
+ * margin when it grows and only shrinks once it got a lot larger than needed.
+ */
+void Scene::updateAutoSceneRect()
+{
+    if (!_settings.autoSceneRect) {
+        return;
+    }
+
+    const QRectF& content = _sceneExtents->bounds();
+    if (content.isNull()) {
+        return;
+    }
+
+    // The wanted rect, aligned to the grid
+    const int gridSize = std::max(1, _settings.gridSize);
+    const qreal margin = std::max(std::max(content.width(), content.height()) * AUTO_SCENE_RECT_MARGIN, qreal(AUTO_SCENE_RECT_MARGIN_MIN * gridSize));
+    const QRectF& padded = content.adjusted(-margin, -margin, margin, margin);
+    const qreal left = std::floor(padded.left() / gridSize) * gridSize;
+    const qreal top = std::floor(padded.top() / gridSize) * gridSize;
+    const qreal right = std::ceil(padded.right() / gridSize) * gridSize;
+    const qreal bottom = std::ceil(padded.bottom() / gridSize) * gridSize;
+    const QRectF wanted(left, top, right - left, bottom - top);
+
+    // Hysteresis
+    const QRectF& current = sceneRect();
+    const bool outgrown = !current.contains(content);
+    const bool oversized = current.width() * current.height() > AUTO_SCENE_RECT_SHRINK_RATIO * wanted.width() * wanted.height();
+    if (outgrown || oversized) {
+        setSceneRect(wanted);
+    }
+}
+
 void Scene::setupNewItem(Item& item)
 {
     // Set settings
@@ -1069,51 +1410,160 @@ void Scene::setupNewItem(Item& item)
 
 void Scene::generateConnections()
 {
+    QVector<const wire_system::connectable*> list;
     for (const auto& connector : connectors()) {
-        std::shared_ptr<wire> wire = m_wire_manager->wire_with_extremity_at(connector->scenePos());
-        if (wire) {
-            m_wire_manager->attach_wire_to_connector(wire.get(), connector.get());
-        }
+        list << connector.get();
     }
+
+    m_wire_manager->attach_connectors(list);
 }
 
 /**
- * Finishes the current wire if there is one
+ * Finishes the current wire if there is one. The wire is created, added and
+ * connected in one go.
  */
 void Scene::finishCurrentWire()
 {
-    if (!_newWire) {
+    if (_newWirePoints.count() < 2) {
+        discardCurrentWire();
         return;
     }
-    // Finish the current wire
-    _newWire->setAcceptHoverEvents(true);
-    _newWire->setFlag(QGraphicsItem::ItemIsSelectable, true);
-    _newWire->simplify();
-//    _newWire->updatePosition();
-    _newWire.reset();
-}
-
 
-QList<QPointF> Scene::connectionPoints() const
-{
-    QList<QPointF> list;
+    // Create the wire
+    std::shared_ptr<Wire> wire;
+    if (_wireFactory) {
+        wire = _wireFactory();
+    } else {
+        wire = std::make_shared<Wire>();
+    }
+    wire->setPos(_newWirePoints.first());
+    for (const QPointF& point : _newWirePoints) {
+        wire->append_point(point);
+    }
+    wire->simplify();
+    wire->setAcceptHoverEvents(true);
+    wire->setFlag(QGraphicsItem::ItemIsSelectable, true);
+    discardCurrentWire();
 
-    for (const auto& node : nodes()) {
-        list << node->connectionPointsAbsolute();
+    // Nothing left after removing the duplicate points
+    if (wire->points_count() < 2) {
+        return;
     }
 
-    return list;
+    // Adding the wire also connects its ends to the wires they are on and
+    // attaches them to connectors, undoing it detaches them again
+    auto command = new CommandItemAdd(this, wire);
+    for (int index : { 0, wire->points_count() - 1 }) {
+        const auto& connector = connectorAt(wire->points().at(index).toPointF());
+        if (connector) {
+            command->attachToConnector(index, connector);
+        }
+    }
+    _undoStack->push(command);
 }
 
-QList<std::shared_ptr<Connector>> Scene::connectors() const
+/**
+ * Drops the wire that is being drawn without creating it
+ */
+void Scene::discardCurrentWire()
 {
-    QList<std::shared_ptr<Connector>> list;
-
-    for (const auto& node : nodes()) {
-        list << node->connectors();
+    if (_newWirePoints.isEmpty()) {
+        return;
     }
 
-    return list;
+    update(polylineRect(_newWirePoints).united(polylineRect(_newWirePreview)));
+    _newWirePoints.clear();
+    _newWirePreview.clear();
+}
+
+/**
+ * Returns the points following from that are needed to route a new wire
+ * segment to the given position.
+ */
+QVector<QPointF> Scene::newWireSegment(const QPointF& from, const QPointF& to) const
+{
+    // Don't care about angles and stuff
+    if (!_settings.routeStraightAngles) {
+        return { to };
+    }
+
+    // Create the intermediate point that creates the straight angle
+    QPointF corner(from.x(), to.y());
+    if (_invertWirePosture) {
+        corner.setX(to.x());
+        corner.setY(from.y());
+    }
+
+    return { corner, to };
+}
+
+/**
+ * Routes the preview from the last point of the new wire to the cursor and
+ * repaints the area covered by the old and the new preview.
+ */
+void Scene::updateNewWirePreview(const QPointF& cursor)
+{
+    const QRectF oldRect = polylineRect(_newWirePreview);
+
+    _newWirePreview = newWireSegment(_newWirePoints.last(), cursor);
+    _newWirePreview.prepend(_newWirePoints.last());
+
+    update(oldRect.united(polylineRect(_newWirePreview)));
+}
+
+std::shared_ptr<Connector> Scene::connectorAt(const QPointF& point) const
+{
+    for (const auto& node: nodes()) {
+        for (const auto& connector: node->connectors()) {
+            if (QVector2D(connector->scenePos() - point).length() < 1) {
+                return connector;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Returns whether a new wire ending at the point would be attached to a
+ * connector or to another wire.
+ */
+bool Scene::isWireEndpointTarget(const QPointF& point) const
+{
+    if (connectorAt(point)) {
+        return true;
+    }
+
+    for (const auto& wire: m_wire_manager->wires()) {
+        if (wire->point_is_on_wire(point)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+QList<QPointF> Scene::connectionPoints() const
+{
+    QList<QPointF> list;
+
+    for (const auto& node : nodes()) {
+        list << node->connectionPointsAbsolute();
+    }
+
+    return list;
+}
+
+QList<std::shared_ptr<Connector>> Scene::connectors() const
+{
+    QList<std::shared_ptr<Connector>> list;
+
+    for (const auto& node : nodes()) {
+        list << node->connectors();
+    }
+
+    return list;
 }
 
 void Scene::itemHoverEnter(const std::shared_ptr<const Item>& item)
@@ -1132,37 +1582,32 @@ void Scene::itemHoverLeave([[maybe_unused]] const std::shared_ptr<const Item>& i
  */
 void Scene::removeLastWirePoint()
 {
-    if (!_newWire) {
+    if (_newWirePoints.isEmpty()) {
         return;
     }
 
+    const QRectF oldRect = polylineRect(_newWirePoints);
+
     // If we're supposed to preseve right angles, two points have to be removed
     if (_settings.routeStraightAngles) {
-        // Do nothing if there are not at least 4 points
-        if (_newWire->pointsAbsolute().count() > 3) {
-            // Keep the position of the last point
-            QPointF mousePos = _newWire->pointsAbsolute().last();
-            // Remove both points
-            _newWire->removeLastPoint();
-            _newWire->removeLastPoint();
-            // Move the new last point to where the previous last point was
-            _newWire->move_point_by(_newWire->pointsAbsolute().count() - 1,
-                                    QVector2D(mousePos - _newWire->pointsAbsolute().last()));
+        // Do nothing if there are not at least 3 points
+        if (_newWirePoints.count() > 2) {
+            _newWirePoints.removeLast();
+            _newWirePoints.removeLast();
         }
     }
 
     // If we don't care about the angles, only the last point has to be removed
     else {
-        // Do nothing if there are not at least 3 points
-        if (_newWire->pointsAbsolute().count() > 2) {
-            // Keep the position of the last point
-            QPointF mousePos = _newWire->pointsAbsolute().last();
-            // Remove the point
-            _newWire->removeLastPoint();
-            // Move the new last point to where the previous last point was
-            _newWire->move_point_to(_newWire->pointsAbsolute().count() - 1, mousePos);
+        // Do nothing if there are not at least 2 points
+        if (_newWirePoints.count() > 1) {
+            _newWirePoints.removeLast();
         }
     }
+
+    // Route the preview from the new last point to where the mouse is
+    update(oldRect);
+    updateNewWirePreview(_settings.snapToGrid(_lastMousePos));
 }
 
 /**
@@ -1252,4 +1697,489 @@ bool Scene::removeWire(const std::shared_ptr<Wire>& wire)
     return m_wire_manager->remove_wire(wire);
 }
 
+/**
+ * Merges the wires of the net (or of all nets) that are joined end-to-end at
+ * points without junction or connector into single wires and removes collinear
+ * points. This is a single undo command. Returns the number of merged chains.
+ */
+int Scene::compactNets(const std::shared_ptr<WireNet>& net)
+{
+    QList<std::shared_ptr<WireNet>> wireNets;
+    if (net) {
+        wireNets << net;
+    } else {
+        for (const auto& rawNet : m_wire_manager->nets()) {
+            if (auto wireNet = std::dynamic_pointer_cast<WireNet>(rawNet)) {
+                wireNets << wireNet;
+            }
+        }
+    }
+
+    // Nets are independent, find all chains up front
+    QVector<WireChain> chains;
+    for (const auto& wireNet : wireNets) {
+        chains << mergeableChains(*wireNet, *m_wire_manager);
+    }
+    if (chains.isEmpty()) {
+        return 0;
+    }
+
+    _undoStack->beginMacro(QStringLiteral("Compact nets"));
+    for (const auto& chain : chains) {
+        // Concatenate the points, the joints become regular points
+        QVector<wire_system::point> points;
+        QVector<std::shared_ptr<Wire>> wires;
+        for (const auto& link : chain) {
+            auto wirePoints = link.wire->points();
+            if (link.reversed) {
+                std::reverse(wirePoints.begin(), wirePoints.end());
+            }
+            if (!points.isEmpty()) {
+                points.last().set_is_junction(false);
+                wirePoints.removeFirst();
+            }
+            points << wirePoints;
+            wires << link.wire;
+        }
+
+        auto merged = std::dynamic_pointer_cast<Wire>(chain.first().wire->deepCopy());
+        if (!merged) {
+            continue;
+        }
+        merged->set_points(points);
+        merged->simplify();
+
+        _undoStack->push(new CommandWireMerge(this, wires, merged));
+    }
+    _undoStack->endMacro();
+
+    return chains.count();
+}
+
+/**
+ * Copies the selected top-level items including the connectivity between
+ * them. The caller takes ownership of the returned data.
+ */
+QMimeData* Scene::copySelection() const
+{
+    return new SelectionMimeData(*this, selectedTopLevelItems());
+}
+
+/**
+ * Pastes a selection created by copySelection() moved by offset. The mime data
+ * doesn't have to be the one returned by copySelection(), any mime data
+ * carrying its payload will do. Everything is added by a single undo command
+ * and the pasted items get selected. Returns the number of pasted items.
+ */
+int Scene::paste(const QMimeData* mimeData, const QPointF& offset)
+{
+    if (!mimeData || !mimeData->hasFormat(MIME_TYPE_SELECTION)) {
+        return 0;
+    }
+
+    SelectionMimeData::Selection selection;
+    if (!SelectionMimeData::selection(*mimeData, selection, offset)) {
+        qWarning("Scene::paste(): Invalid selection data. Skipping.");
+        return 0;
+    }
+    if (selection.items.isEmpty() && selection.wires.isEmpty()) {
+        return 0;
+    }
+
+    // Resolve the block definitions
+    if (auto library = blockLibrary()) {
+        for (const auto& item : selection.items) {
+            auto instance = std::dynamic_pointer_cast<BlockInstance>(item);
+            if (instance && !instance->definition()) {
+                instance->setDefinition(library->definition(instance->definitionName()));
+            }
+        }
+    }
+
+    // Resolve the indices
+    QVector<CommandPaste::Net> nets;
+    nets.reserve(selection.nets.count());
+    for (const auto& pastedNet : selection.nets) {
+        auto net = std::make_shared<WireNet>();
+        net->setScene(this);
+        net->set_manager(m_wire_manager.get());
+        net->set_name(pastedNet.name);
+
+        CommandPaste::Net entry{ net, { } };
+        entry.wires.reserve(pastedNet.wires.count());
+        for (int index : pastedNet.wires) {
+            entry.wires << selection.wires.at(index);
+        }
+        nets << entry;
+    }
+
+    QVector<CommandPaste::Attachment> attachments;
+    attachments.reserve(selection.attachments.count());
+    for (const auto& attachment : selection.attachments) {
+        auto node = std::static_pointer_cast<Node>(selection.items.at(attachment.item));
+        attachments.push_back({ node->connectors().at(attachment.connector), selection.wires.at(attachment.wire), attachment.point });
+    }
+
+    QVector<CommandPaste::Junction> junctions;
+    junctions.reserve(selection.junctions.count());
+    for (const auto& junction : selection.junctions) {
+        junctions.push_back({ selection.wires.at(junction.wire), selection.wires.at(junction.connectedWire) });
+    }
+
+    _undoStack->push(new CommandPaste(this, selection.items, nets, attachments, junctions));
+
+    // Select what has been pasted
+    clearSelection();
+    for (const auto& item : selection.items) {
+        item->setSelected(true);
+    }
+    for (const auto& wire : selection.wires) {
+        wire->setSelected(true);
+    }
+
+    return selection.items.count() + selection.wires.count();
+}
+
+/**
+ * Returns the library of block definitions. Sub-scenes of block definitions
+ * share the library of the scene they belong to.
+ */
+std::shared_ptr<BlockLibrary> Scene::blockLibrary() const
+{
+    if (_blockLibrary) {
+        return _blockLibrary;
+    }
+
+    return _outerBlockLibrary.lock();
+}
+
+void Scene::setOuterBlockLibrary(const std::weak_ptr<BlockLibrary>& library)
+{
+    // Only a weak reference, the library owns the definitions owning this scene
+    _blockLibrary.reset();
+    _outerBlockLibrary = library;
+}
+
+/**
+ * Adds a new layer. Returns the existing layer if there is one with the same name.
+ */
+std::shared_ptr<Layer> Scene::addLayer(const QString& name)
+{
+    // Sanity check
+    if (name.isEmpty()) {
+        return nullptr;
+    }
+
+    if (auto existing = layer(name)) {
+        return existing;
+    }
+
+    auto newLayer = std::make_shared<Layer>(name);
+    _layers << newLayer;
+
+    return newLayer;
+}
+
+/**
+ * Removes a layer and its item type assignments. Items explicitly assigned to
+ * the layer keep it until they get assigned to a different one.
+ */
+bool Scene::removeLayer(const QString& name)
+{
+    auto existing = layer(name);
+    if (!existing) {
+        return false;
+    }
+
+    _layers.removeAll(existing);
+    for (auto it = _layersByType.begin(); it != _layersByType.end();) {
+        if (it.value() == existing) {
+            it = _layersByType.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    applyLayers();
+
+    return true;
+}
+
+std::shared_ptr<Layer> Scene::layer(const QString& name) const
+{
+    for (const auto& layer : _layers) {
+        if (layer->name() == name) {
+            return layer;
+        }
+    }
+
+    return nullptr;
+}
+
+QList<std::shared_ptr<Layer>> Scene::layers() const
+{
+    return _layers;
+}
+
+/**
+ * Assigns all items of the given type to a layer. Pass nullptr to remove the assignment.
+ */
+void Scene::setLayerForType(int itemType, const std::shared_ptr<Layer>& layer)
+{
+    if (layer) {
+        _layersByType.insert(itemType, layer);
+    } else {
+        _layersByType.remove(itemType);
+    }
+
+    applyLayers();
+}
+
+std::shared_ptr<Layer> Scene::layerForType(int itemType) const
+{
+    return _layersByType.value(itemType);
+}
+
+/**
+ * Changes the flags of a layer through the undo stack.
+ */
+void Scene::setLayerState(const std::shared_ptr<Layer>& layer, const Layer::State& state)
+{
+    // Sanity check
+    if (!layer || layer->state() == state) {
+        return;
+    }
+
+    _undoStack->push(new CommandLayerChange(this, layer, state));
+}
+
+void Scene::setLayerVisible(const std::shared_ptr<Layer>& layer, bool visible)
+{
+    if (!layer) {
+        return;
+    }
+
+    Layer::State state = layer->state();
+    state.visible = visible;
+    setLayerState(layer, state);
+}
+
+void Scene::setLayerLocked(const std::shared_ptr<Layer>& layer, bool locked)
+{
+    if (!layer) {
+        return;
+    }
+
+    Layer::State state = layer->state();
+    state.locked = locked;
+    setLayerState(layer, state);
+}
+
+void Scene::setLayerOpacity(const std::shared_ptr<Layer>& layer, qreal opacity)
+{
+    if (!layer) {
+        return;
+    }
+
+    Layer::State state = layer->state();
+    state.opacity = opacity;
+    setLayerState(layer, state);
+}
+
+/**
+ * Applies the state of the layers to all items. This has to be called after
+ * changing the state of a layer directly rather than through setLayerState().
+ */
+void Scene::applyLayers()
+{
+    for (QGraphicsItem* item : QGraphicsScene::items()) {
+        if (item->parentItem()) {
+            continue;
+        }
+        if (auto* i = dynamic_cast<Item*>(item)) {
+            i->applyLayer();
+        }
+    }
+}
+
+/**
+ * Registers a hit-test (shape containment or collision check) performed on one
+ * of the items. Items only report these while the debug mode is enabled.
+ */
+void Scene::countHitTest() const
+{
+    _hitTests++;
+}
+
+/**
+ * Returns the number of hit-tests performed while handling the last mouse event.
+ */
+int Scene::hitTestsLastMouseEvent() const
+{
+    return _hitTestsLastMouseEvent;
+}
+
+/**
+ * Switches the items to a cheaper rendering profile: No shadows, simplified
+ * junctions and small text drawn as boxes. Views acquire this while the user
+ * is panning, zooming or dragging in them (see Settings::adaptiveQuality).
+ * The profile stays active until every view released it again.
+ */
+void Scene::acquireReducedQuality()
+{
+    if (_reducedQualityRequests++ == 0) {
+        // The other views show the scene too
+        update();
+    }
+}
+
+void Scene::releaseReducedQuality()
+{
+    // Sanity check
+    if (_reducedQualityRequests <= 0) {
+        return;
+    }
+
+    if (--_reducedQualityRequests == 0) {
+        update();
+    }
+}
 
+bool Scene::reducedQuality() const
+{
+    return _reducedQualityRequests > 0;
+}
+
+/**
+ * Returns the estimated size of a single item, excluding its children and the
+ * wire points which are accounted for separately.
+ */
+static std::size_t estimatedItemBytes(const Item& item)
+{
+    if (dynamic_cast<const Wire*>(&item)) {
+        return sizeof(Wire);
+    }
+    if (const auto label = dynamic_cast<const Label*>(&item)) {
+        return sizeof(Label) + label->text().size() * sizeof(QChar);
+    }
+    if (dynamic_cast<const Connector*>(&item)) {
+        return sizeof(Connector);
+    }
+    if (dynamic_cast<const Node*>(&item)) {
+        return sizeof(Node);
+    }
+
+    return sizeof(Item);
+}
+
+/**
+ * Returns the estimated size of the render cache of an item (if any).
+ */
+static std::size_t estimatedCacheBytes(const QGraphicsItem& item)
+{
+    if (item.cacheMode() == QGraphicsItem::NoCache) {
+        return 0;
+    }
+
+    const QRectF& rect = item.boundingRect();
+
+    return static_cast<std::size_t>(qCeil(rect.width()) * qCeil(rect.height()) * 4);
+}
+
+/**
+ * Recursively accounts for the child items (connectors, labels, ...) of an item.
+ */
+static void accountChildItems(Scene::MemoryStats& stats, const QGraphicsItem& parent)
+{
+    for (const QGraphicsItem* child : parent.childItems()) {
+        const Item* item = dynamic_cast<const Item*>(child);
+        if (!item) {
+            continue;
+        }
+
+        Scene::MemoryStats::Entry* entry;
+        if (dynamic_cast<const Label*>(item)) {
+            entry = &stats.labels;
+        } else if (dynamic_cast<const Connector*>(item)) {
+            entry = &stats.connectors;
+        } else {
+            entry = &stats.items[item->type()];
+        }
+        entry->count++;
+        entry->bytes += estimatedItemBytes(*item);
+
+        if (const auto cacheBytes = estimatedCacheBytes(*item)) {
+            stats.pixmaps.count++;
+            stats.pixmaps.bytes += cacheBytes;
+        }
+
+        accountChildItems(stats, *item);
+    }
+}
+
+/**
+ * Returns an estimate of the memory used by the scene. This only walks the
+ * existing data structures and is cheap enough to be polled periodically,
+ * eg. from a diagnostics panel.
+ */
+Scene::MemoryStats Scene::memoryStats() const
+{
+    MemoryStats stats;
+
+    // Items
+    for (const auto& item : _items) {
+        auto& entry = stats.items[item->type()];
+        entry.count++;
+        entry.bytes += estimatedItemBytes(*item);
+
+        if (const auto cacheBytes = estimatedCacheBytes(*item)) {
+            stats.pixmaps.count++;
+            stats.pixmaps.bytes += cacheBytes;
+        }
+
+        accountChildItems(stats, *item);
+    }
+
+    // Wire system
+    stats.wireSystem = m_wire_manager->memory_stats();
+    stats.wirePoints.count = stats.wireSystem.points;
+    stats.wirePoints.bytes = stats.wireSystem.points * sizeof(wire_system::point);
+
+    // Nets (including the labels of nets that are not attached to a wire)
+    for (const auto& net : m_wire_manager->nets()) {
+        auto wireNet = std::dynamic_pointer_cast<WireNet>(net);
+        if (!wireNet) {
+            continue;
+        }
+
+        stats.nets.count++;
+        stats.nets.bytes += sizeof(WireNet);
+
+        const auto& label = wireNet->label();
+        if (label && !label->parentItem()) {
+            stats.labels.count++;
+            stats.labels.bytes += estimatedItemBytes(*label);
+        }
+    }
+
+    // Background
+    if (!_backgroundPixmap.isNull()) {
+        stats.pixmaps.count++;
+        stats.pixmaps.bytes += static_cast<std::size_t>(_backgroundPixmap.width()) * _backgroundPixmap.height() * _backgroundPixmap.depth() / 8;
+    }
+
+    // Undo stack
+    for (int i = 0; i < _undoStack->count(); i++) {
+        const QUndoCommand* command = _undoStack->command(i);
+        stats.undoCommands.count++;
+        stats.undoCommands.bytes += (1 + command->childCount()) * sizeof(UndoCommand);
+    }
+
+    // Items kept alive until the event loop is done with them
+    for (const auto& item : _keep_alive_an_event_loop) {
+        stats.pendingReclamation.count++;
+        stats.pendingReclamation.bytes += estimatedItemBytes(*item);
+    }
+
+    return stats;
+}
@@ -4,6 +4,7 @@
 #include <memory>
 #include <functional>
 #include <QGraphicsScene>
+#include <QHash>
 #include <QUndoStack>
 #ifdef USE_GPDS
 #include <gpds/serialize.hpp>
@@ -12,14 +13,22 @@
 #include "settings.h"
 #include "items/item.h"
 #include "items/wire.h"
+#include "layer.h"
 #include "qschematic_export.h"
 //#include "utils/itemscustodian.h"
 
+class QMimeData;
+
 namespace QSchematic {
 
     class Node;
     class Connector;
+    class BusRipper;
     class WireNet;
+    class BlockLibrary;
+    class CollisionService;
+    class SceneExtents;
+    class SnapEngine;
 
     class QSCHEMATIC_EXPORT Scene :
         public QGraphicsScene
@@ -39,6 +48,42 @@ namespace QSchematic {
         };
         Q_ENUM(Mode)
 
+        /**
+         * Approximate memory footprint of the scene. Byte counts are estimates
+         * based on the size of the objects and the buffers they own.
+         * The wire system breakdown is informational and not part of totalBytes().
+         */
+        struct MemoryStats
+        {
+            struct Entry
+            {
+                std::size_t count = 0;
+                std::size_t bytes = 0;
+            };
+
+            QMap<int, Entry> items;         // Keyed by Item::type()
+            Entry labels;
+            Entry connectors;
+            Entry wirePoints;
+            Entry nets;
+            Entry pixmaps;
+            Entry undoCommands;
+            Entry pendingReclamation;
+            wire_system::memory_usage wireSystem;
+
+            std::size_t totalBytes() const
+            {
+                std::size_t total = 0;
+                for (const auto& entry : items) {
+                    total += entry.bytes;
+                }
+                for (const auto& entry : { labels, connectors, wirePoints, nets, pixmaps, undoCommands, pendingReclamation }) {
+                    total += entry.bytes;
+                }
+                return total;
+            }
+        };
+
         explicit Scene(QObject* parent = nullptr);
         virtual ~Scene() override = default;
 
@@ -59,6 +104,7 @@ namespace QSchematic {
         void clear();
         bool addItem(const std::shared_ptr<Item>& item);
         bool removeItem(const std::shared_ptr<Item> item);
+        int removeItems(const QVector<std::shared_ptr<Item>>& items);
         QList<std::shared_ptr<Item>> items() const;
         QList<std::shared_ptr<Item>> items(int itemType) const;
 
@@ -91,7 +137,11 @@ namespace QSchematic {
         [[nodiscard]] std::shared_ptr<Node> nodeFromConnector(const QSchematic::Connector& connector) const;
         QList<QPointF> connectionPoints() const;
         QList<std::shared_ptr<Connector>> connectors() const;
+        QList<std::shared_ptr<BusRipper>> busRippers(const QString& member) const;
         std::shared_ptr<wire_system::manager> wire_manager() const;
+        std::shared_ptr<CollisionService> collisionService() const;
+        std::shared_ptr<SceneExtents> sceneExtents() const;
+        std::shared_ptr<SnapEngine> snapEngine() const;
         void itemHoverEnter(const std::shared_ptr<const Item>& item);
         void itemHoverLeave(const std::shared_ptr<const Item>& item);
         void removeLastWirePoint();
@@ -99,6 +149,27 @@ namespace QSchematic {
         bool addWire(const std::shared_ptr<Wire>& wire);
         bool removeWire(const std::shared_ptr<Wire>& wire);
         QList<std::shared_ptr<WireNet>> nets(const std::shared_ptr<net> wireNet) const;
+        int compactNets(const std::shared_ptr<WireNet>& net = nullptr);
+        QMimeData* copySelection() const;
+        int paste(const QMimeData* mimeData, const QPointF& offset);
+        MemoryStats memoryStats() const;
+        std::shared_ptr<BlockLibrary> blockLibrary() const;
+        std::shared_ptr<Layer> addLayer(const QString& name);
+        bool removeLayer(const QString& name);
+        std::shared_ptr<Layer> layer(const QString& name) const;
+        QList<std::shared_ptr<Layer>> layers() const;
+        void setLayerForType(int itemType, const std::shared_ptr<Layer>& layer);
+        std::shared_ptr<Layer> layerForType(int itemType) const;
+        void setLayerState(const std::shared_ptr<Layer>& layer, const Layer::State& state);
+        void setLayerVisible(const std::shared_ptr<Layer>& layer, bool visible);
+        void setLayerLocked(const std::shared_ptr<Layer>& layer, bool locked);
+        void setLayerOpacity(const std::shared_ptr<Layer>& layer, qreal opacity);
+        void applyLayers();
+        void countHitTest() const;
+        int hitTestsLastMouseEvent() const;
+        void acquireReducedQuality();
+        void releaseReducedQuality();
+        bool reducedQuality() const;
 
         void undo();
         void redo();
@@ -121,18 +192,32 @@ namespace QSchematic {
         virtual void dragLeaveEvent(QGraphicsSceneDragDropEvent* event) override;
         virtual void dropEvent(QGraphicsSceneDragDropEvent* event) override;
         virtual void drawBackground(QPainter* painter, const QRectF& rect) override;
+        virtual void drawForeground(QPainter* painter, const QRectF& rect) override;
 
         /* This gets called just before the item is actually being moved by moveBy. Subclasses may
-         * implement this to implement snapping to elements other than the grid
+         * implement this to implement snapping to elements other than the grid.
+         * The default implementation applies the magnetic snapping of the SnapEngine and the offset
+         * that keeps the dragged nodes from overlapping if Settings::preventNodeOverlap is set.
          */
         virtual QVector2D itemsMoveSnap(const std::shared_ptr<Item>& item, const QVector2D& moveBy) const;
 
     private:
+        friend class BlockDefinition;
+
+        void setOuterBlockLibrary(const std::weak_ptr<BlockLibrary>& library);
         void renderCachedBackground();
+        void updateAutoSceneRect();
         void setupNewItem(Item& item);
+        QRectF takeOutItem(const std::shared_ptr<Item>& item);
         std::shared_ptr<Item> sharedItemPointer(const Item& item) const;
         void generateConnections();
         void finishCurrentWire();
+        void discardCurrentWire();
+        QVector<QPointF> newWireSegment(const QPointF& from, const QPointF& to) const;
+        void updateNewWirePreview(const QPointF& cursor);
+        QVector2D dragCollisionOffset(const QVector<std::shared_ptr<Item>>& items, const QPointF& moveBy) const;
+        std::shared_ptr<Connector> connectorAt(const QPointF& point) const;
+        bool isWireEndpointTarget(const QPointF& point) const;
 
         // TODO add to "central" sh-ptr management
         QList<std::shared_ptr<Item>> _keep_alive_an_event_loop;
@@ -156,8 +241,8 @@ namespace QSchematic {
         QPixmap _backgroundPixmap;
         std::function<std::shared_ptr<Wire>()> _wireFactory;
         int _mode;
-        std::shared_ptr<Wire> _newWire;
-        bool _newWireSegment;
+        QVector<QPointF> _newWirePoints;                     // Clicked so far, in scene coordinates
+        QVector<QPointF> _newWirePreview;                    // From the last clicked point to the cursor
         bool _invertWirePosture;
         bool _movingNodes;
         QPointF _lastMousePos;
@@ -165,11 +250,25 @@ namespace QSchematic {
         QPointF _initialCursorPosition;
         QUndoStack* _undoStack;
         std::shared_ptr<wire_system::manager> m_wire_manager;
+        std::shared_ptr<CollisionService> _collisionService;
+        std::shared_ptr<SceneExtents> _sceneExtents;
+        std::shared_ptr<SnapEngine> _snapEngine;
+        QVector2D _snapOffset;                               // Of the current drag, same for all items
+        QVector2D _collisionOffset;                          // Of the current drag, same for all items
         Item* _highlightedItem;
+        mutable int _hitTests;
+        int _hitTestsLastMouseEvent;
+        int _reducedQualityRequests;                         // Views with an interaction in progress
+        std::shared_ptr<BlockLibrary> _blockLibrary;         // Serialized with the scene
+        std::weak_ptr<BlockLibrary> _outerBlockLibrary;      // Of the scene this sub-scene belongs to
+        QList<std::shared_ptr<Layer>> _layers;
+        QHash<int, std::shared_ptr<Layer>> _layersByType;    // Keyed by Item::type()
+        QMultiHash<QString, BusRipper*> _busRippers;         // Keyed by the tapped member
 
     private slots:
         void updateNodeConnections(const Node* node) const;
         void wirePointMoved(wire& rawWire, int index);
+        void busRipperMemberChanged(const QString& previousMember);
     };
 
 }
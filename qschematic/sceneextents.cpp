@@ -0,0 +1,150 @@
+#include "sceneextents.h"
+#include "items/item.h"
+#include "items/node.h"
+#include "items/wire.h"
+
+using namespace QSchematic;
+
+SceneExtents::SceneExtents(QObject* parent) :
+    QObject(parent),
+    _tree(_settings.gridSize)
+{
+}
+
+void SceneExtents::setSettings(const Settings& settings)
+{
+    _settings = settings;
+
+    // Rebuild the tree with the new margin
+    _tree = AabbTree<Item*>(_settings.gridSize);
+    for (auto it = _proxies.begin(); it != _proxies.end(); ++it) {
+        Item* item = const_cast<Item*>(it.key());
+        it.value() = _tree.insert(sceneRect(*item), item);
+    }
+
+    checkBounds();
+}
+
+void SceneExtents::addItem(const std::shared_ptr<Item>& item)
+{
+    // Sanity check
+    if (!item || _proxies.contains(item.get())) {
+        return;
+    }
+
+    _proxies.insert(item.get(), _tree.insert(sceneRect(*item), item.get()));
+
+    // Keep track of the item geometry
+    Item* rawItem = item.get();
+    auto update = [this, rawItem] {
+        updateItem(*rawItem);
+    };
+    connect(rawItem, &Item::movedInScene, this, update);
+    connect(rawItem, &Item::rotated, this, update);
+    if (auto node = qobject_cast<Node*>(rawItem)) {
+        connect(node, &Node::sizeChanged, this, update);
+    }
+    if (auto wire = qobject_cast<Wire*>(rawItem)) {
+        connect(wire, &Wire::pointMoved, this, update);
+    }
+
+    // Children (eg. labels) can be moved on their own
+    for (QGraphicsItem* child : rawItem->childItems()) {
+        if (auto childItem = dynamic_cast<Item*>(child)) {
+            connect(childItem, &Item::moved, this, update);
+        }
+    }
+
+    checkBounds();
+}
+
+void SceneExtents::removeItem(const std::shared_ptr<Item>& item)
+{
+    // Sanity check
+    if (!item || !_proxies.contains(item.get())) {
+        return;
+    }
+
+    _tree.remove(_proxies.take(item.get()));
+    disconnect(item.get(), nullptr, this, nullptr);
+    for (QGraphicsItem* child : item->childItems()) {
+        if (auto childItem = dynamic_cast<Item*>(child)) {
+            disconnect(childItem, nullptr, this, nullptr);
+        }
+    }
+
+    checkBounds();
+}
+
+void SceneExtents::clear()
+{
+    for (auto it = _proxies.cbegin(); it != _proxies.cend(); ++it) {
+        disconnect(const_cast<Item*>(it.key()), nullptr, this, nullptr);
+    }
+    _proxies.clear();
+    _tree.clear();
+
+    checkBounds();
+}
+
+int SceneExtents::count() const
+{
+    return _tree.count();
+}
+
+/**
+ * Returns the area covered by the items in O(1). The rect may exceed the
+ * content by up to twice the grid size, it is null if there are no items.
+ */
+QRectF SceneExtents::bounds() const
+{
+    return _bounds;
+}
+
+/**
+ * Returns the top-level items whose scene rect (including their children)
+ * intersects the rectangle. Unlike QGraphicsScene::items() this doesn't depend
+ * on the item index method of the scene.
+ */
+QList<Item*> SceneExtents::items(const QRectF& rect) const
+{
+    QList<Item*> items;
+    _tree.query(rect, [&](AabbTree<Item*>::Proxy proxy) {
+        Item* item = _tree.data(proxy);
+        if (sceneRect(*item).intersects(rect)) {
+            items << item;
+        }
+        return true;
+    });
+
+    return items;
+}
+
+QRectF SceneExtents::sceneRect(const Item& item)
+{
+    return item.mapRectToScene(item.boundingRect() | item.childrenBoundingRect());
+}
+
+void SceneExtents::updateItem(const Item& item)
+{
+    const auto proxy = _proxies.value(&item, AabbTree<Item*>::NullProxy);
+    if (proxy == AabbTree<Item*>::NullProxy) {
+        return;
+    }
+
+    // The bounds only change if the item left its fat rect
+    if (_tree.update(proxy, sceneRect(item))) {
+        checkBounds();
+    }
+}
+
+void SceneExtents::checkBounds()
+{
+    const QRectF& bounds = _tree.bounds();
+    if (bounds == _bounds) {
+        return;
+    }
+
+    _bounds = bounds;
+    emit boundsChanged(_bounds);
+}
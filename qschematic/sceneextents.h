@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRectF>
+#include "settings.h"
+#include "utils/aabbtree.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Item;
+
+    /**
+     * Keeps track of the area covered by the top-level items of a scene. The
+     * scene rects of the items (including their children) are kept in a
+     * dynamic AABB tree whose root holds the extent of the content, so it is
+     * available in O(1) instead of iterating over all items.
+     */
+    class QSCHEMATIC_EXPORT SceneExtents :
+        public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(SceneExtents)
+
+    public:
+        explicit SceneExtents(QObject* parent = nullptr);
+        virtual ~SceneExtents() override = default;
+
+        void setSettings(const Settings& settings);
+        void addItem(const std::shared_ptr<Item>& item);
+        void removeItem(const std::shared_ptr<Item>& item);
+        void clear();
+        int count() const;
+        QRectF bounds() const;
+        QList<Item*> items(const QRectF& rect) const;
+
+        static QRectF sceneRect(const Item& item);
+
+    signals:
+        void boundsChanged(const QRectF& bounds);
+
+    private:
+        void updateItem(const Item& item);
+        void checkBounds();
+
+        Settings _settings;
+        AabbTree<Item*> _tree;
+        QHash<const Item*, AabbTree<Item*>::Proxy> _proxies;
+        QRectF _bounds;
+    };
+
+}
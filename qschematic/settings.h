@@ -23,6 +23,15 @@ namespace QSchematic {
         bool routeStraightAngles    = true;
         bool preserveStraightAngles = true;
         bool antialiasing           = true;
+        bool preventNodeOverlap     = false;
+        bool compactNetsOnLoad      = false;
+        bool autoSceneRect          = false;
+
+        // Reduced render quality while panning, zooming or dragging
+        bool adaptiveQuality        = false;
+        int adaptiveQualityIdleMs   = 150;  // Full quality is restored after this period without interaction
+        int adaptiveQualityFrameMs  = 8;    // Only reduce if the last full quality frame took at least this long
+        int adaptiveQualityTextSize = 8;    // Text smaller than this (in device pixels) is drawn as a box
 
         // Construction
         Settings() = default;
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <QSet>
+#include "snapengine.h"
+#include "scene.h"
+#include "items/node.h"
+#include "items/connector.h"
+#include "items/wire.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    bool isBetter(const SnapIndex::Candidate& candidate, const SnapIndex::Candidate& best, bool haveBest)
+    {
+        if (!haveBest) {
+            return true;
+        }
+
+        if (candidate.priority != best.priority) {
+            return candidate.priority > best.priority;
+        }
+
+        return candidate.distance < best.distance;
+    }
+
+}
+
+void SnapEngine::setConfig(const Config& config)
+{
+    _config = config;
+}
+
+const SnapEngine::Config& SnapEngine::config() const
+{
+    return _config;
+}
+
+/**
+ * Prepares snapping for a drag of the given (top-level) items.
+ */
+void SnapEngine::begin(const Scene& scene, const QList<std::shared_ptr<Item>>& movingItems)
+{
+    end();
+
+    if (!_config.enabled) {
+        return;
+    }
+
+    QSet<const Item*> moving;
+    for (const auto& item : movingItems) {
+        moving << item.get();
+    }
+
+    // Sources
+    for (const auto& item : movingItems) {
+        if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+            for (const auto& connector : node->connectors()) {
+                _sourcePoints.push_back(connector->scenePos());
+            }
+
+            const QRectF& rect = node->mapRectToScene(node->sizeRect());
+            _sourceVerticalEdges.push_back({ rect.left(), rect.top(), rect.bottom() });
+            _sourceVerticalEdges.push_back({ rect.right(), rect.top(), rect.bottom() });
+            _sourceHorizontalEdges.push_back({ rect.top(), rect.left(), rect.right() });
+            _sourceHorizontalEdges.push_back({ rect.bottom(), rect.left(), rect.right() });
+        } else if (auto wire = std::dynamic_pointer_cast<Wire>(item)) {
+            const auto& points = wire->pointsAbsolute();
+            if (!points.isEmpty()) {
+                _sourcePoints.push_back(points.first());
+                _sourcePoints.push_back(points.last());
+            }
+        }
+    }
+
+    // Targets
+    _index = SnapIndex(_config.radius);
+    for (const auto& node : scene.nodes()) {
+        if (moving.contains(node.get())) {
+            continue;
+        }
+
+        for (const auto& connector : node->connectors()) {
+            _index.addPoint(connector->scenePos(), _config.connectorPriority);
+        }
+
+        const QRectF& rect = node->mapRectToScene(node->sizeRect());
+        _index.addVerticalEdge(rect.left(), rect.top(), rect.bottom(), _config.nodeEdgePriority);
+        _index.addVerticalEdge(rect.right(), rect.top(), rect.bottom(), _config.nodeEdgePriority);
+        _index.addHorizontalEdge(rect.top(), rect.left(), rect.right(), _config.nodeEdgePriority);
+        _index.addHorizontalEdge(rect.bottom(), rect.left(), rect.right(), _config.nodeEdgePriority);
+    }
+    for (const auto& rawWire : scene.wire_manager()->wires()) {
+        auto wire = std::dynamic_pointer_cast<Wire>(rawWire);
+        if (!wire || moving.contains(wire.get())) {
+            continue;
+        }
+
+        const auto& points = wire->pointsAbsolute();
+        if (points.isEmpty()) {
+            continue;
+        }
+
+        for (const QPointF& point : { points.first(), points.last() }) {
+            // Ends attached to a dragged item move along, don't snap to them
+            if (std::find(_sourcePoints.cbegin(), _sourcePoints.cend(), point) != _sourcePoints.cend()) {
+                continue;
+            }
+            _index.addPoint(point, _config.wireEndPriority);
+        }
+    }
+    _index.finalize();
+
+    _active = true;
+}
+
+/**
+ * Returns the offset to add to moveBy (the translation of all dragged items
+ * relative to where the drag started) so that the best candidate snaps.
+ */
+QVector2D SnapEngine::snap(const QVector2D& moveBy) const
+{
+    if (!_active) {
+        return { };
+    }
+
+    const QPointF& delta = moveBy.toPointF();
+    SnapIndex::Candidate best;
+    bool haveBest = false;
+    bool bestIsEdge = false;
+
+    // Points
+    for (const QPointF& source : _sourcePoints) {
+        _index.nearestPoints(source + delta, _config.radius, _config.k, _candidates);
+        for (const auto& candidate : _candidates) {
+            if (isBetter(candidate, best, haveBest)) {
+                best = candidate;
+                haveBest = true;
+                bestIsEdge = false;
+            }
+        }
+    }
+
+    // Edges
+    SnapIndex::Candidate bestVertical;
+    SnapIndex::Candidate bestHorizontal;
+    bool haveVertical = false;
+    bool haveHorizontal = false;
+    SnapIndex::Candidate candidate;
+    for (const auto& edge : _sourceVerticalEdges) {
+        if (_index.nearestVerticalEdge(edge.position + delta.x(), edge.from + delta.y(), edge.to + delta.y(), _config.radius, candidate) &&
+            isBetter(candidate, bestVertical, haveVertical)) {
+            bestVertical = candidate;
+            haveVertical = true;
+        }
+    }
+    for (const auto& edge : _sourceHorizontalEdges) {
+        if (_index.nearestHorizontalEdge(edge.position + delta.y(), edge.from + delta.x(), edge.to + delta.x(), _config.radius, candidate) &&
+            isBetter(candidate, bestHorizontal, haveHorizontal)) {
+            bestHorizontal = candidate;
+            haveHorizontal = true;
+        }
+    }
+    for (const auto* edgeCandidate : { haveVertical ? &bestVertical : nullptr, haveHorizontal ? &bestHorizontal : nullptr }) {
+        if (edgeCandidate && isBetter(*edgeCandidate, best, haveBest)) {
+            best = *edgeCandidate;
+            haveBest = true;
+            bestIsEdge = true;
+        }
+    }
+
+    if (!haveBest) {
+        return { };
+    }
+
+    // Edges snap along one axis only, align the other axis too if possible
+    if (bestIsEdge) {
+        return QVector2D((haveVertical ? bestVertical.offset : QPointF()) + (haveHorizontal ? bestHorizontal.offset : QPointF()));
+    }
+
+    return QVector2D(best.offset);
+}
+
+void SnapEngine::end()
+{
+    _active = false;
+    _index.clear();
+    _sourcePoints.clear();
+    _sourceVerticalEdges.clear();
+    _sourceHorizontalEdges.clear();
+}
+
+bool SnapEngine::isActive() const
+{
+    return _active;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QList>
+#include <QPointF>
+#include <QVector2D>
+#include "utils/snapindex.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Scene;
+    class Item;
+
+    /**
+     * Magnetic snapping of dragged items to connectors, wire ends and node edges.
+     *
+     * When a drag starts the targets of all items that are not being dragged are
+     * put into a SnapIndex. On every mouse move the sources of the dragged items
+     * (their connectors, wire ends and node edges) are looked up in the index and
+     * the single best offset is applied to all dragged items, so the cost per move
+     * depends on the number of dragged items only.
+     */
+    class QSCHEMATIC_EXPORT SnapEngine
+    {
+    public:
+        struct Config
+        {
+            bool enabled = false;
+            qreal radius = 10;              // In scene coordinates
+            std::size_t k = 4;              // Candidates per source point
+            int connectorPriority = 2;      // Higher priorities win over closer targets
+            int wireEndPriority = 1;
+            int nodeEdgePriority = 0;
+        };
+
+        SnapEngine() = default;
+        SnapEngine(const SnapEngine& other) = delete;
+        SnapEngine(SnapEngine&& other) = delete;
+        virtual ~SnapEngine() = default;
+
+        SnapEngine& operator=(const SnapEngine& rhs) = delete;
+        SnapEngine& operator=(SnapEngine&& rhs) = delete;
+
+        void setConfig(const Config& config);
+        const Config& config() const;
+        void begin(const Scene& scene, const QList<std::shared_ptr<Item>>& movingItems);
+        QVector2D snap(const QVector2D& moveBy) const;
+        void end();
+        bool isActive() const;
+
+    private:
+        struct SourceEdge
+        {
+            qreal position;
+            qreal from;
+            qreal to;
+        };
+
+        Config _config;
+        bool _active = false;
+        SnapIndex _index;
+        std::vector<QPointF> _sourcePoints;
+        std::vector<SourceEdge> _sourceVerticalEdges;
+        std::vector<SourceEdge> _sourceHorizontalEdges;
+        mutable std::vector<SnapIndex::Candidate> _candidates;
+    };
+
+}
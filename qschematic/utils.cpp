@@ -1,12 +1,17 @@
+#include <algorithm>
 #include <limits>
 #include <QPoint>
 #include <QLine>
 #include <QRectF>
 #include <QPainterPath>
+#include <QRegularExpression>
+#include <QStringList>
 #include <QVector2D>
 #include "wire_system/line.h"
 #include "utils.h"
 
+const int BUS_WIDTH_MAX = 4096;
+
 using namespace QSchematic;
 
 QPoint Utils::centerPoint(const QPoint& p1, const QPoint& p2)
@@ -143,3 +148,130 @@ bool Utils::pointIsOnLine(const QLineF& line, const QPointF& point)
     return qFuzzyCompare(dotProduct, absProduct);
 }
 
+/**
+ * Returns the squared distance between the point and the line segment.
+ */
+qreal Utils::distanceToLineSquared(const QLineF& line, const QPointF& point)
+{
+    const qreal dx = line.dx();
+    const qreal dy = line.dy();
+    const qreal lengthSquared = dx * dx + dy * dy;
+
+    // Parameter of the projection, clamped to the segment
+    qreal t = 0;
+    if (lengthSquared > 0) {
+        t = ((point.x() - line.x1()) * dx + (point.y() - line.y1()) * dy) / lengthSquared;
+        t = std::clamp(t, qreal(0), qreal(1));
+    }
+
+    const qreal x = line.x1() + t * dx - point.x();
+    const qreal y = line.y1() + t * dy - point.y();
+
+    return x * x + y * y;
+}
+
+/**
+ * Returns the squared distance between two line segments, 0 if they intersect.
+ */
+qreal Utils::distanceBetweenLinesSquared(const QLineF& line1, const QLineF& line2)
+{
+    // Orientation of c relative to a->b
+    auto cross = [](const QPointF& a, const QPointF& b, const QPointF& c) {
+        return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+    };
+
+    const qreal d1 = cross(line1.p1(), line1.p2(), line2.p1());
+    const qreal d2 = cross(line1.p1(), line1.p2(), line2.p2());
+    const qreal d3 = cross(line2.p1(), line2.p2(), line1.p1());
+    const qreal d4 = cross(line2.p1(), line2.p2(), line1.p2());
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+        return 0;
+    }
+
+    // Otherwise the closest points include an end point (also covers touching and collinear lines)
+    return std::min({
+        distanceToLineSquared(line1, line2.p1()),
+        distanceToLineSquared(line1, line2.p2()),
+        distanceToLineSquared(line2, line1.p1()),
+        distanceToLineSquared(line2, line1.p2())
+    });
+}
+
+/**
+ * Returns whether any part of the line segment is inside the rectangle (including
+ * its edges). Based on the Liang-Barsky clipping algorithm.
+ */
+bool Utils::lineIntersectsRect(const QLineF& line, const QRectF& rect)
+{
+    const QRectF& r = rect.normalized();
+    const qreal dx = line.dx();
+    const qreal dy = line.dy();
+    const qreal p[4] = { -dx, dx, -dy, dy };
+    const qreal q[4] = { line.x1() - r.left(), r.right() - line.x1(), line.y1() - r.top(), r.bottom() - line.y1() };
+
+    qreal t0 = 0;
+    qreal t1 = 1;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            // Parallel to this edge and outside of it
+            if (q[i] < 0) {
+                return false;
+            }
+            continue;
+        }
+
+        const qreal t = q[i] / p[i];
+        if (p[i] < 0) {
+            if (t > t1) {
+                return false;
+            }
+            t0 = std::max(t0, t);
+        } else {
+            if (t < t0) {
+                return false;
+            }
+            t1 = std::min(t1, t);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Expands a bus name into the names of its members. Ranges are written as
+ * "D[63:0]" (D63, D62, ..., D0) and several parts can be separated by commas,
+ * eg. "CLK,D[1:0]". A name without a range is a single member.
+ */
+QStringList Utils::busMembers(const QString& busName)
+{
+    static const QRegularExpression rangeExpression(QStringLiteral("^(.*)\\[(\\d+):(\\d+)\\]$"));
+
+    QStringList members;
+    for (const QString& part : busName.split(QLatin1Char(','))) {
+        const QString& name = part.trimmed();
+        if (name.isEmpty()) {
+            continue;
+        }
+
+        // Single member
+        const QRegularExpressionMatch& match = rangeExpression.match(name);
+        const int from = match.captured(2).toInt();
+        const int to = match.captured(3).toInt();
+        if (!match.hasMatch() || qAbs(to - from) >= BUS_WIDTH_MAX) {
+            members << name;
+            continue;
+        }
+
+        // Range
+        const QString& prefix = match.captured(1);
+        const int step = from > to ? -1 : 1;
+        for (int i = from; ; i += step) {
+            members << prefix + QString::number(i);
+            if (i == to) {
+                break;
+            }
+        }
+    }
+
+    return members;
+}
@@ -8,6 +8,8 @@ class QPointF;
 class QLineF;
 class QRectF;
 class QPainterPath;
+class QString;
+class QStringList;
 
 namespace QSchematic
 {
@@ -30,6 +32,10 @@ namespace QSchematic
         static bool lineIsHorizontal(const QPointF& p1, const QPointF& p2);
         static bool lineIsVertical(const QPointF& p1, const QPointF& p2);
         static bool pointIsOnLine(const QLineF& line, const QPointF& point);
+        static qreal distanceToLineSquared(const QLineF& line, const QPointF& point);
+        static qreal distanceBetweenLinesSquared(const QLineF& line1, const QLineF& line2);
+        static bool lineIntersectsRect(const QLineF& line, const QRectF& rect);
+        static QStringList busMembers(const QString& busName);
 
     private:
         Utils() = default;
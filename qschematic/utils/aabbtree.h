@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include <QRectF>
+
+namespace QSchematic
+{
+
+    /**
+     * Dynamic bounding volume hierarchy of axis aligned rectangles.
+     *
+     * Leaves store a "fat" rectangle enlarged by a margin so that small moves
+     * don't require restructuring the tree. Insertion picks the sibling with the
+     * lowest perimeter cost and the tree is kept balanced with rotations, giving
+     * O(log n) updates and queries.
+     * Proxies returned by insert() stay valid until they are removed.
+     */
+    template<typename T>
+    class AabbTree
+    {
+    public:
+        using Proxy = int;
+        static constexpr Proxy NullProxy = -1;
+
+        explicit AabbTree(qreal margin = 0) :
+            _margin(margin)
+        {
+        }
+
+        AabbTree(const AabbTree& other) = default;
+        AabbTree(AabbTree&& other) = default;
+        ~AabbTree() = default;
+
+        AabbTree& operator=(const AabbTree& rhs) = default;
+        AabbTree& operator=(AabbTree&& rhs) = default;
+
+        Proxy insert(const QRectF& rect, const T& data)
+        {
+            const Proxy proxy = allocateNode();
+            _nodes[proxy].rect = rect.adjusted(-_margin, -_margin, _margin, _margin);
+            _nodes[proxy].data = data;
+            _nodes[proxy].height = 0;
+            insertLeaf(proxy);
+            _count++;
+
+            return proxy;
+        }
+
+        void remove(Proxy proxy)
+        {
+            removeLeaf(proxy);
+            freeNode(proxy);
+            _count--;
+        }
+
+        /**
+         * Moves a proxy to a new rectangle. The tree only changes if the rectangle
+         * leaves the fat rectangle of the proxy or shrinks by more than the margin
+         * within it, so the fat rectangle never exceeds the rectangle by more than
+         * twice the margin. Returns whether it did.
+         */
+        bool update(Proxy proxy, const QRectF& rect)
+        {
+            const qreal slack = 2 * _margin;
+            const QRectF& fat = _nodes[proxy].rect;
+            if (contains(fat, rect) && contains(rect.adjusted(-slack, -slack, slack, slack), fat)) {
+                return false;
+            }
+
+            removeLeaf(proxy);
+            _nodes[proxy].rect = rect.adjusted(-_margin, -_margin, _margin, _margin);
+            insertLeaf(proxy);
+
+            return true;
+        }
+
+        const T& data(Proxy proxy) const
+        {
+            return _nodes[proxy].data;
+        }
+
+        const QRectF& fatRect(Proxy proxy) const
+        {
+            return _nodes[proxy].rect;
+        }
+
+        /**
+         * Calls callback(proxy) for every proxy whose fat rectangle intersects the
+         * given rectangle. The query stops once the callback returns false.
+         */
+        template<typename Callback>
+        void query(const QRectF& rect, Callback&& callback) const
+        {
+            if (_root == NullProxy) {
+                return;
+            }
+
+            std::vector<Proxy> stack;
+            stack.reserve(64);
+            stack.push_back(_root);
+            while (!stack.empty()) {
+                const Proxy index = stack.back();
+                stack.pop_back();
+
+                const TreeNode& node = _nodes[index];
+                if (!intersects(node.rect, rect)) {
+                    continue;
+                }
+
+                if (node.isLeaf()) {
+                    if (!callback(index)) {
+                        return;
+                    }
+                } else {
+                    stack.push_back(node.child1);
+                    stack.push_back(node.child2);
+                }
+            }
+        }
+
+        int count() const
+        {
+            return _count;
+        }
+
+        /**
+         * Returns the rectangle enclosing all proxies in O(1). It is based on the
+         * fat rectangles and therefore up to twice the margin larger than needed.
+         */
+        QRectF bounds() const
+        {
+            return _root == NullProxy ? QRectF() : _nodes[_root].rect;
+        }
+
+        int height() const
+        {
+            return _root == NullProxy ? 0 : _nodes[_root].height;
+        }
+
+        void clear()
+        {
+            _nodes.clear();
+            _root = NullProxy;
+            _freeList = NullProxy;
+            _count = 0;
+        }
+
+    private:
+        struct TreeNode
+        {
+            QRectF rect;
+            T data{};
+            Proxy parent = NullProxy;       // Next free node while in the free list
+            Proxy child1 = NullProxy;
+            Proxy child2 = NullProxy;
+            int height = -1;                // Leaves have height 0, free nodes -1
+
+            bool isLeaf() const
+            {
+                return child1 == NullProxy;
+            }
+        };
+
+        static bool intersects(const QRectF& a, const QRectF& b)
+        {
+            // Unlike QRectF::intersects() this also accepts degenerated (empty) rectangles
+            return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+        }
+
+        static bool contains(const QRectF& outer, const QRectF& inner)
+        {
+            return outer.left() <= inner.left() && outer.top() <= inner.top() && outer.right() >= inner.right() && outer.bottom() >= inner.bottom();
+        }
+
+        static QRectF united(const QRectF& a, const QRectF& b)
+        {
+            const qreal left = std::min(a.left(), b.left());
+            const qreal top = std::min(a.top(), b.top());
+            const qreal right = std::max(a.right(), b.right());
+            const qreal bottom = std::max(a.bottom(), b.bottom());
+
+            return QRectF(left, top, right - left, bottom - top);
+        }
+
+        static qreal perimeter(const QRectF& rect)
+        {
+            return 2 * (rect.width() + rect.height());
+        }
+
+        Proxy allocateNode()
+        {
+            if (_freeList == NullProxy) {
+                _nodes.emplace_back();
+                return static_cast<Proxy>(_nodes.size() - 1);
+            }
+
+            const Proxy proxy = _freeList;
+            _freeList = _nodes[proxy].parent;
+            _nodes[proxy] = TreeNode();
+
+            return proxy;
+        }
+
+        void freeNode(Proxy proxy)
+        {
+            _nodes[proxy] = TreeNode();
+            _nodes[proxy].parent = _freeList;
+            _freeList = proxy;
+        }
+
+        void insertLeaf(Proxy leaf)
+        {
+            if (_root == NullProxy) {
+                _root = leaf;
+                _nodes[leaf].parent = NullProxy;
+                return;
+            }
+
+            // Find the best sibling
+            const QRectF leafRect = _nodes[leaf].rect;
+            Proxy index = _root;
+            while (!_nodes[index].isLeaf()) {
+                const TreeNode& node = _nodes[index];
+                const qreal area = perimeter(node.rect);
+                const qreal combinedArea = perimeter(united(node.rect, leafRect));
+
+                // Cost of creating a new parent for this node and the new leaf
+                const qreal cost = 2 * combinedArea;
+
+                // Minimum cost of pushing the leaf further down the tree
+                const qreal inheritanceCost = 2 * (combinedArea - area);
+
+                auto descendCost = [&](Proxy child) {
+                    const qreal enlarged = perimeter(united(leafRect, _nodes[child].rect));
+                    if (_nodes[child].isLeaf()) {
+                        return enlarged + inheritanceCost;
+                    }
+                    return enlarged - perimeter(_nodes[child].rect) + inheritanceCost;
+                };
+                const qreal cost1 = descendCost(node.child1);
+                const qreal cost2 = descendCost(node.child2);
+
+                if (cost < cost1 && cost < cost2) {
+                    break;
+                }
+
+                index = cost1 < cost2 ? node.child1 : node.child2;
+            }
+            const Proxy sibling = index;
+
+            // Create a new parent
+            const Proxy oldParent = _nodes[sibling].parent;
+            const Proxy newParent = allocateNode();
+            _nodes[newParent].parent = oldParent;
+            _nodes[newParent].rect = united(leafRect, _nodes[sibling].rect);
+            _nodes[newParent].height = _nodes[sibling].height + 1;
+            _nodes[newParent].child1 = sibling;
+            _nodes[newParent].child2 = leaf;
+            _nodes[sibling].parent = newParent;
+            _nodes[leaf].parent = newParent;
+
+            if (oldParent == NullProxy) {
+                _root = newParent;
+            } else if (_nodes[oldParent].child1 == sibling) {
+                _nodes[oldParent].child1 = newParent;
+            } else {
+                _nodes[oldParent].child2 = newParent;
+            }
+
+            // Walk back up the tree fixing heights and rectangles
+            refit(_nodes[leaf].parent);
+        }
+
+        void removeLeaf(Proxy leaf)
+        {
+            if (leaf == _root) {
+                _root = NullProxy;
+                return;
+            }
+
+            const Proxy parent = _nodes[leaf].parent;
+            const Proxy grandParent = _nodes[parent].parent;
+            const Proxy sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+            if (grandParent == NullProxy) {
+                _root = sibling;
+                _nodes[sibling].parent = NullProxy;
+                freeNode(parent);
+                return;
+            }
+
+            // Connect the sibling to the grand parent and get rid of the parent
+            if (_nodes[grandParent].child1 == parent) {
+                _nodes[grandParent].child1 = sibling;
+            } else {
+                _nodes[grandParent].child2 = sibling;
+            }
+            _nodes[sibling].parent = grandParent;
+            freeNode(parent);
+
+            refit(grandParent);
+        }
+
+        void refit(Proxy index)
+        {
+            while (index != NullProxy) {
+                index = balance(index);
+
+                TreeNode& node = _nodes[index];
+                node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+                node.rect = united(_nodes[node.child1].rect, _nodes[node.child2].rect);
+
+                index = node.parent;
+            }
+        }
+
+        /**
+         * Performs a left or right rotation if the node is imbalanced.
+         * Returns the new root of the subtree.
+         */
+        Proxy balance(Proxy a)
+        {
+            if (_nodes[a].isLeaf() || _nodes[a].height < 2) {
+                return a;
+            }
+
+            const Proxy b = _nodes[a].child1;
+            const Proxy c = _nodes[a].child2;
+            const int heightDifference = _nodes[c].height - _nodes[b].height;
+
+            if (heightDifference > 1) {
+                return rotate(a, c, b, true);
+            }
+            if (heightDifference < -1) {
+                return rotate(a, b, c, false);
+            }
+
+            return a;
+        }
+
+        /**
+         * Promotes the higher child of a ("up") above a. "other" is the remaining
+         * child of a, "upIsChild2" tells which slot of a is occupied by "up".
+         */
+        Proxy rotate(Proxy a, Proxy up, Proxy other, bool upIsChild2)
+        {
+            const Proxy f = _nodes[up].child1;
+            const Proxy g = _nodes[up].child2;
+
+            // Swap a and up
+            _nodes[up].child1 = a;
+            _nodes[up].parent = _nodes[a].parent;
+            _nodes[a].parent = up;
+
+            // a's old parent should point to up
+            const Proxy upParent = _nodes[up].parent;
+            if (upParent == NullProxy) {
+                _root = up;
+            } else if (_nodes[upParent].child1 == a) {
+                _nodes[upParent].child1 = up;
+            } else {
+                _nodes[upParent].child2 = up;
+            }
+
+            // The higher grand child stays with up, the other one moves to a
+            const bool keepF = _nodes[f].height > _nodes[g].height;
+            const Proxy kept = keepF ? f : g;
+            const Proxy moved = keepF ? g : f;
+            _nodes[up].child2 = kept;
+            if (upIsChild2) {
+                _nodes[a].child2 = moved;
+            } else {
+                _nodes[a].child1 = moved;
+            }
+            _nodes[moved].parent = a;
+
+            _nodes[a].rect = united(_nodes[other].rect, _nodes[moved].rect);
+            _nodes[up].rect = united(_nodes[a].rect, _nodes[kept].rect);
+            _nodes[a].height = 1 + std::max(_nodes[other].height, _nodes[moved].height);
+            _nodes[up].height = 1 + std::max(_nodes[a].height, _nodes[kept].height);
+
+            return up;
+        }
+
+        qreal _margin;
+        std::vector<TreeNode> _nodes;
+        Proxy _root = NullProxy;
+        Proxy _freeList = NullProxy;
+        int _count = 0;
+    };
+
+}
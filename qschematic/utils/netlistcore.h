@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <QHash>
+#include <QPointF>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVector2D>
+#include "../utils.h"
+#include "../wire_system/connectable.h"
+#include "../wire_system/manager.h"
+#include "../wire_system/net.h"
+#include "../wire_system/wire.h"
+
+namespace QSchematic
+{
+
+    /**
+     * The connectivity part of netlisting. Both the NetlistGenerator of the
+     * Scene and the headless one group their nets through this, so that the
+     * same file always yields the same nets. Only the wire_system is used, the
+     * callers describe their buses and bus rippers through Buses and map the
+     * resulting wires and connectors back onto their own items.
+     *
+     * Wire nets sharing a name form one global net, unnamed wire nets get
+     * their own one named "N000", "N001" and so on. Nets made of bus wires only
+     * are skipped, the net attached to a bus ripper joins the tapped member.
+     * Callers which can look up bus rippers by member and bus wires by position
+     * provide Buses::rippersOf() and Buses::busesAt(), the bus wires and nets
+     * are scanned otherwise.
+     */
+    class NetlistCore
+    {
+    public:
+        struct Ripper
+        {
+            const wire_system::connectable* connector;
+            QString member;
+            QPointF tapPoint;
+        };
+
+        struct Buses
+        {
+            std::function<bool(const wire_system::wire& wire)> isBus;
+            std::function<std::optional<Ripper>(const wire_system::connectable& connector)> ripper;    // The bus ripper owning the connector
+            std::function<QVector<Ripper>(const QString& member)> rippersOf;                           // Optional index of the bus rippers by member
+            std::function<QVector<wire_system::wire*>(const QPointF& point)> busesAt;                 // Optional spatial lookup of the bus wires
+        };
+
+        struct GlobalNet
+        {
+            QString name;
+            QVector<const wire_system::wire*> wires;
+            QVector<const wire_system::connectable*> connectors;    // Attached to the wires, bus rippers excluded
+        };
+
+        // All nets
+        static QVector<GlobalNet> generate(wire_system::manager& manager, const Buses& buses)
+        {
+            QVector<GlobalNet> globalNets;
+            QHash<QString, int> namedNets;
+            unsigned anonNetCounter = 0;
+            for (const auto& net : manager.nets()) {
+                if (!net || isBusOnly(*net, buses)) {
+                    continue;
+                }
+
+                const QString& name = effectiveName(manager, *net, buses);
+                int index = globalNets.count();
+                if (name.isEmpty()) {
+                    globalNets.append(GlobalNet { anonName(anonNetCounter++), { }, { } });
+                } else if (auto it = namedNets.constFind(name); it != namedNets.constEnd()) {
+                    index = it.value();
+                } else {
+                    namedNets.insert(name, index);
+                    globalNets.append(GlobalNet { name, { }, { } });
+                }
+
+                addMembers(globalNets[index], manager, *net, buses);
+            }
+
+            return globalNets;
+        }
+
+        /**
+         * Only the nets containing one of the seeds. Named nets (and ripped bus
+         * members) include every wire net sharing the name, these are found
+         * through the name index of the manager and Buses::rippersOf() so the
+         * cost depends on the size of the nets rather than on the size of the
+         * scene. Unnamed nets are numbered within the result only.
+         */
+        static QVector<GlobalNet> generate(wire_system::manager& manager, const Buses& buses, const QVector<const wire_system::net*>& seeds)
+        {
+            QVector<GlobalNet> globalNets;
+            QSet<const wire_system::net*> visited;
+            QSet<QString> visitedNames;
+            unsigned anonNetCounter = 0;
+            for (const auto* net : seeds) {
+                if (!net || visited.contains(net) || isBusOnly(*net, buses)) {
+                    continue;
+                }
+                visited.insert(net);
+
+                const QString& name = effectiveName(manager, *net, buses);
+                if (name.isEmpty()) {
+                    GlobalNet globalNet { anonName(anonNetCounter++), { }, { } };
+                    addMembers(globalNet, manager, *net, buses);
+                    globalNets.append(globalNet);
+                    continue;
+                }
+                if (visitedNames.contains(name)) {
+                    continue;
+                }
+                visitedNames.insert(name);
+
+                GlobalNet globalNet { name, { }, { } };
+                for (const auto* other : netsNamed(manager, name, buses)) {
+                    visited.insert(other);
+                    addMembers(globalNet, manager, *other, buses);
+                }
+                globalNets.append(globalNet);
+            }
+
+            return globalNets;
+        }
+
+        // Buses don't form a net themselves, only their ripped members do
+        static bool isBusOnly(const wire_system::net& net, const Buses& buses)
+        {
+            if (!buses.isBus) {
+                return false;
+            }
+
+            const auto& wires = net.wires();
+            return !wires.isEmpty() && std::all_of(wires.cbegin(), wires.cend(), [&buses](const auto& wire) {
+                return wire && buses.isBus(*wire);
+            });
+        }
+
+        // Whether the point lies on the wire, in scene coordinates
+        static bool containsPoint(const wire_system::wire& wire, const QPointF& point, qreal tolerance = 0.5)
+        {
+            const auto& points = wire.points();
+            for (int i = 1; i < points.count(); i++) {
+                const QPointF& closest = Utils::pointOnLineClosestToPoint(points.at(i-1).toPointF(), points.at(i).toPointF(), point);
+                if (QVector2D(closest - point).length() <= tolerance) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Whether the bus ripper sits on a bus which has its member
+        static bool taps(const wire_system::manager& manager, const Ripper& ripper, const Buses& buses)
+        {
+            if (!buses.isBus) {
+                return false;
+            }
+
+            auto tapsBus = [&ripper, &buses](wire_system::wire& bus) {
+                return buses.isBus(bus) && bus.net() && containsPoint(bus, ripper.tapPoint) && Utils::busMembers(bus.net()->name()).contains(ripper.member);
+            };
+
+            if (buses.busesAt) {
+                const auto& candidates = buses.busesAt(ripper.tapPoint);
+                return std::any_of(candidates.cbegin(), candidates.cend(), [&tapsBus](wire_system::wire* bus) {
+                    return bus && tapsBus(*bus);
+                });
+            }
+
+            for (const auto& wire : manager.wires()) {
+                if (wire && tapsBus(*wire)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // The net attached to a bus ripper becomes part of the tapped bus member
+        static QString effectiveName(const wire_system::manager& manager, const wire_system::net& net, const Buses& buses)
+        {
+            if (buses.ripper) {
+                for (const auto& wire : net.wires()) {
+                    for (const auto* connector : manager.attached_connectors(wire.get())) {
+                        const auto& ripper = buses.ripper(*connector);
+                        if (ripper && taps(manager, *ripper, buses)) {
+                            return ripper->member;
+                        }
+                    }
+                }
+            }
+
+            return net.name();
+        }
+
+        // The nets whose effective name is the given one
+        static QVector<const wire_system::net*> netsNamed(wire_system::manager& manager, const QString& name, const Buses& buses)
+        {
+            QVector<const wire_system::net*> nets;
+            auto add = [&](const wire_system::net* net) {
+                if (net && !nets.contains(net) && !isBusOnly(*net, buses) && effectiveName(manager, *net, buses) == name) {
+                    nets.append(net);
+                }
+            };
+
+            // Named ones, a named net may still be ripped into another member
+            for (const auto* net : manager.nets_named(name)) {
+                add(net);
+            }
+
+            // Ripped ones
+            if (buses.rippersOf) {
+                for (const Ripper& ripper : buses.rippersOf(name)) {
+                    auto* wire = ripper.connector ? manager.attached_wire(ripper.connector) : nullptr;
+                    if (wire && taps(manager, ripper, buses)) {
+                        add(wire->net().get());
+                    }
+                }
+            } else if (buses.ripper) {
+                for (const auto& net : manager.nets()) {
+                    if (net && net->name() != name) {
+                        add(net.get());
+                    }
+                }
+            }
+
+            return nets;
+        }
+
+    private:
+        static QString anonName(unsigned index)
+        {
+            return QString("N%1").arg(index, 3, 10, QChar('0'));
+        }
+
+        static void addMembers(GlobalNet& globalNet, const wire_system::manager& manager, const wire_system::net& net, const Buses& buses)
+        {
+            for (const auto& wire : net.wires()) {
+                if (!wire) {
+                    continue;
+                }
+                globalNet.wires.append(wire.get());
+
+                // Only the connectors attached to the wires of the net are visited
+                for (const auto* connector : manager.attached_connectors(wire.get())) {
+                    if (!buses.ripper || !buses.ripper(*connector)) {
+                        globalNet.connectors.append(connector);
+                    }
+                }
+            }
+        }
+    };
+
+}
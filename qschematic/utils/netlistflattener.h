@@ -0,0 +1,172 @@
+#pragma once
+
+#include <functional>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "../blockdefinition.h"
+
+namespace QSchematic
+{
+
+    /**
+     * A net of the flattened hierarchy. Pins are named by their hierarchical
+     * path, eg. "U1/U3/N2.A" is connector "A" of the third node inside instance
+     * "U3" inside instance "U1".
+     */
+    struct FlatNet
+    {
+        QString name;
+        QStringList pins;
+    };
+
+    using FlatNetlist = QVector<FlatNet>;
+
+    /**
+     * Flattens the subnets of a hierarchy of block definitions into a single
+     * netlist. The definitions are looked up by name. Flattening fails if a
+     * definition is missing, if a definition instantiates itself (directly or
+     * further down) or if the hierarchy is deeper than the maximum depth, the
+     * netlist is empty in that case.
+     */
+    class NetlistFlattener
+    {
+    public:
+        using Lookup = std::function<const BlockDefinition::Subnets*(const QString& definition)>;
+
+        static bool flatten(FlatNetlist& netlist, const BlockDefinition::Subnets& top, const Lookup& lookup, int maxDepth)
+        {
+            netlist.clear();
+
+            NetlistFlattener flattener(lookup, maxDepth);
+            if (!flattener.instantiate(top, QString(), { })) {
+                return false;
+            }
+
+            // Collect the pins of every set of merged nets
+            QHash<int, int> netIndices;
+            for (int net = 0; net < flattener._names.count(); net++) {
+                const int root = flattener.find(net);
+                auto it = netIndices.constFind(root);
+                if (it == netIndices.constEnd()) {
+                    it = netIndices.insert(root, netlist.count());
+                    netlist.append({ flattener._names.at(root), { } });
+                }
+                netlist[it.value()].pins << flattener._pins.at(net);
+            }
+
+            return true;
+        }
+
+    private:
+        NetlistFlattener(const Lookup& lookup, int maxDepth) :
+            _lookup(lookup),
+            _maxDepth(maxDepth)
+        {
+        }
+
+        int addNet(const QString& name)
+        {
+            const int net = _parents.count();
+            _parents << net;
+            _names << name;
+            _pins << QStringList();
+
+            return net;
+        }
+
+        int find(int net)
+        {
+            while (_parents.at(net) != net) {
+                _parents[net] = _parents.at(_parents.at(net));      // Path halving
+                net = _parents.at(net);
+            }
+
+            return net;
+        }
+
+        // Merges two nets. The name of the net further up in the hierarchy is kept.
+        void unite(int outer, int inner)
+        {
+            const int outerRoot = find(outer);
+            const int innerRoot = find(inner);
+            if (outerRoot == innerRoot) {
+                return;
+            }
+
+            // Nets further up are created first
+            if (outerRoot < innerRoot) {
+                _parents[innerRoot] = outerRoot;
+            } else {
+                _parents[outerRoot] = innerRoot;
+            }
+        }
+
+        /**
+         * Adds the nets of one level of the hierarchy and descends into the
+         * instances it contains. Ports maps the port names to the nets they are
+         * connected to on the level above.
+         */
+        bool instantiate(const BlockDefinition::Subnets& subnets, const QString& path, const QHash<QString, int>& ports)
+        {
+            // Connections of the nested instances: node index -> connector -> net
+            QHash<int, QHash<QString, int>> instancePorts;
+
+            for (const auto& subnet : subnets.nets) {
+                const int net = addNet(path + subnet.name);
+
+                // Connect to the level above
+                auto port = ports.constFind(subnet.name);
+                if (port != ports.constEnd()) {
+                    unite(port.value(), net);
+                }
+
+                // Pins
+                for (const auto& pin : subnet.pins) {
+                    if (subnets.instances.contains(pin.node)) {
+                        instancePorts[pin.node].insert(pin.connector, net);
+                    } else {
+                        _pins[net] << QStringLiteral("%1N%2.%3").arg(path).arg(pin.node).arg(pin.connector);
+                    }
+                }
+            }
+
+            // Descend into the nested instances
+            for (auto it = subnets.instances.cbegin(); it != subnets.instances.cend(); it++) {
+                const QString& instanceName = it->name.isEmpty() ? QStringLiteral("N%1").arg(it.key()) : it->name;
+
+                const BlockDefinition::Subnets* definition = _lookup ? _lookup(it->definition) : nullptr;
+                if (!definition) {
+                    qWarning("NetlistFlattener::flatten(): Definition \"%s\" of block instance \"%s\" is missing.", qPrintable(it->definition), qPrintable(path + instanceName));
+                    return false;
+                }
+                if (_stack.contains(it->definition)) {
+                    qWarning("NetlistFlattener::flatten(): Block instance \"%s\" instantiates its own definition \"%s\".", qPrintable(path + instanceName), qPrintable(it->definition));
+                    return false;
+                }
+                if (_stack.count() >= _maxDepth) {
+                    qWarning("NetlistFlattener::flatten(): Block instance \"%s\" exceeds the maximum depth.", qPrintable(path + instanceName));
+                    return false;
+                }
+
+                _stack << it->definition;
+                const bool ok = instantiate(*definition, path + instanceName + QLatin1Char('/'), instancePorts.value(it.key()));
+                _stack.removeLast();
+                if (!ok) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        const Lookup& _lookup;
+        const int _maxDepth;
+        QStringList _stack;             // The definitions being expanded
+        QVector<int> _parents;
+        QVector<QString> _names;
+        QVector<QStringList> _pins;
+    };
+
+}
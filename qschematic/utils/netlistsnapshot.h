@@ -0,0 +1,594 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/*
+ * A flat, versioned netlist snapshot that can be read in place by another
+ * process. This header has no Qt dependency so that a simulator can use the
+ * reader without linking against QSchematic.
+ *
+ * Snapshot layout (native byte order, all offsets in bytes from the start):
+ *
+ *     NetlistSnapshotHeader
+ *     NetlistSnapshotNode[nodeCount]
+ *     NetlistSnapshotConnector[connectorCount]     Grouped by node
+ *     NetlistSnapshotNet[netCount]
+ *     std::uint32_t[netConnectorCount]             Connector indices, grouped by net
+ *     char[stringsSize]                            NUL terminated UTF-8 strings
+ *
+ * Names are offsets into the string table, offset 0 is the empty string.
+ */
+
+namespace QSchematic
+{
+
+    const std::uint32_t NETLIST_SNAPSHOT_MAGIC = 0x51534e4c;    // "QSNL"
+    const std::uint32_t NETLIST_SNAPSHOT_VERSION = 1;
+    const std::uint32_t NETLIST_SNAPSHOT_NONE = 0xffffffff;
+
+    struct NetlistSnapshotHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t sequence;
+        std::uint32_t size;
+        std::uint32_t nodeCount;
+        std::uint32_t connectorCount;
+        std::uint32_t netCount;
+        std::uint32_t netConnectorCount;
+        std::uint32_t stringsSize;
+        std::uint32_t nodesOffset;
+        std::uint32_t connectorsOffset;
+        std::uint32_t netsOffset;
+        std::uint32_t netConnectorsOffset;
+        std::uint32_t stringsOffset;
+        std::uint32_t reserved;
+    };
+
+    struct NetlistSnapshotNode
+    {
+        std::uint32_t id;
+        std::uint32_t name;
+        std::uint32_t firstConnector;
+        std::uint32_t connectorCount;
+    };
+
+    struct NetlistSnapshotConnector
+    {
+        std::uint32_t id;
+        std::uint32_t name;
+        std::uint32_t node;             // Index of the node
+        std::uint32_t net;              // Index of the net or NETLIST_SNAPSHOT_NONE
+    };
+
+    struct NetlistSnapshotNet
+    {
+        std::uint32_t id;
+        std::uint32_t name;
+        std::uint32_t firstConnector;   // Into the net connector array
+        std::uint32_t connectorCount;
+    };
+
+    static_assert(sizeof(NetlistSnapshotHeader) % 8 == 0, "The header has to keep the arrays aligned");
+
+    /**
+     * Assembles a snapshot. Connectors belong to the node added last, nets
+     * refer to connectors by the index returned from addConnector().
+     */
+    class NetlistSnapshotBuilder
+    {
+    public:
+        NetlistSnapshotBuilder()
+        {
+            _strings.push_back('\0');
+        }
+
+        std::uint32_t addNode(std::uint32_t id, const std::string& name)
+        {
+            _nodes.push_back({ id, string(name), std::uint32_t(_connectors.size()), 0 });
+
+            return std::uint32_t(_nodes.size() - 1);
+        }
+
+        std::uint32_t addConnector(std::uint32_t id, const std::string& name)
+        {
+            if (_nodes.empty()) {
+                return NETLIST_SNAPSHOT_NONE;
+            }
+
+            _connectors.push_back({ id, string(name), std::uint32_t(_nodes.size() - 1), NETLIST_SNAPSHOT_NONE });
+            _nodes.back().connectorCount++;
+
+            return std::uint32_t(_connectors.size() - 1);
+        }
+
+        std::uint32_t addNet(std::uint32_t id, const std::string& name, const std::vector<std::uint32_t>& connectors)
+        {
+            const std::uint32_t index = std::uint32_t(_nets.size());
+            NetlistSnapshotNet net { id, string(name), std::uint32_t(_netConnectors.size()), 0 };
+            for (std::uint32_t connector : connectors) {
+                if (connector >= _connectors.size()) {
+                    continue;
+                }
+                _connectors[connector].net = index;
+                _netConnectors.push_back(connector);
+                net.connectorCount++;
+            }
+            _nets.push_back(net);
+
+            return index;
+        }
+
+        /**
+         * Returns the serialized snapshot. The sequence is filled in when it
+         * gets published.
+         */
+        std::vector<char> data() const
+        {
+            NetlistSnapshotHeader header { };
+            header.magic = NETLIST_SNAPSHOT_MAGIC;
+            header.version = NETLIST_SNAPSHOT_VERSION;
+            header.nodeCount = std::uint32_t(_nodes.size());
+            header.connectorCount = std::uint32_t(_connectors.size());
+            header.netCount = std::uint32_t(_nets.size());
+            header.netConnectorCount = std::uint32_t(_netConnectors.size());
+            header.stringsSize = std::uint32_t(_strings.size());
+            header.nodesOffset = sizeof(NetlistSnapshotHeader);
+            header.connectorsOffset = header.nodesOffset + header.nodeCount * sizeof(NetlistSnapshotNode);
+            header.netsOffset = header.connectorsOffset + header.connectorCount * sizeof(NetlistSnapshotConnector);
+            header.netConnectorsOffset = header.netsOffset + header.netCount * sizeof(NetlistSnapshotNet);
+            header.stringsOffset = header.netConnectorsOffset + header.netConnectorCount * sizeof(std::uint32_t);
+            header.size = header.stringsOffset + header.stringsSize;
+
+            std::vector<char> data(header.size);
+            std::memcpy(data.data(), &header, sizeof(header));
+            copy(data, header.nodesOffset, _nodes);
+            copy(data, header.connectorsOffset, _connectors);
+            copy(data, header.netsOffset, _nets);
+            copy(data, header.netConnectorsOffset, _netConnectors);
+            copy(data, header.stringsOffset, _strings);
+
+            return data;
+        }
+
+    private:
+        std::uint32_t string(const std::string& value)
+        {
+            if (value.empty()) {
+                return 0;
+            }
+
+            // Names repeat a lot (eg. connector names of identical nodes)
+            const auto it = _stringOffsets.find(value);
+            if (it != _stringOffsets.cend()) {
+                return it->second;
+            }
+
+            const std::uint32_t offset = std::uint32_t(_strings.size());
+            _strings.insert(_strings.end(), value.cbegin(), value.cend());
+            _strings.push_back('\0');
+            _stringOffsets.emplace(value, offset);
+
+            return offset;
+        }
+
+        template<typename T>
+        static void copy(std::vector<char>& data, std::uint32_t offset, const std::vector<T>& values)
+        {
+            if (!values.empty()) {
+                std::memcpy(data.data() + offset, values.data(), values.size() * sizeof(T));
+            }
+        }
+
+        std::vector<NetlistSnapshotNode> _nodes;
+        std::vector<NetlistSnapshotConnector> _connectors;
+        std::vector<NetlistSnapshotNet> _nets;
+        std::vector<std::uint32_t> _netConnectors;
+        std::vector<char> _strings;
+        std::unordered_map<std::string, std::uint32_t> _stringOffsets;
+    };
+
+    /**
+     * Read-only access to a snapshot without copying it. The header is
+     * validated and kept so that a concurrently overwritten snapshot can never
+     * be accessed out of bounds. The accessors return nullptr for invalid
+     * indices.
+     */
+    class NetlistSnapshotView
+    {
+    public:
+        NetlistSnapshotView() = default;
+
+        NetlistSnapshotView(const void* data, std::size_t size) :
+            _data(static_cast<const char*>(data))
+        {
+            if (!_data || size < sizeof(NetlistSnapshotHeader)) {
+                return;
+            }
+            std::memcpy(&_header, _data, sizeof(_header));
+
+            _valid = _header.magic == NETLIST_SNAPSHOT_MAGIC &&
+                     _header.version == NETLIST_SNAPSHOT_VERSION &&
+                     _header.size <= size &&
+                     fits(_header.nodesOffset, _header.nodeCount, sizeof(NetlistSnapshotNode)) &&
+                     fits(_header.connectorsOffset, _header.connectorCount, sizeof(NetlistSnapshotConnector)) &&
+                     fits(_header.netsOffset, _header.netCount, sizeof(NetlistSnapshotNet)) &&
+                     fits(_header.netConnectorsOffset, _header.netConnectorCount, sizeof(std::uint32_t)) &&
+                     fits(_header.stringsOffset, _header.stringsSize, 1) &&
+                     _header.stringsSize > 0;
+        }
+
+        bool isValid() const
+        {
+            return _valid;
+        }
+
+        std::uint64_t sequence() const
+        {
+            return _header.sequence;
+        }
+
+        std::uint32_t nodeCount() const
+        {
+            return _valid ? _header.nodeCount : 0;
+        }
+
+        std::uint32_t connectorCount() const
+        {
+            return _valid ? _header.connectorCount : 0;
+        }
+
+        std::uint32_t netCount() const
+        {
+            return _valid ? _header.netCount : 0;
+        }
+
+        const NetlistSnapshotNode* node(std::uint32_t index) const
+        {
+            return element<NetlistSnapshotNode>(_header.nodesOffset, index, nodeCount());
+        }
+
+        const NetlistSnapshotConnector* connector(std::uint32_t index) const
+        {
+            return element<NetlistSnapshotConnector>(_header.connectorsOffset, index, connectorCount());
+        }
+
+        const NetlistSnapshotNet* net(std::uint32_t index) const
+        {
+            return element<NetlistSnapshotNet>(_header.netsOffset, index, netCount());
+        }
+
+        /**
+         * Returns the connector index at position i of the net.
+         */
+        std::uint32_t netConnector(const NetlistSnapshotNet& net, std::uint32_t i) const
+        {
+            if (!_valid || i >= net.connectorCount || net.firstConnector >= _header.netConnectorCount || i >= _header.netConnectorCount - net.firstConnector) {
+                return NETLIST_SNAPSHOT_NONE;
+            }
+
+            std::uint32_t connector;
+            std::memcpy(&connector, _data + _header.netConnectorsOffset + (net.firstConnector + i) * sizeof(std::uint32_t), sizeof(connector));
+
+            return connector;
+        }
+
+        /**
+         * Returns a string of the string table. The string never extends past
+         * the end of the table, even if the snapshot was overwritten in the
+         * meantime and is no longer terminated.
+         */
+        std::string_view string(std::uint32_t offset) const
+        {
+            if (!_valid || offset >= _header.stringsSize) {
+                return { };
+            }
+
+            const char* begin = _data + _header.stringsOffset + offset;
+            const std::size_t available = _header.stringsSize - offset;
+            const void* end = std::memchr(begin, '\0', available);
+
+            return { begin, end ? std::size_t(static_cast<const char*>(end) - begin) : available };
+        }
+
+    private:
+        bool fits(std::uint32_t offset, std::uint32_t count, std::size_t elementSize) const
+        {
+            if (offset < sizeof(NetlistSnapshotHeader) || offset > _header.size) {
+                return false;
+            }
+            if (elementSize > 1 && offset % sizeof(std::uint32_t) != 0) {
+                return false;
+            }
+
+            return std::uint64_t(count) * elementSize <= _header.size - offset;
+        }
+
+        template<typename T>
+        const T* element(std::uint32_t offset, std::uint32_t index, std::uint32_t count) const
+        {
+            if (index >= count) {
+                return nullptr;
+            }
+
+            return reinterpret_cast<const T*>(_data + offset) + index;
+        }
+
+        const char* _data = nullptr;
+        NetlistSnapshotHeader _header { };
+        bool _valid = false;
+    };
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    /**
+     * A POSIX shared memory segment holding two snapshot buffers. The writer
+     * always fills the buffer that isn't the current one and then publishes it
+     * by incrementing the sequence. Each buffer has its own seqlock counter
+     * which is odd while the buffer is being written, readers use it to detect
+     * that the snapshot changed underneath them and retry.
+     *
+     * If the snapshots outgrow the capacity the writer retires the segment and
+     * creates a new one under the same name, readers have to open it again.
+     */
+    class NetlistSnapshotSegment
+    {
+    public:
+        NetlistSnapshotSegment() = default;
+        NetlistSnapshotSegment(const NetlistSnapshotSegment& other) = delete;
+        NetlistSnapshotSegment& operator=(const NetlistSnapshotSegment& rhs) = delete;
+
+        ~NetlistSnapshotSegment()
+        {
+            close();
+        }
+
+        /**
+         * Creates the segment (replacing an existing one with the same name)
+         * for snapshots of up to capacity bytes. The segment is removed again
+         * once it is closed. A replacement segment continues with the sequence
+         * of its predecessor so that readers can tell the snapshots apart.
+         */
+        bool create(const std::string& name, std::size_t capacity, std::uint64_t sequence = 0)
+        {
+            close();
+
+            capacity = (capacity + 7) & ~std::size_t(7);
+            const std::size_t size = sizeof(Header) + 2 * capacity;
+
+            ::shm_unlink(name.c_str());
+            const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) {
+                return false;
+            }
+            if (::ftruncate(fd, off_t(size)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                return false;
+            }
+            void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                ::shm_unlink(name.c_str());
+                return false;
+            }
+
+            _header = new (memory) Header;
+            _header->version = NETLIST_SNAPSHOT_VERSION;
+            _header->capacity = capacity;
+            _header->retired.store(0, std::memory_order_relaxed);
+            _header->sequence.store(sequence, std::memory_order_relaxed);
+            for (int i = 0; i < 2; i++) {
+                _header->locks[i].store(0, std::memory_order_relaxed);
+                _header->sizes[i].store(0, std::memory_order_relaxed);
+            }
+            _header->magic.store(NETLIST_SNAPSHOT_MAGIC, std::memory_order_release);
+
+            _name = name;
+            _size = size;
+            _owner = true;
+
+            return true;
+        }
+
+        /**
+         * Maps an existing segment for reading.
+         */
+        bool open(const std::string& name)
+        {
+            close();
+
+            const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat info;
+            if (::fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(Header)) {
+                ::close(fd);
+                return false;
+            }
+            const std::size_t size = std::size_t(info.st_size);
+            void* memory = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                return false;
+            }
+
+            _header = static_cast<Header*>(memory);
+            _size = size;
+            _name = name;
+            _owner = false;
+
+            if (_header->magic.load(std::memory_order_acquire) != NETLIST_SNAPSHOT_MAGIC ||
+                _header->version != NETLIST_SNAPSHOT_VERSION ||
+                _header->capacity > (_size - sizeof(Header)) / 2) {
+                close();
+                return false;
+            }
+
+            return true;
+        }
+
+        void close()
+        {
+            if (!_header) {
+                return;
+            }
+
+            if (_owner) {
+                _header->retired.store(1, std::memory_order_release);
+            }
+            ::munmap(_header, _size);
+            if (_owner) {
+                ::shm_unlink(_name.c_str());
+            }
+
+            _header = nullptr;
+            _size = 0;
+            _owner = false;
+        }
+
+        bool isOpen() const
+        {
+            return _header;
+        }
+
+        /**
+         * Returns true if the writer replaced or removed the segment.
+         */
+        bool isRetired() const
+        {
+            return !_header || _header->retired.load(std::memory_order_acquire);
+        }
+
+        std::size_t capacity() const
+        {
+            return _header ? std::size_t(_header->capacity) : 0;
+        }
+
+        /**
+         * Returns the sequence of the current snapshot. Cheap enough to poll.
+         */
+        std::uint64_t sequence() const
+        {
+            return _header ? _header->sequence.load(std::memory_order_acquire) : 0;
+        }
+
+        /**
+         * Copies the snapshot into the spare buffer and makes it the current
+         * one. Returns false if it doesn't fit or if the segment was opened for
+         * reading.
+         */
+        bool publish(const std::vector<char>& snapshot)
+        {
+            if (!_header || !_owner || snapshot.size() < sizeof(NetlistSnapshotHeader) || snapshot.size() > _header->capacity) {
+                return false;
+            }
+
+            const std::uint64_t sequence = _header->sequence.load(std::memory_order_relaxed) + 1;
+            const int index = int(sequence & 1);
+            char* buffer = this->buffer(index);
+
+            _header->locks[index].fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::memcpy(buffer, snapshot.data(), snapshot.size());
+            std::memcpy(buffer + offsetof(NetlistSnapshotHeader, sequence), &sequence, sizeof(sequence));
+            _header->sizes[index].store(snapshot.size(), std::memory_order_relaxed);
+
+            _header->locks[index].fetch_add(1, std::memory_order_release);
+            _header->sequence.store(sequence, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * Passes the current snapshot to function(const NetlistSnapshotView&)
+         * without copying it. If the writer touched the snapshot meanwhile
+         * the function is called again with the newer one, so it must not
+         * have side effects that can't be repeated. Returns true once the
+         * function saw a consistent snapshot, false if there is none or the
+         * writer kept interfering.
+         */
+        template<typename Function>
+        bool read(Function&& function, int attempts = 16) const
+        {
+            if (!_header) {
+                return false;
+            }
+
+            for (int attempt = 0; attempt < attempts; attempt++) {
+                const std::uint64_t sequence = _header->sequence.load(std::memory_order_acquire);
+                if (sequence == 0) {
+                    return false;
+                }
+                const int index = int(sequence & 1);
+
+                const std::uint64_t lock = _header->locks[index].load(std::memory_order_acquire);
+                if (lock & 1) {
+                    continue;
+                }
+                const std::uint64_t size = _header->sizes[index].load(std::memory_order_relaxed);
+                if (size == 0) {
+                    return false;
+                }
+
+                const NetlistSnapshotView view(buffer(index), std::size_t(std::min<std::uint64_t>(size, _header->capacity)));
+                if (view.isValid() && view.sequence() == sequence) {
+                    function(view);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (_header->locks[index].load(std::memory_order_relaxed) == lock && view.isValid() && view.sequence() == sequence) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        struct Header
+        {
+            std::atomic<std::uint32_t> magic;
+            std::uint32_t version;
+            std::uint64_t capacity;                         // Of each buffer
+            std::atomic<std::uint64_t> retired;
+            std::atomic<std::uint64_t> sequence;            // Buffer sequence % 2 is the current one
+            std::atomic<std::uint64_t> locks[2];            // Odd while the buffer is written
+            std::atomic<std::uint64_t> sizes[2];
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The segment requires lock free atomics");
+        static_assert(sizeof(Header) % 8 == 0, "The header has to keep the buffers aligned");
+
+        char* buffer(int index) const
+        {
+            return reinterpret_cast<char*>(_header + 1) + index * _header->capacity;
+        }
+
+        Header* _header = nullptr;
+        std::size_t _size = 0;
+        std::string _name;
+        bool _owner = false;
+    };
+
+#endif
+
+}
@@ -0,0 +1,638 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QPair>
+#include <QPointF>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+
+namespace QSchematic
+{
+
+    /**
+     * A single entry of the operation log that mirrors the edits of a scene.
+     * Items, wires and nets are referred to by ids assigned by the writer.
+     * Only the fields relevant to the type are transmitted.
+     */
+    struct Operation
+    {
+        enum Type : quint8 {
+            ItemAdd,            // id, itemType, pos, rotation, size, points (connector positions)
+            ItemRemove,         // id (item or wire)
+            ItemMove,           // id, pos, rotation, size, points (connector positions)
+            WireUpdate,         // id, itemType, net, points (scene coordinates). Adds unknown wires.
+            NetRename,          // net, name
+            Attach,             // id (node), index (connector), wire, point
+            Detach,             // id (node), index (connector)
+            Checksum,           // checksum of the state after all previous operations
+            Reset,              // Clears the state, followed by a snapshot
+        };
+
+        Type type = ItemAdd;
+        quint64 sequence = 0;
+        quint64 id = 0;
+        qint32 itemType = 0;
+        QPointF pos;
+        qreal rotation = 0;
+        QSizeF size;
+        QVector<QPointF> points;
+        quint64 net = 0;
+        QString name;
+        qint32 index = 0;
+        quint64 wire = 0;
+        qint32 point = 0;
+        quint64 checksum = 0;
+    };
+
+    /**
+     * Turns operations into length prefixed frames and back. Frames can be
+     * appended in arbitrary chunks (e.g. as they arrive on a socket or pipe).
+     */
+    class OperationCodec
+    {
+    public:
+        static QByteArray encode(const Operation& operation)
+        {
+            QByteArray payload;
+            QDataStream stream(&payload, QIODevice::WriteOnly);
+            stream << quint8(operation.type) << operation.sequence;
+
+            switch (operation.type) {
+            case Operation::ItemAdd:
+                stream << operation.id << operation.itemType << operation.pos << operation.rotation << operation.size << operation.points;
+                break;
+            case Operation::ItemRemove:
+                stream << operation.id;
+                break;
+            case Operation::ItemMove:
+                stream << operation.id << operation.pos << operation.rotation << operation.size << operation.points;
+                break;
+            case Operation::WireUpdate:
+                stream << operation.id << operation.itemType << operation.net << operation.points;
+                break;
+            case Operation::NetRename:
+                stream << operation.net << operation.name;
+                break;
+            case Operation::Attach:
+                stream << operation.id << operation.index << operation.wire << operation.point;
+                break;
+            case Operation::Detach:
+                stream << operation.id << operation.index;
+                break;
+            case Operation::Checksum:
+                stream << operation.checksum;
+                break;
+            case Operation::Reset:
+                break;
+            }
+
+            QByteArray frame;
+            QDataStream frameStream(&frame, QIODevice::WriteOnly);
+            frameStream << quint32(payload.size());
+            frame.append(payload);
+
+            return frame;
+        }
+
+        static bool decode(const QByteArray& payload, Operation& operation)
+        {
+            operation = Operation();
+
+            QDataStream stream(payload);
+            quint8 type = 0;
+            stream >> type >> operation.sequence;
+            if (type > Operation::Reset) {
+                return false;
+            }
+            operation.type = static_cast<Operation::Type>(type);
+
+            switch (operation.type) {
+            case Operation::ItemAdd:
+                stream >> operation.id >> operation.itemType >> operation.pos >> operation.rotation >> operation.size >> operation.points;
+                break;
+            case Operation::ItemRemove:
+                stream >> operation.id;
+                break;
+            case Operation::ItemMove:
+                stream >> operation.id >> operation.pos >> operation.rotation >> operation.size >> operation.points;
+                break;
+            case Operation::WireUpdate:
+                stream >> operation.id >> operation.itemType >> operation.net >> operation.points;
+                break;
+            case Operation::NetRename:
+                stream >> operation.net >> operation.name;
+                break;
+            case Operation::Attach:
+                stream >> operation.id >> operation.index >> operation.wire >> operation.point;
+                break;
+            case Operation::Detach:
+                stream >> operation.id >> operation.index;
+                break;
+            case Operation::Checksum:
+                stream >> operation.checksum;
+                break;
+            case Operation::Reset:
+                break;
+            }
+
+            return stream.status() == QDataStream::Ok && stream.atEnd();
+        }
+
+        void append(const QByteArray& data)
+        {
+            _buffer.append(data);
+        }
+
+        /**
+         * Extracts the next complete operation. Returns false if there is none
+         * (yet) or if the data is corrupt, see hasError().
+         */
+        bool next(Operation& operation)
+        {
+            if (_error || _buffer.size() - _offset < int(sizeof(quint32))) {
+                return false;
+            }
+
+            quint32 length = 0;
+            {
+                QDataStream stream(_buffer.mid(_offset, int(sizeof(quint32))));
+                stream >> length;
+            }
+            if (length > MaxFrameSize) {
+                _error = true;
+                return false;
+            }
+            if (quint32(_buffer.size() - _offset - int(sizeof(quint32))) < length) {
+                return false;
+            }
+
+            const QByteArray payload = _buffer.mid(_offset + int(sizeof(quint32)), int(length));
+            _offset += int(sizeof(quint32)) + int(length);
+
+            // Don't let the consumed data pile up
+            if (_offset > 4096 && _offset * 2 > _buffer.size()) {
+                _buffer.remove(0, _offset);
+                _offset = 0;
+            }
+
+            if (!decode(payload, operation)) {
+                _error = true;
+                return false;
+            }
+
+            return true;
+        }
+
+        bool hasError() const
+        {
+            return _error;
+        }
+
+    private:
+        static const quint32 MaxFrameSize = 64 * 1024 * 1024;
+
+        QByteArray _buffer;
+        int _offset = 0;
+        bool _error = false;
+    };
+
+    /**
+     * The state described by an operation log. The writer keeps one to know
+     * what it has sent, a replica keeps one built from what it received.
+     * Both compute the same checksum as long as they agree.
+     */
+    class OperationLogModel
+    {
+    public:
+        struct ItemState
+        {
+            qint32 type = 0;
+            QPointF pos;
+            qreal rotation = 0;
+            QSizeF size;
+            QVector<QPointF> connectors;
+        };
+
+        struct WireState
+        {
+            qint32 type = 0;
+            quint64 net = 0;
+            QVector<QPointF> points;
+        };
+
+        using ConnectorKey = QPair<quint64, qint32>;            // Node, connector index
+        using Attachment = QPair<quint64, qint32>;              // Wire, point index
+
+        QHash<quint64, ItemState> items;
+        QHash<quint64, WireState> wires;
+        QHash<quint64, QString> nets;
+        QHash<ConnectorKey, Attachment> attachments;
+
+        void clear()
+        {
+            items.clear();
+            wires.clear();
+            nets.clear();
+            attachments.clear();
+        }
+
+        /**
+         * Applies an operation. Returns false if it doesn't fit the current
+         * state, e.g. because it refers to an unknown item.
+         */
+        bool apply(const Operation& operation)
+        {
+            switch (operation.type) {
+            case Operation::ItemAdd:
+            {
+                if (items.contains(operation.id) || wires.contains(operation.id)) {
+                    return false;
+                }
+                items.insert(operation.id, { operation.itemType, operation.pos, operation.rotation, operation.size, operation.points });
+                return true;
+            }
+
+            case Operation::ItemRemove:
+            {
+                if (items.remove(operation.id) == 0 && wires.remove(operation.id) == 0) {
+                    return false;
+                }
+                // Attachments of or to the removed item go away with it
+                for (auto it = attachments.begin(); it != attachments.end();) {
+                    if (it.key().first == operation.id || it.value().first == operation.id) {
+                        it = attachments.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                return true;
+            }
+
+            case Operation::ItemMove:
+            {
+                auto it = items.find(operation.id);
+                if (it == items.end()) {
+                    return false;
+                }
+                it->pos = operation.pos;
+                it->rotation = operation.rotation;
+                it->size = operation.size;
+                it->connectors = operation.points;
+                return true;
+            }
+
+            case Operation::WireUpdate:
+            {
+                if (items.contains(operation.id)) {
+                    return false;
+                }
+                wires.insert(operation.id, { operation.itemType, operation.net, operation.points });
+                if (!nets.contains(operation.net)) {
+                    nets.insert(operation.net, QString());
+                }
+                return true;
+            }
+
+            case Operation::NetRename:
+                nets.insert(operation.net, operation.name);
+                return true;
+
+            case Operation::Attach:
+            {
+                auto item = items.constFind(operation.id);
+                if (item == items.cend() || operation.index < 0 || operation.index >= item->connectors.count() || !wires.contains(operation.wire)) {
+                    return false;
+                }
+                attachments.insert({ operation.id, operation.index }, { operation.wire, operation.point });
+                return true;
+            }
+
+            case Operation::Detach:
+                return attachments.remove({ operation.id, operation.index }) > 0;
+
+            case Operation::Checksum:
+                return true;
+
+            case Operation::Reset:
+                clear();
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * Order independent checksum over everything the log describes.
+         */
+        quint64 checksum() const
+        {
+            quint64 sum = 0;
+
+            for (auto it = items.cbegin(); it != items.cend(); ++it) {
+                QByteArray data;
+                QDataStream stream(&data, QIODevice::WriteOnly);
+                stream << quint8(0) << it.key() << it->type << it->pos << it->rotation << it->size << it->connectors;
+                sum += hash(data);
+            }
+            for (auto it = wires.cbegin(); it != wires.cend(); ++it) {
+                QByteArray data;
+                QDataStream stream(&data, QIODevice::WriteOnly);
+                stream << quint8(1) << it.key() << it->type << it->net << it->points;
+                sum += hash(data);
+            }
+            for (auto it = nets.cbegin(); it != nets.cend(); ++it) {
+                QByteArray data;
+                QDataStream stream(&data, QIODevice::WriteOnly);
+                stream << quint8(2) << it.key() << it.value();
+                sum += hash(data);
+            }
+            for (auto it = attachments.cbegin(); it != attachments.cend(); ++it) {
+                QByteArray data;
+                QDataStream stream(&data, QIODevice::WriteOnly);
+                stream << quint8(3) << it.key().first << it.key().second << it.value().first << it.value().second;
+                sum += hash(data);
+            }
+
+            return sum;
+        }
+
+    private:
+        // FNV-1a
+        static quint64 hash(const QByteArray& data)
+        {
+            quint64 value = 14695981039346656037ULL;
+            for (char c : data) {
+                value ^= quint8(c);
+                value *= 1099511628211ULL;
+            }
+
+            return value;
+        }
+    };
+
+    /**
+     * The writing side of the log: assigns the ids, keeps the state sent so
+     * far and only encodes what differs from it. It doesn't know anything
+     * about scenes, the OperationLogWriter feeds it with what changed.
+     *
+     * Objects are identified by their address (a key). Keys are released once
+     * the object is gone as the address may be reused for another one, which
+     * then gets a new id.
+     */
+    class OperationLogEncoder
+    {
+    public:
+        using Key = const void*;
+
+        void setChecksumInterval(int operations)
+        {
+            _checksumInterval = qMax(0, operations);
+        }
+
+        int checksumInterval() const
+        {
+            return _checksumInterval;
+        }
+
+        const OperationLogModel& model() const
+        {
+            return _model;
+        }
+
+        quint64 sequence() const
+        {
+            return _sequence;
+        }
+
+        /**
+         * Returns the id of the key, a new one is assigned if it has none yet.
+         */
+        quint64 id(Key key)
+        {
+            auto it = _ids.constFind(key);
+            if (it == _ids.cend()) {
+                it = _ids.insert(key, _nextId);
+                _keys.insert(_nextId, key);
+                _nextId++;
+            }
+
+            return it.value();
+        }
+
+        /**
+         * Returns the id of the key or 0 if it has none.
+         */
+        quint64 findId(Key key) const
+        {
+            return _ids.value(key, 0);
+        }
+
+        Key key(quint64 id) const
+        {
+            return _keys.value(id, nullptr);
+        }
+
+        void releaseId(Key key)
+        {
+            _keys.remove(_ids.take(key));
+        }
+
+        /**
+         * Makes the peer start over. All ids are released and the next
+         * checksum is written with the next finish().
+         */
+        void reset()
+        {
+            Operation operation;
+            operation.type = Operation::Reset;
+            write(operation);
+
+            _ids.clear();
+            _keys.clear();
+            _sinceChecksum = _checksumInterval;
+        }
+
+        /**
+         * Adds the item or moves it if any of the attributes changed.
+         */
+        void updateItem(Key key, qint32 type, const QPointF& pos, qreal rotation, const QSizeF& size, const QVector<QPointF>& connectors)
+        {
+            Operation operation;
+            operation.id = id(key);
+            operation.itemType = type;
+            operation.pos = pos;
+            operation.rotation = rotation;
+            operation.size = size;
+            operation.points = connectors;
+
+            const auto it = _model.items.constFind(operation.id);
+            if (it == _model.items.cend()) {
+                operation.type = Operation::ItemAdd;
+            } else if (it->pos == pos && qFuzzyCompare(it->rotation + 1, rotation + 1) && it->size == size && it->connectors == connectors) {
+                return;
+            } else {
+                operation.type = Operation::ItemMove;
+            }
+            write(operation);
+        }
+
+        /**
+         * Adds the wire or updates it if its net or points changed.
+         */
+        void updateWire(Key key, qint32 type, quint64 net, const QVector<QPointF>& points)
+        {
+            Operation operation;
+            operation.type = Operation::WireUpdate;
+            operation.id = id(key);
+            operation.itemType = type;
+            operation.net = net;
+            operation.points = points;
+
+            const auto it = _model.wires.constFind(operation.id);
+            if (it != _model.wires.cend() && it->type == type && it->net == net && it->points == points) {
+                return;
+            }
+            write(operation);
+        }
+
+        /**
+         * Removes the item or wire and releases its key.
+         */
+        void removeItem(Key key)
+        {
+            const quint64 itemId = findId(key);
+            releaseId(key);
+            if (!_model.items.contains(itemId) && !_model.wires.contains(itemId)) {
+                return;
+            }
+
+            Operation operation;
+            operation.type = Operation::ItemRemove;
+            operation.id = itemId;
+            write(operation);
+        }
+
+        /**
+         * Renames the net. Nets without wires are not part of the log.
+         */
+        void renameNet(quint64 net, const QString& name)
+        {
+            const auto it = _model.nets.constFind(net);
+            if (it == _model.nets.cend() || it.value() == name) {
+                return;
+            }
+
+            Operation operation;
+            operation.type = Operation::NetRename;
+            operation.net = net;
+            operation.name = name;
+            write(operation);
+        }
+
+        /**
+         * Attaches the connector of the node to a point of the wire. A wire id
+         * of 0 detaches it.
+         */
+        void setAttachment(quint64 node, qint32 index, quint64 wire, qint32 point)
+        {
+            const OperationLogModel::ConnectorKey connector(node, index);
+            const auto it = _model.attachments.constFind(connector);
+            const bool attached = it != _model.attachments.cend();
+
+            Operation operation;
+            operation.id = node;
+            operation.index = index;
+            if (wire == 0) {
+                if (!attached) {
+                    return;
+                }
+                operation.type = Operation::Detach;
+            } else {
+                if (attached && it.value() == OperationLogModel::Attachment(wire, point)) {
+                    return;
+                }
+                operation.type = Operation::Attach;
+                operation.wire = wire;
+                operation.point = point;
+            }
+            write(operation);
+        }
+
+        /**
+         * Returns the connectors attached to the wire.
+         */
+        QList<OperationLogModel::ConnectorKey> attachedTo(quint64 wire) const
+        {
+            return _attachedTo.values(wire);
+        }
+
+        /**
+         * Ends a batch of operations by writing a checksum if one is due.
+         */
+        void finish()
+        {
+            if (_checksumInterval > 0 && _sinceChecksum >= _checksumInterval) {
+                Operation operation;
+                operation.type = Operation::Checksum;
+                operation.checksum = _model.checksum();
+                write(operation);
+                _sinceChecksum = 0;
+            }
+        }
+
+        /**
+         * Returns the frames encoded since the last call.
+         */
+        QByteArray takeFrames()
+        {
+            QByteArray frames;
+            frames.swap(_frames);
+
+            return frames;
+        }
+
+    private:
+        void write(Operation& operation)
+        {
+            // Keep the reverse index of the attachments up to date
+            if (operation.type == Operation::Attach || operation.type == Operation::Detach) {
+                const OperationLogModel::ConnectorKey connector(operation.id, operation.index);
+                const auto it = _model.attachments.constFind(connector);
+                if (it != _model.attachments.cend()) {
+                    _attachedTo.remove(it.value().first, connector);
+                }
+                if (operation.type == Operation::Attach) {
+                    _attachedTo.insert(operation.wire, connector);
+                }
+            }
+
+            operation.sequence = ++_sequence;
+            _model.apply(operation);
+            _frames.append(OperationCodec::encode(operation));
+
+            if (operation.type == Operation::ItemRemove || operation.type == Operation::Reset) {
+                _attachedTo.clear();
+                for (auto it = _model.attachments.cbegin(); it != _model.attachments.cend(); ++it) {
+                    _attachedTo.insert(it.value().first, it.key());
+                }
+            }
+            if (operation.type != Operation::Checksum) {
+                _sinceChecksum++;
+            }
+        }
+
+        OperationLogModel _model;
+        QHash<Key, quint64> _ids;
+        QHash<quint64, Key> _keys;
+        QMultiHash<quint64, OperationLogModel::ConnectorKey> _attachedTo;     // Wire -> connectors
+        QByteArray _frames;
+        quint64 _sequence = 0;
+        quint64 _nextId = 1;
+        int _checksumInterval = 64;
+        int _sinceChecksum = 0;
+    };
+
+}
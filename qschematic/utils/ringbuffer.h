@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace QSchematic
+{
+
+    /**
+     * Bounded lock-free ring buffer for multiple producers and a single consumer.
+     *
+     * Every cell carries a sequence number telling whether it is ready to be
+     * written or read. Producers claim a cell with a single compare & swap and
+     * never wait: if the buffer is full tryPush() fails immediately.
+     * The capacity is rounded up to the next power of two.
+     */
+    template<typename T>
+    class RingBuffer
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "RingBuffer only supports trivially copyable types");
+
+    public:
+        explicit RingBuffer(std::size_t capacity) :
+            _mask(roundUpToPowerOfTwo(capacity) - 1),
+            _cells(new Cell[_mask + 1]),
+            _enqueuePos(0),
+            _dequeuePos(0)
+        {
+            for (std::size_t i = 0; i <= _mask; i++) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RingBuffer(const RingBuffer& other) = delete;
+        RingBuffer(RingBuffer&& other) = delete;
+        ~RingBuffer() = default;
+
+        RingBuffer& operator=(const RingBuffer& rhs) = delete;
+        RingBuffer& operator=(RingBuffer&& rhs) = delete;
+
+        /**
+         * Can be called from any thread.
+         * \return false if the buffer is full.
+         */
+        bool tryPush(const T& value)
+        {
+            std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = _cells[pos & _mask];
+                const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+                // Cell is free, try to claim it
+                if (diff == 0) {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.value = value;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+
+                // Full
+                else if (diff < 0) {
+                    return false;
+                }
+
+                // Another producer was faster
+                else {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * Must only be called from the consumer thread.
+         * \return false if the buffer is empty.
+         */
+        bool tryPop(T& value)
+        {
+            Cell& cell = _cells[_dequeuePos & _mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(_dequeuePos + 1) < 0) {
+                return false;
+            }
+
+            value = cell.value;
+            cell.sequence.store(_dequeuePos + _mask + 1, std::memory_order_release);
+            _dequeuePos++;
+
+            return true;
+        }
+
+        [[nodiscard]] std::size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        static std::size_t roundUpToPowerOfTwo(std::size_t value)
+        {
+            std::size_t result = 2;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        const std::size_t _mask;
+        const std::unique_ptr<Cell[]> _cells;
+        alignas(64) std::atomic<std::size_t> _enqueuePos;
+        alignas(64) std::size_t _dequeuePos;
+    };
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifdef USE_GPDS
+#include <functional>
+#include <QRect>
+#include <QVector>
+#include <gpds/container.hpp>
+#include "../wire_system/manager.h"
+
+namespace QSchematic
+{
+
+    /**
+     * Reads a container created by Scene::to_container(). Both the Scene and the
+     * headless Document load files through this so that they restore the same
+     * structure and the same connections, they only differ in the items they
+     * create from the node and net containers.
+     */
+    class SceneContainerReader
+    {
+    public:
+        std::function<void(const QRect& rect)> rect;
+        std::function<void(const gpds::container& node)> node;
+        std::function<void(const gpds::container& net)> net;                     // Restores the net and its wires
+        std::function<QVector<const wire_system::connectable*>()> connectors;   // All connectors once the nodes are restored
+
+        void read(const gpds::container& container, wire_system::manager& manager) const
+        {
+            // Scene
+            if (const gpds::container* sceneContainer = container.get_value<gpds::container*>("scene").value_or(nullptr)) {
+                const gpds::container* rectContainer = sceneContainer->get_value<gpds::container*>("rect").value_or(nullptr);
+                if (rectContainer && rect) {
+                    QRect sceneRect;
+                    sceneRect.setX(rectContainer->get_value<int>("x").value_or(0));
+                    sceneRect.setY(rectContainer->get_value<int>("y").value_or(0));
+                    sceneRect.setWidth(rectContainer->get_value<int>("width").value_or(0));
+                    sceneRect.setHeight(rectContainer->get_value<int>("height").value_or(0));
+                    rect(sceneRect);
+                }
+            }
+
+            // Nodes
+            if (const gpds::container* nodesContainer = container.get_value<gpds::container*>("nodes").value_or(nullptr)) {
+                for (const gpds::container* nodeContainer : nodesContainer->get_values<gpds::container*>("node")) {
+                    if (nodeContainer && node) {
+                        node(*nodeContainer);
+                    }
+                }
+            }
+
+            // Nets
+            if (const gpds::container* netsContainer = container.get_value<gpds::container*>("nets").value_or(nullptr)) {
+                for (const gpds::container* netContainer : netsContainer->get_values<gpds::container*>("net")) {
+                    if (netContainer && net) {
+                        net(*netContainer);
+                    }
+                }
+            }
+
+            // Attach the wires to the nodes
+            if (connectors) {
+                manager.attach_connectors(connectors());
+            }
+
+            // Find junctions
+            manager.generate_junctions();
+        }
+    };
+
+}
+#endif
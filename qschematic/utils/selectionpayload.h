@@ -0,0 +1,145 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QVector>
+
+namespace QSchematic
+{
+
+    /**
+     * A copied selection: the serialized items and wires, the nets of the
+     * wires, the wires attached to connectors and the junctions between the
+     * wires. Items and wires are referred to by their index in the selection.
+     * The payload doesn't know how the items are serialized, that is up to
+     * SelectionMimeData.
+     */
+    struct SelectionPayload
+    {
+        struct Attachment
+        {
+            int item;
+            int connector;
+            int wire;
+            int point;
+        };
+
+        struct Junction
+        {
+            int wire;
+            int connectedWire;      // Has a point on wire
+            int point;              // The point of connectedWire
+        };
+
+        struct Net
+        {
+            QString name;
+            QVector<int> wires;
+        };
+
+        static constexpr quint32 Magic = 0x51534c43;    // "QSLC"
+        static constexpr quint16 Version = 3;
+
+        int itemCount = 0;
+        int wireCount = 0;
+        QByteArray items;           // The items followed by the wires
+        QVector<Net> nets;
+        QVector<Attachment> attachments;
+        QVector<Junction> junctions;
+
+        QByteArray encode() const
+        {
+            QByteArray data;
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream << Magic << Version << quint32(itemCount) << quint32(wireCount) << items;
+
+            stream << quint32(nets.count());
+            for (const Net& net : nets) {
+                stream << net.name << quint32(net.wires.count());
+                for (int wire : net.wires) {
+                    stream << quint32(wire);
+                }
+            }
+            stream << quint32(attachments.count());
+            for (const Attachment& attachment : attachments) {
+                stream << quint32(attachment.item) << quint32(attachment.connector) << quint32(attachment.wire) << qint32(attachment.point);
+            }
+            stream << quint32(junctions.count());
+            for (const Junction& junction : junctions) {
+                stream << quint32(junction.wire) << quint32(junction.connectedWire) << qint32(junction.point);
+            }
+
+            return data;
+        }
+
+        /**
+         * Returns false if the data is truncated or refers to items or wires that
+         * are out of range. Connector and point indices are checked by the caller
+         * which knows the items.
+         */
+        static bool decode(const QByteArray& data, SelectionPayload& payload)
+        {
+            payload = SelectionPayload();
+
+            QDataStream stream(data);
+            quint32 magic = 0;
+            quint16 version = 0;
+            quint32 itemCount = 0;
+            quint32 wireCount = 0;
+            stream >> magic >> version >> itemCount >> wireCount >> payload.items;
+            if (stream.status() != QDataStream::Ok || magic != Magic || version != Version) {
+                return false;
+            }
+            payload.itemCount = int(itemCount);
+            payload.wireCount = int(wireCount);
+
+            quint32 netCount = 0;
+            stream >> netCount;
+            for (quint32 i = 0; i < netCount && stream.status() == QDataStream::Ok; i++) {
+                Net net;
+                quint32 count = 0;
+                stream >> net.name >> count;
+                for (quint32 j = 0; j < count && stream.status() == QDataStream::Ok; j++) {
+                    quint32 wire = 0;
+                    stream >> wire;
+                    if (wire >= wireCount) {
+                        return false;
+                    }
+                    net.wires << int(wire);
+                }
+                payload.nets << net;
+            }
+
+            quint32 attachmentCount = 0;
+            stream >> attachmentCount;
+            for (quint32 i = 0; i < attachmentCount && stream.status() == QDataStream::Ok; i++) {
+                quint32 item = 0;
+                quint32 connector = 0;
+                quint32 wire = 0;
+                qint32 point = 0;
+                stream >> item >> connector >> wire >> point;
+                if (item >= itemCount || wire >= wireCount || point < 0) {
+                    return false;
+                }
+                payload.attachments.push_back({ int(item), int(connector), int(wire), point });
+            }
+
+            quint32 junctionCount = 0;
+            stream >> junctionCount;
+            for (quint32 i = 0; i < junctionCount && stream.status() == QDataStream::Ok; i++) {
+                quint32 wire = 0;
+                quint32 connectedWire = 0;
+                qint32 point = 0;
+                stream >> wire >> connectedWire >> point;
+                if (wire >= wireCount || connectedWire >= wireCount || point < 0) {
+                    return false;
+                }
+                payload.junctions.push_back({ int(wire), int(connectedWire), point });
+            }
+
+            return stream.status() == QDataStream::Ok;
+        }
+    };
+
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <QPointF>
+
+namespace QSchematic
+{
+
+    /**
+     * Static spatial index of snap targets: points (stored in a uniform grid
+     * of buckets) and axis aligned edges (stored sorted by their position).
+     * Point queries only look at the buckets within the snap radius, so their
+     * cost depends on the local density rather than on the total number of
+     * targets. Edge queries look at every edge in the strip of the snap radius
+     * around the source, regardless of where along the strip the edge is.
+     */
+    class SnapIndex
+    {
+    public:
+        struct Candidate
+        {
+            QPointF offset;         // From the source to the target
+            qreal distance = 0;
+            int priority = 0;
+        };
+
+        explicit SnapIndex(qreal cellSize = 10) :
+            _cellSize(std::max(cellSize, qreal(1)))
+        {
+        }
+
+        void clear()
+        {
+            _cells.clear();
+            _verticalEdges.clear();
+            _horizontalEdges.clear();
+            _pointCount = 0;
+        }
+
+        void addPoint(const QPointF& point, int priority)
+        {
+            _cells[key(cell(point.x()), cell(point.y()))].push_back({ point, priority });
+            _pointCount++;
+        }
+
+        void addVerticalEdge(qreal x, qreal top, qreal bottom, int priority)
+        {
+            _verticalEdges.push_back({ x, std::min(top, bottom), std::max(top, bottom), priority });
+            _edgesSorted = false;
+        }
+
+        void addHorizontalEdge(qreal y, qreal left, qreal right, int priority)
+        {
+            _horizontalEdges.push_back({ y, std::min(left, right), std::max(left, right), priority });
+            _edgesSorted = false;
+        }
+
+        /**
+         * Must be called after adding edges and before querying them.
+         */
+        void finalize()
+        {
+            auto byPosition = [](const Edge& a, const Edge& b) { return a.position < b.position; };
+            std::sort(_verticalEdges.begin(), _verticalEdges.end(), byPosition);
+            std::sort(_horizontalEdges.begin(), _horizontalEdges.end(), byPosition);
+            _edgesSorted = true;
+        }
+
+        std::size_t pointCount() const
+        {
+            return _pointCount;
+        }
+
+        std::size_t edgeCount() const
+        {
+            return _verticalEdges.size() + _horizontalEdges.size();
+        }
+
+        /**
+         * Finds the (up to) k points closest to source within the radius. The
+         * result is sorted by distance.
+         */
+        void nearestPoints(const QPointF& source, qreal radius, std::size_t k, std::vector<Candidate>& result) const
+        {
+            result.clear();
+            if (k == 0) {
+                return;
+            }
+
+            const std::int64_t minX = cell(source.x() - radius);
+            const std::int64_t maxX = cell(source.x() + radius);
+            const std::int64_t minY = cell(source.y() - radius);
+            const std::int64_t maxY = cell(source.y() + radius);
+            for (std::int64_t x = minX; x <= maxX; x++) {
+                for (std::int64_t y = minY; y <= maxY; y++) {
+                    const auto it = _cells.find(key(x, y));
+                    if (it == _cells.cend()) {
+                        continue;
+                    }
+
+                    for (const Point& point : it->second) {
+                        const QPointF offset = point.position - source;
+                        const qreal distance = std::hypot(offset.x(), offset.y());
+                        if (distance <= radius) {
+                            insertCandidate(result, k, { offset, distance, point.priority });
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Finds the closest vertical edge within the radius overlapping the
+         * vertical span [top, bottom] of the source edge at x.
+         */
+        bool nearestVerticalEdge(qreal x, qreal top, qreal bottom, qreal radius, Candidate& result) const
+        {
+            if (!nearestEdge(_verticalEdges, x, std::min(top, bottom), std::max(top, bottom), radius, result)) {
+                return false;
+            }
+            result.offset = QPointF(result.offset.x(), 0);
+
+            return true;
+        }
+
+        /**
+         * Finds the closest horizontal edge within the radius overlapping the
+         * horizontal span [left, right] of the source edge at y.
+         */
+        bool nearestHorizontalEdge(qreal y, qreal left, qreal right, qreal radius, Candidate& result) const
+        {
+            if (!nearestEdge(_horizontalEdges, y, std::min(left, right), std::max(left, right), radius, result)) {
+                return false;
+            }
+            result.offset = QPointF(0, result.offset.x());
+
+            return true;
+        }
+
+    private:
+        struct Point
+        {
+            QPointF position;
+            int priority;
+        };
+
+        struct Edge
+        {
+            qreal position;
+            qreal from;
+            qreal to;
+            int priority;
+        };
+
+        std::int64_t cell(qreal coordinate) const
+        {
+            return static_cast<std::int64_t>(std::floor(coordinate / _cellSize));
+        }
+
+        static std::uint64_t key(std::int64_t x, std::int64_t y)
+        {
+            return (static_cast<std::uint64_t>(x) << 32) ^ static_cast<std::uint32_t>(y);
+        }
+
+        static void insertCandidate(std::vector<Candidate>& result, std::size_t k, const Candidate& candidate)
+        {
+            if (result.size() == k && candidate.distance >= result.back().distance) {
+                return;
+            }
+
+            auto it = std::upper_bound(result.begin(), result.end(), candidate, [](const Candidate& a, const Candidate& b) {
+                return a.distance < b.distance;
+            });
+            result.insert(it, candidate);
+            if (result.size() > k) {
+                result.pop_back();
+            }
+        }
+
+        /**
+         * The offset of the result is stored in offset.x(), the caller maps it to the right axis.
+         */
+        bool nearestEdge(const std::vector<Edge>& edges, qreal position, qreal from, qreal to, qreal radius, Candidate& result) const
+        {
+            Q_ASSERT(_edgesSorted);
+
+            auto it = std::lower_bound(edges.cbegin(), edges.cend(), position - radius, [](const Edge& edge, qreal value) {
+                return edge.position < value;
+            });
+
+            bool found = false;
+            for (; it != edges.cend() && it->position <= position + radius; ++it) {
+                // The edges must face each other
+                if (it->to < from || it->from > to) {
+                    continue;
+                }
+
+                const qreal distance = std::abs(it->position - position);
+                if (!found || it->priority > result.priority || (it->priority == result.priority && distance < result.distance)) {
+                    result = { QPointF(it->position - position, 0), distance, it->priority };
+                    found = true;
+                }
+            }
+
+            return found;
+        }
+
+        qreal _cellSize;
+        std::unordered_map<std::uint64_t, std::vector<Point>> _cells;
+        std::vector<Edge> _verticalEdges;
+        std::vector<Edge> _horizontalEdges;
+        std::size_t _pointCount = 0;
+        bool _edgesSorted = true;
+    };
+
+}
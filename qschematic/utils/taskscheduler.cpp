@@ -0,0 +1,355 @@
+#include <algorithm>
+
+#include "taskscheduler.h"
+
+using namespace QSchematic;
+
+// The scheduler & worker index of the current thread (if it is a worker)
+static thread_local const TaskScheduler* currentScheduler = nullptr;
+static thread_local std::size_t currentWorker = 0;
+
+CancellationToken::CancellationToken() :
+    _cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+void CancellationToken::cancel()
+{
+    _cancelled->store(true);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return _cancelled->load();
+}
+
+/**
+ * Creates a scheduler with the given number of workers. A negative count uses
+ * one worker per hardware thread.
+ */
+TaskScheduler::TaskScheduler(int workerCount) :
+    _pending(0),
+    _nextWorker(0),
+    _stop(false)
+{
+    startWorkers(workerCount);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    stopWorkers();
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler instance;
+
+    return instance;
+}
+
+/**
+ * Changes the number of workers. Tasks which are still queued are kept and
+ * handed over to the new workers.
+ * \remark Must not be called from a task.
+ */
+void TaskScheduler::setWorkerCount(int count)
+{
+    stopWorkers();
+    startWorkers(count);
+}
+
+int TaskScheduler::workerCount() const
+{
+    std::shared_lock lock(_configurationMutex);
+
+    return static_cast<int>(_threads.size());
+}
+
+void TaskScheduler::schedule(Task task, Priority priority)
+{
+    // Sanity check
+    if (!task) {
+        return;
+    }
+
+    {
+        std::shared_lock lock(_configurationMutex);
+
+        // Workers push onto their own queue, everyone else distributes round robin
+        std::size_t index;
+        if (currentScheduler == this) {
+            index = currentWorker;
+        } else {
+            index = _nextWorker++ % _workers.size();
+        }
+
+        Worker& worker = *_workers[index];
+        std::lock_guard workerLock(worker.mutex);
+        worker.queues[priority].push_back(std::move(task));
+        _pending++;
+    }
+
+    // Wake up a sleeping worker
+    {
+        std::lock_guard sleepLock(_sleepMutex);
+    }
+    _wakeUp.notify_one();
+}
+
+/**
+ * Executes one pending task on the calling thread.
+ * \return Whether a task was executed.
+ */
+bool TaskScheduler::runPendingTask()
+{
+    Task task;
+    {
+        std::shared_lock lock(_configurationMutex);
+        const std::size_t index = (currentScheduler == this) ? currentWorker : _nextWorker.load() % _workers.size();
+        if (!findTask(index, task)) {
+            return false;
+        }
+    }
+
+    task();
+
+    return true;
+}
+
+void TaskScheduler::startWorkers(int count)
+{
+    if (count < 0) {
+        count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    std::unique_lock lock(_configurationMutex);
+
+    // Keep the tasks of the previous workers
+    std::vector<std::unique_ptr<Worker>> previousWorkers = std::move(_workers);
+
+    // There's always at least one queue, even without any worker threads
+    _workers.clear();
+    for (int i = 0; i < std::max(1, count); i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (const auto& previousWorker : previousWorkers) {
+        for (int priority = 0; priority < PriorityCount; priority++) {
+            auto& queue = _workers.front()->queues[priority];
+            for (auto& task : previousWorker->queues[priority]) {
+                queue.push_back(std::move(task));
+            }
+        }
+    }
+
+    // Threads
+    _stop = false;
+    for (int i = 0; i < count; i++) {
+        _threads.emplace_back(&TaskScheduler::workerLoop, this, static_cast<std::size_t>(i));
+    }
+}
+
+void TaskScheduler::stopWorkers()
+{
+    {
+        std::lock_guard sleepLock(_sleepMutex);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+void TaskScheduler::workerLoop(std::size_t index)
+{
+    currentScheduler = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        bool found;
+        {
+            std::shared_lock lock(_configurationMutex);
+            found = findTask(index, task);
+        }
+
+        if (found) {
+            task();
+            continue;
+        }
+
+        // Nothing to do, sleep until new tasks arrive
+        std::unique_lock sleepLock(_sleepMutex);
+        _wakeUp.wait(sleepLock, [this] { return _stop || _pending.load() > 0; });
+        if (_stop) {
+            break;
+        }
+    }
+
+    currentScheduler = nullptr;
+}
+
+/**
+ * Finds the next task for a worker. All queues are searched for interactive
+ * tasks before any background task is considered.
+ * \remark The configuration mutex must be held.
+ */
+bool TaskScheduler::findTask(std::size_t index, Task& task)
+{
+    for (int priority = 0; priority < PriorityCount; priority++) {
+        if (takeTask(index, static_cast<Priority>(priority), task) || stealTask(index, static_cast<Priority>(priority), task)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Takes the most recently added task of the given priority from the worker's own queue.
+ * \remark The configuration mutex must be held.
+ */
+bool TaskScheduler::takeTask(std::size_t index, Priority priority, Task& task)
+{
+    Worker& worker = *_workers[index];
+    std::lock_guard workerLock(worker.mutex);
+    auto& queue = worker.queues[priority];
+    if (queue.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.back());
+    queue.pop_back();
+    _pending--;
+
+    return true;
+}
+
+/**
+ * Steals the oldest task of the given priority from the other workers.
+ * \remark The configuration mutex must be held.
+ */
+bool TaskScheduler::stealTask(std::size_t thief, Priority priority, Task& task)
+{
+    const std::size_t count = _workers.size();
+    for (std::size_t offset = 1; offset < count; offset++) {
+        Worker& victim = *_workers[(thief + offset) % count];
+        std::lock_guard workerLock(victim.mutex);
+        auto& queue = victim.queues[priority];
+        if (!queue.empty()) {
+            task = std::move(queue.front());
+            queue.pop_front();
+            _pending--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskScheduler::Priority priority, const CancellationToken& token) :
+    _scheduler(scheduler),
+    _priority(priority),
+    _token(token),
+    _state(std::make_shared<State>())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    // Tasks reference the group's state, make sure they're done
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(TaskScheduler::Task task)
+{
+    // Sanity check
+    if (!task) {
+        return;
+    }
+
+    _state->remaining++;
+    {
+        std::lock_guard lock(_state->mutex);
+        _state->tasks.push_back(std::move(task));
+    }
+
+    // Whoever gets to it first runs the next task of the group: a worker or wait()
+    _scheduler.schedule([state = _state, token = _token] {
+        runQueuedTask(*state, token);
+    }, _priority);
+}
+
+void TaskGroup::wait()
+{
+    // Help out with our own tasks while waiting
+    while (runQueuedTask(*_state, _token)) {
+    }
+
+    // The remaining tasks are running on other threads
+    {
+        std::unique_lock lock(_state->mutex);
+        _state->finished.wait(lock, [this] { return _state->remaining.load() == 0; });
+    }
+
+    // Forward exceptions
+    std::exception_ptr exception;
+    {
+        std::lock_guard lock(_state->mutex);
+        std::swap(exception, _state->exception);
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+/**
+ * Runs the oldest task of the group which didn't start yet.
+ * \return Whether there was such a task.
+ */
+bool TaskGroup::runQueuedTask(State& state, const CancellationToken& token)
+{
+    TaskScheduler::Task task;
+    {
+        std::lock_guard lock(state.mutex);
+        if (state.tasks.empty()) {
+            return false;
+        }
+        task = std::move(state.tasks.front());
+        state.tasks.pop_front();
+    }
+
+    if (!token.isCancelled()) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard lock(state.mutex);
+            if (!state.exception) {
+                state.exception = std::current_exception();
+            }
+        }
+    }
+
+    // Signal the join point
+    if (--state.remaining == 0) {
+        std::lock_guard lock(state.mutex);
+        state.finished.notify_all();
+    }
+
+    return true;
+}
+
+void TaskGroup::cancel()
+{
+    _token.cancel();
+}
+
+const CancellationToken& TaskGroup::token() const
+{
+    return _token;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    /**
+     * A cheap to copy cancellation flag. All copies share the same state.
+     */
+    class QSCHEMATIC_EXPORT CancellationToken
+    {
+    public:
+        CancellationToken();
+
+        void cancel();
+        [[nodiscard]] bool isCancelled() const;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    /**
+     * Library wide work-stealing task scheduler.
+     *
+     * Every worker owns a queue per priority. Tasks scheduled from a worker are
+     * pushed onto its own queue (LIFO), other threads distribute tasks round robin.
+     * Idle workers steal from the opposite end of the other workers' queues.
+     * Interactive tasks are always picked before background tasks, even if that
+     * means stealing while the worker's own queue has background tasks.
+     *
+     * Applications can use the shared instance() for their own work so that the
+     * pool isn't oversubscribed.
+     */
+    class QSCHEMATIC_EXPORT TaskScheduler
+    {
+    public:
+        enum Priority {
+            Interactive = 0,
+            Background,
+
+            PriorityCount
+        };
+
+        using Task = std::function<void()>;
+
+        explicit TaskScheduler(int workerCount = -1);
+        TaskScheduler(const TaskScheduler& other) = delete;
+        TaskScheduler(TaskScheduler&& other) = delete;
+        virtual ~TaskScheduler();
+
+        TaskScheduler& operator=(const TaskScheduler& rhs) = delete;
+        TaskScheduler& operator=(TaskScheduler&& rhs) = delete;
+
+        static TaskScheduler& instance();
+
+        void setWorkerCount(int count);
+        [[nodiscard]] int workerCount() const;
+        void schedule(Task task, Priority priority = Background);
+        bool runPendingTask();
+
+        /**
+         * Schedules a function and returns a future for its result.
+         * \remark With zero workers the task only runs when a thread calls runPendingTask().
+         */
+        template<typename F>
+        auto submit(F&& function, Priority priority = Background) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+            auto future = task->get_future();
+            schedule([task] { (*task)(); }, priority);
+
+            return future;
+        }
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Task> queues[PriorityCount];
+        };
+
+        void startWorkers(int count);
+        void stopWorkers();
+        void workerLoop(std::size_t index);
+        bool findTask(std::size_t index, Task& task);
+        bool takeTask(std::size_t index, Priority priority, Task& task);
+        bool stealTask(std::size_t thief, Priority priority, Task& task);
+
+        mutable std::shared_mutex _configurationMutex;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::vector<std::thread> _threads;
+        std::mutex _sleepMutex;
+        std::condition_variable _wakeUp;
+        std::atomic<int> _pending;
+        std::atomic<std::size_t> _nextWorker;
+        bool _stop;
+    };
+
+    /**
+     * A join point for a set of tasks. wait() blocks until all tasks of the group
+     * have finished, executing the group's pending tasks on the calling thread in
+     * the meantime so that groups can be nested without deadlocking the pool.
+     * Tasks of other groups are left to the workers.
+     * Tasks which didn't start before the group got cancelled are skipped. The
+     * first exception thrown by a task is rethrown by wait().
+     */
+    class QSCHEMATIC_EXPORT TaskGroup
+    {
+    public:
+        explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance(),
+                           TaskScheduler::Priority priority = TaskScheduler::Background,
+                           const CancellationToken& token = CancellationToken());
+        TaskGroup(const TaskGroup& other) = delete;
+        TaskGroup(TaskGroup&& other) = delete;
+        virtual ~TaskGroup();
+
+        TaskGroup& operator=(const TaskGroup& rhs) = delete;
+        TaskGroup& operator=(TaskGroup&& rhs) = delete;
+
+        void run(TaskScheduler::Task task);
+        void wait();
+        void cancel();
+        [[nodiscard]] const CancellationToken& token() const;
+
+    private:
+        struct State
+        {
+            std::atomic<int> remaining { 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::exception_ptr exception;
+            std::deque<TaskScheduler::Task> tasks;      // Not started yet
+        };
+
+        static bool runQueuedTask(State& state, const CancellationToken& token);
+
+        TaskScheduler& _scheduler;
+        TaskScheduler::Priority _priority;
+        CancellationToken _token;
+        std::shared_ptr<State> _state;
+    };
+
+    /**
+     * Calls function(index) for every index in [0, count) and returns once all
+     * calls have completed. Results written to a pre-sized container by index are
+     * therefore deterministic regardless of the execution order.
+     */
+    template<typename F>
+    void parallelFor(int count, F&& function,
+                     TaskScheduler::Priority priority = TaskScheduler::Background,
+                     const CancellationToken& token = CancellationToken(),
+                     TaskScheduler& scheduler = TaskScheduler::instance())
+    {
+        // Sanity check
+        if (count <= 0) {
+            return;
+        }
+
+        // Split into a few chunks per worker to balance the load
+        const int chunkCount = std::max(1, std::min(count, (scheduler.workerCount() + 1) * 4));
+        const int chunkSize = (count + chunkCount - 1) / chunkCount;
+
+        TaskGroup group(scheduler, priority, token);
+        for (int begin = 0; begin < count; begin += chunkSize) {
+            const int end = std::min(count, begin + chunkSize);
+            group.run([&function, &token, begin, end] {
+                for (int i = begin; i < end && !token.isCancelled(); i++) {
+                    function(i);
+                }
+            });
+        }
+        group.wait();
+    }
+
+}
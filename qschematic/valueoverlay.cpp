@@ -0,0 +1,287 @@
+#include <QGuiApplication>
+#include <QScreen>
+#include <QUndoStack>
+
+#include "items/connector.h"
+#include "items/label.h"
+#include "items/wire.h"
+#include "items/wirenet.h"
+#include "wire_system/manager.h"
+#include "scene.h"
+#include "valueoverlay.h"
+
+const qreal DEFAULT_REFRESH_RATE = 60;
+const QColor COLOR_VALUE_LOW     = QColor("#1f4e9c");
+const QColor COLOR_VALUE_HIGH    = QColor("#2e9c3f");
+
+using namespace QSchematic;
+
+ValueOverlay::ValueOverlay(Scene& scene, std::size_t capacity, QObject* parent) :
+    QObject(parent),
+    _scene(scene),
+    _queue(capacity),
+    _dropped(0),
+    _netsChanged(false)
+{
+    // Default styling: zero is low, everything else is high
+    _styler = [](double value) {
+        return Style{ value != 0 ? COLOR_VALUE_HIGH : COLOR_VALUE_LOW, QString::number(value, 'g', 4) };
+    };
+
+    // Drain once per display frame
+    qreal refreshRate = DEFAULT_REFRESH_RATE;
+    if (const QScreen* screen = QGuiApplication::primaryScreen()) {
+        refreshRate = qMax(screen->refreshRate(), 1.0);
+    }
+    _timer.setTimerType(Qt::PreciseTimer);
+    _timer.setInterval(qMax(1, qRound(1000.0 / refreshRate)));
+    connect(&_timer, &QTimer::timeout, this, &ValueOverlay::drain);
+    _timer.start();
+
+    // New wires and commands (eg. connecting wires) can change the wires of a net
+    connect(&_scene, &Scene::itemAdded, this, [this] { _netsChanged = true; });
+    connect(_scene.undoStack(), &QUndoStack::indexChanged, this, [this] { _netsChanged = true; });
+}
+
+/**
+ * Returns the id for the net with the specified name. All WireNets sharing the
+ * name present the value. Unnamed nets have to be addressed by netId(net).
+ */
+quint32 ValueOverlay::netId(const QString& netName)
+{
+    if (netName.isEmpty()) {
+        return InvalidId;
+    }
+
+    auto it = _netNameIds.constFind(netName);
+    if (it != _netNameIds.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = static_cast<quint32>(_nets.count());
+    _nets.append({ netName, { } });
+    _netNameIds.insert(netName, id);
+
+    return id;
+}
+
+/**
+ * Returns the id for a single net regardless of its name.
+ */
+quint32 ValueOverlay::netId(const std::shared_ptr<WireNet>& net)
+{
+    if (!net) {
+        return InvalidId;
+    }
+
+    auto it = _netIds.constFind(net.get());
+    if (it != _netIds.constEnd()) {
+        // The address might have been reused by a new net
+        _nets[static_cast<int>(it.value())].net = net;
+        return it.value();
+    }
+
+    const quint32 id = static_cast<quint32>(_nets.count());
+    _nets.append({ QString(), net });
+    _netIds.insert(net.get(), id);
+
+    return id;
+}
+
+quint32 ValueOverlay::connectorId(const Connector* connector)
+{
+    auto it = _connectorIds.constFind(connector);
+    if (it != _connectorIds.constEnd()) {
+        // The address might have been reused by a new connector
+        _connectors[static_cast<int>(it.value())] = connector;
+        return it.value();
+    }
+
+    const quint32 id = static_cast<quint32>(_connectors.count());
+    _connectors.append(connector);
+    _connectorIds.insert(connector, id);
+
+    return id;
+}
+
+void ValueOverlay::setStyler(const Styler& styler)
+{
+    _styler = styler;
+
+    // Restyle everything on the next frame
+    _values.clear();
+}
+
+void ValueOverlay::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        _timer.start();
+    } else {
+        _timer.stop();
+        clear();
+    }
+}
+
+bool ValueOverlay::isEnabled() const
+{
+    return _timer.isActive();
+}
+
+/**
+ * Discards all pending samples and removes the styling of all targets.
+ */
+void ValueOverlay::clear()
+{
+    Sample sample;
+    while (_queue.tryPop(sample)) {
+    }
+
+    QHash<QString, QList<WireNet*>> netsByName;
+    for (auto it = _values.cbegin(); it != _values.cend(); it++) {
+        const quint32 type = static_cast<quint32>(it.key() >> 32);
+        const quint32 id = static_cast<quint32>(it.key());
+        if (type == NetTarget) {
+            applyNet(id, Style(), netsByName);
+        } else {
+            applyConnector(id, Style());
+        }
+    }
+    _values.clear();
+}
+
+/**
+ * Can be called from any thread. Never blocks.
+ * \return false if the sample was dropped because the buffer is full.
+ */
+bool ValueOverlay::push(const Sample& sample)
+{
+    if (_queue.tryPush(sample)) {
+        return true;
+    }
+
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool ValueOverlay::pushNetValue(quint32 id, double value)
+{
+    return push({ NetTarget, id, value });
+}
+
+bool ValueOverlay::pushConnectorValue(quint32 id, double value)
+{
+    return push({ ConnectorTarget, id, value });
+}
+
+quint64 ValueOverlay::droppedSamples() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+void ValueOverlay::drain()
+{
+    // Coalesce to the latest value per target. Bounded so producers can't starve the GUI thread.
+    QHash<quint64, double> latest;
+    Sample sample;
+    for (std::size_t i = 0; i < _queue.capacity() && _queue.tryPop(sample); i++) {
+        latest.insert(key(sample.type, sample.id), sample.value);
+    }
+
+    // Restyle the nets with a value, their wires might have changed
+    QHash<QString, QList<WireNet*>> netsByName;
+    if (_netsChanged) {
+        _netsChanged = false;
+        for (auto it = _values.cbegin(); it != _values.cend(); it++) {
+            if (static_cast<quint32>(it.key() >> 32) == NetTarget) {
+                applyNet(static_cast<quint32>(it.key()), _styler(it.value()), netsByName);
+            }
+        }
+    }
+
+    // Restyle the targets whose value changed
+    for (auto it = latest.cbegin(); it != latest.cend(); it++) {
+        auto current = _values.constFind(it.key());
+        if (current != _values.constEnd() && current.value() == it.value()) {
+            continue;
+        }
+        _values.insert(it.key(), it.value());
+
+        const Style& style = _styler(it.value());
+        const quint32 type = static_cast<quint32>(it.key() >> 32);
+        const quint32 id = static_cast<quint32>(it.key());
+        if (type == NetTarget) {
+            applyNet(id, style, netsByName);
+        } else {
+            applyConnector(id, style);
+        }
+    }
+}
+
+quint64 ValueOverlay::key(quint32 type, quint32 id)
+{
+    return (static_cast<quint64>(type) << 32) | id;
+}
+
+void ValueOverlay::applyStyle(WireNet& net, const Style& style)
+{
+    for (const auto& wire : net.wires()) {
+        auto w = std::dynamic_pointer_cast<Wire>(wire);
+        if (w) {
+            w->setValueColor(style.color);
+        }
+    }
+
+    const auto& label = net.label();
+    if (label) {
+        label->setValueText(style.text, style.color);
+    }
+}
+
+void ValueOverlay::applyNet(quint32 id, const Style& style, QHash<QString, QList<WireNet*>>& netsByName)
+{
+    // Sanity check
+    if (id >= static_cast<quint32>(_nets.count())) {
+        return;
+    }
+
+    const Net& target = _nets.at(static_cast<int>(id));
+    if (target.name.isEmpty()) {
+        if (auto net = target.net.lock()) {
+            applyStyle(*net, style);
+        }
+        return;
+    }
+
+    // Look up the nets by name once per frame
+    if (netsByName.isEmpty()) {
+        for (const auto& net : _scene.wire_manager()->nets()) {
+            auto wireNet = std::dynamic_pointer_cast<WireNet>(net);
+            if (wireNet) {
+                netsByName[wireNet->name()].append(wireNet.get());
+            }
+        }
+    }
+
+    for (WireNet* wireNet : netsByName.value(target.name)) {
+        applyStyle(*wireNet, style);
+    }
+}
+
+void ValueOverlay::applyConnector(quint32 id, const Style& style)
+{
+    // Sanity check
+    if (id >= static_cast<quint32>(_connectors.count())) {
+        return;
+    }
+
+    const Connector* connector = _connectors.at(static_cast<int>(id));
+    if (!connector || !connector->label()) {
+        return;
+    }
+
+    connector->label()->setValueText(style.text, style.color);
+}
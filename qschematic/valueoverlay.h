@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <QColor>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include "utils/ringbuffer.h"
+#include "qschematic_export.h"
+
+namespace QSchematic
+{
+
+    class Scene;
+    class Connector;
+    class WireNet;
+
+    /**
+     * Presents live values (eg. from a simulation) on nets and connectors.
+     *
+     * Producers push samples from any thread into a lock-free ring buffer. Pushing
+     * never blocks, samples are dropped if the buffer is full. The GUI thread drains
+     * the buffer once per display frame, keeps only the latest value per target and
+     * restyles the wires & labels of the targets whose value actually changed.
+     *
+     * Targets are addressed by ids obtained from netId() and connectorId() on the
+     * GUI thread. Wires joining a net with a value get styled on the next frame,
+     * wires leaving a net lose its styling right away.
+     */
+    class QSCHEMATIC_EXPORT ValueOverlay : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(ValueOverlay)
+
+    public:
+        enum TargetType : quint32 {
+            NetTarget,
+            ConnectorTarget
+        };
+
+        struct Sample
+        {
+            quint32 type;
+            quint32 id;
+            double value;
+        };
+
+        struct Style
+        {
+            QColor color;
+            QString text;
+        };
+
+        using Styler = std::function<Style(double value)>;
+
+        static constexpr quint32 InvalidId = 0xffffffff;      // Samples for it are ignored
+
+        explicit ValueOverlay(Scene& scene, std::size_t capacity = 65536, QObject* parent = nullptr);
+        virtual ~ValueOverlay() override = default;
+
+        quint32 netId(const QString& netName);
+        quint32 netId(const std::shared_ptr<WireNet>& net);
+        quint32 connectorId(const Connector* connector);
+        void setStyler(const Styler& styler);
+        void setEnabled(bool enabled);
+        bool isEnabled() const;
+        void clear();
+
+        bool push(const Sample& sample);
+        bool pushNetValue(quint32 id, double value);
+        bool pushConnectorValue(quint32 id, double value);
+        quint64 droppedSamples() const;
+
+    private slots:
+        void drain();
+
+    private:
+        struct Net
+        {
+            QString name;                   // Empty if the target is a single net
+            std::weak_ptr<WireNet> net;
+        };
+
+        static quint64 key(quint32 type, quint32 id);
+        static void applyStyle(WireNet& net, const Style& style);
+        void applyNet(quint32 id, const Style& style, QHash<QString, QList<WireNet*>>& netsByName);
+        void applyConnector(quint32 id, const Style& style);
+
+        Scene& _scene;
+        RingBuffer<Sample> _queue;
+        std::atomic<quint64> _dropped;
+        QTimer _timer;
+        Styler _styler;
+        QVector<Net> _nets;                                     // By id
+        QHash<QString, quint32> _netNameIds;
+        QHash<const WireNet*, quint32> _netIds;
+        QVector<QPointer<const Connector>> _connectors;         // By id
+        QHash<const Connector*, quint32> _connectorIds;
+        QHash<quint64, double> _values;                         // Presented values by key
+        bool _netsChanged;                                      // Wires might have joined a net
+    };
+
+}
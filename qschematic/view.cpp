@@ -1,10 +1,17 @@
 #include <QKeyEvent>
+#include <QClipboard>
+#include <QGuiApplication>
 #include <QWheelEvent>
 #include <QScrollBar>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QUndoStack>
+#include <algorithm>
 
 #include "commands/commanditemremove.h"
 #include "view.h"
 #include "scene.h"
+#include "sceneextents.h"
 #include "settings.h"
 
 const qreal ZOOM_FACTOR_MIN   = 0.25;
@@ -12,13 +19,19 @@ const qreal ZOOM_FACTOR_MAX   = 10.00;
 const qreal ZOOM_FACTOR_STEPS = 0.10;
 const qreal FIT_ALL_PADDING   = 20.00;
 
+const qint64 DEBUG_PROFILE_INTERVAL_MS = 250;
+const int DEBUG_SLOWEST_ITEMS_COUNT    = 5;
+const int DEBUG_OVERLAY_PADDING        = 8;
+
 using namespace QSchematic;
 
 View::View(QWidget* parent) :
     QGraphicsView(parent),
     _scene(nullptr),
     _scaleFactor(1.0),
-    _mode(NormalMode)
+    _mode(NormalMode),
+    _profileNsecs(0),
+    _reducedQuality(false)
 {
     // Scroll bars
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
@@ -31,6 +44,18 @@ View::View(QWidget* parent) :
 
     // Rendering options
     setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+
+    // Adaptive render quality
+    _qualityTimer.setSingleShot(true);
+    connect(&_qualityTimer, &QTimer::timeout, this, &View::restoreQuality);
+}
+
+View::~View()
+{
+    // Don't leave the scene in the reduced quality profile, unless it's gone already
+    if (_reducedQuality && _scene) {
+        _scene->releaseReducedQuality();
+    }
 }
 
 void View::keyPressEvent(QKeyEvent* event)
@@ -66,6 +91,19 @@ void View::keyPressEvent(QKeyEvent* event)
             }
             return;
 
+        case Qt::Key_C:
+            if (_scene && _scene->mode() == Scene::NormalMode) {
+                QGuiApplication::clipboard()->setMimeData(_scene->copySelection());
+            }
+            return;
+
+        case Qt::Key_V:
+            if (_scene && _scene->mode() == Scene::NormalMode) {
+                const qreal offset = _settings.gridSize;
+                _scene->paste(QGuiApplication::clipboard()->mimeData(), QPointF(offset, offset));
+            }
+            return;
+
         default:
             break;
         }
@@ -120,8 +158,18 @@ void View::wheelEvent(QWheelEvent* event)
 
 void View::mouseMoveEvent(QMouseEvent *event)
 {
+    // Dragging items, wires or the rubber band
+    if (event->buttons() != Qt::NoButton) {
+        interactionStarted();
+    }
+
     QGraphicsView::mouseMoveEvent(event);
 
+    // Keep the hit-test counter of the debug overlay up to date
+    if (_settings.debug) {
+        viewport()->update();
+    }
+
     switch (_mode) {
     case NormalMode:
         break;
@@ -160,9 +208,185 @@ void View::mouseReleaseEvent(QMouseEvent *event)
     QGraphicsView::mouseReleaseEvent(event);
 }
 
+void View::paintEvent(QPaintEvent* event)
+{
+    // Only measure when the overlay is being shown or the adaptive quality needs it
+    if (!_settings.debug && !_settings.adaptiveQuality) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    _profileNsecs = 0;
+
+    QGraphicsView::paintEvent(event);
+
+    // The item profiling of the debug overlay isn't part of the frame itself
+    const qint64 nsecs = timer.nsecsElapsed() - _profileNsecs;
+    _frameStatistics.paintTimeNsecs = nsecs;
+    _frameStatistics.reducedQuality = _reducedQuality;
+    if (_reducedQuality) {
+        _frameStatistics.reducedQualityNsecs = nsecs;
+        _frameStatistics.reducedQualityFrames++;
+    } else {
+        _frameStatistics.fullQualityNsecs = nsecs;
+    }
+
+    emit frameStatisticsChanged(_frameStatistics);
+}
+
+void View::scrollContentsBy(int dx, int dy)
+{
+    // Panning, scrolling or dragging the scroll bars
+    interactionStarted();
+
+    QGraphicsView::scrollContentsBy(dx, dy);
+}
+
+void View::drawForeground(QPainter* painter, const QRectF& rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    // Debug overlay
+    if (_settings.debug && _scene) {
+        updateFrameStatistics(rect);
+        drawDebugOverlay(*painter);
+    }
+}
+
+void View::updateFrameStatistics(const QRectF& exposedRect)
+{
+    // Items painted vs. culled
+    const QList<QGraphicsItem*>& exposedItems = _scene->QGraphicsScene::items(exposedRect, Qt::IntersectsItemBoundingRect);
+    QList<QGraphicsItem*> paintedItems;
+    paintedItems.reserve(exposedItems.count());
+    for (QGraphicsItem* item : exposedItems) {
+        if (item->isVisible()) {
+            paintedItems << item;
+        }
+    }
+    _frameStatistics.itemsPainted = paintedItems.count();
+    _frameStatistics.itemsCulled = _scene->QGraphicsScene::items().count() - paintedItems.count();
+
+    // Interaction
+    _frameStatistics.hitTests = _scene->hitTestsLastMouseEvent();
+    _frameStatistics.undoStackSize = _scene->undoStack()->count();
+
+    // Profiling every single item is expensive, don't do it every frame
+    if (!_profileTimer.isValid() || _profileTimer.elapsed() >= DEBUG_PROFILE_INTERVAL_MS) {
+        QElapsedTimer timer;
+        timer.start();
+        profileItemPaintTimes(paintedItems);
+        _profileNsecs += timer.nsecsElapsed();
+        _profileTimer.start();
+    }
+}
+
+/**
+ * Measures the paint time of each item by painting it into an off-screen image
+ * using the current view transform.
+ */
+void View::profileItemPaintTimes(const QList<QGraphicsItem*>& items)
+{
+    // (Re-)Allocate the off-screen buffer
+    const QSize& size = viewport()->size();
+    if (_profileImage.size() != size) {
+        _profileImage = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    }
+
+    _itemPaintTimes.clear();
+    _itemPaintTimes.reserve(items.count());
+
+    QPainter painter(&_profileImage);
+    painter.setRenderHint(QPainter::Antialiasing, _settings.antialiasing && !_reducedQuality);
+    QElapsedTimer timer;
+    for (QGraphicsItem* item : items) {
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item->boundingRect();
+        option.state = item->isSelected() ? QStyle::State_Selected : QStyle::State_None;
+
+        painter.save();
+        painter.setTransform(item->sceneTransform() * viewportTransform());
+        timer.start();
+        item->paint(&painter, &option, viewport());
+        const qint64 nsecs = timer.nsecsElapsed();
+        painter.restore();
+
+        _itemPaintTimes.append({ item->sceneBoundingRect(), item->type(), nsecs });
+    }
+
+    // Sort by paint time
+    std::sort(_itemPaintTimes.begin(), _itemPaintTimes.end(), [](const auto& a, const auto& b) {
+        return a.nsecs > b.nsecs;
+    });
+
+    _frameStatistics.slowestItems = _itemPaintTimes.mid(0, DEBUG_SLOWEST_ITEMS_COUNT);
+}
+
+void View::drawDebugOverlay(QPainter& painter) const
+{
+    painter.save();
+
+    // Heat boxes (scene coordinates)
+    if (!_itemPaintTimes.isEmpty()) {
+        const qreal maxNsecs = std::max<qint64>(1, _itemPaintTimes.first().nsecs);
+        painter.setBrush(Qt::NoBrush);
+        for (const auto& entry : _itemPaintTimes) {
+            // Green (fast) to red (slow)
+            const qreal heat = entry.nsecs / maxNsecs;
+            QColor color = QColor::fromHsvF((1.0 - heat) / 3.0, 1.0, 1.0);
+            color.setAlphaF(0.25 + 0.5 * heat);
+            QPen pen(color);
+            pen.setCosmetic(true);
+            pen.setWidth(2);
+            painter.setPen(pen);
+            painter.drawRect(entry.sceneRect);
+        }
+    }
+
+    // Text (viewport coordinates)
+    painter.resetTransform();
+    QStringList lines;
+    lines << QStringLiteral("Paint: %1 ms").arg(_frameStatistics.paintTimeNsecs / 1.0e6, 0, 'f', 2);
+    lines << QStringLiteral("Items painted: %1, culled: %2").arg(_frameStatistics.itemsPainted).arg(_frameStatistics.itemsCulled);
+    lines << QStringLiteral("Hit-tests (last mouse event): %1").arg(_frameStatistics.hitTests);
+    lines << QStringLiteral("Undo stack: %1").arg(_frameStatistics.undoStackSize);
+    if (_settings.adaptiveQuality) {
+        lines << QStringLiteral("Quality: %1 (full: %2 ms, reduced: %3 ms, %4 frames)")
+                     .arg(_frameStatistics.reducedQuality ? QStringLiteral("reduced") : QStringLiteral("full"))
+                     .arg(_frameStatistics.fullQualityNsecs / 1.0e6, 0, 'f', 2)
+                     .arg(_frameStatistics.reducedQualityNsecs / 1.0e6, 0, 'f', 2)
+                     .arg(_frameStatistics.reducedQualityFrames);
+    }
+    for (const auto& entry : _frameStatistics.slowestItems) {
+        lines << QStringLiteral("  type %1: %2 us").arg(entry.itemType).arg(entry.nsecs / 1.0e3, 0, 'f', 1);
+    }
+    const QString& text = lines.join(QLatin1Char('\n'));
+
+    const QFontMetrics metrics(painter.font());
+    QRect textRect = metrics.boundingRect(QRect(0, 0, viewport()->width(), viewport()->height()), Qt::AlignLeft | Qt::AlignTop, text);
+    textRect.moveTopLeft(QPoint(DEBUG_OVERLAY_PADDING, DEBUG_OVERLAY_PADDING));
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 160));
+    painter.drawRect(textRect.adjusted(-DEBUG_OVERLAY_PADDING/2, -DEBUG_OVERLAY_PADDING/2, DEBUG_OVERLAY_PADDING/2, DEBUG_OVERLAY_PADDING/2));
+    painter.setPen(Qt::white);
+    painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+
+    painter.restore();
+}
+
 void View::setScene(Scene* scene)
 {
+    // Don't leave the previous scene in the reduced quality profile
+    restoreQuality();
+    if (_scene) {
+        disconnect(_scene, &QObject::destroyed, this, &View::sceneDestroyed);
+    }
+
     if (scene) {
+        connect(scene, &QObject::destroyed, this, &View::sceneDestroyed);
         connect(scene, &Scene::modeChanged, [this](int newMode){
             switch (newMode) {
             case Scene::NormalMode:
@@ -189,7 +413,15 @@ void View::setSettings(const Settings& settings)
     _settings = settings;
 
     // Rendering options
-    setRenderHint(QPainter::Antialiasing, _settings.antialiasing);
+    if (!_settings.adaptiveQuality) {
+        restoreQuality();
+    }
+    applyRenderHints();
+
+    // Discard stale debug data
+    _itemPaintTimes.clear();
+    _frameStatistics = FrameStatistics();
+    viewport()->update();
 }
 
 void View::setZoomValue(qreal factor)
@@ -201,6 +433,8 @@ void View::setZoomValue(qreal factor)
 
 void View::updateScale()
 {
+    interactionStarted();
+
     // Apply the new scale
     setTransform(QTransform::fromScale(_scaleFactor, _scaleFactor));
 
@@ -214,11 +448,79 @@ void View::setMode(Mode newMode)
     emit modeChanged(_mode);
 }
 
+/**
+ * Switches to the reduced quality profile while the user is panning, zooming
+ * or dragging. Full quality is restored once no interaction happened for
+ * Settings::adaptiveQualityIdleMs.
+ */
+void View::interactionStarted()
+{
+    if (!_settings.adaptiveQuality) {
+        return;
+    }
+
+    if (!_reducedQuality) {
+        // Not worth it if full quality frames are cheap enough anyway
+        if (_frameStatistics.fullQualityNsecs < qint64(_settings.adaptiveQualityFrameMs) * 1000000) {
+            return;
+        }
+
+        _reducedQuality = true;
+        applyRenderHints();
+        if (_scene) {
+            _scene->acquireReducedQuality();
+        }
+    }
+
+    _qualityTimer.start(_settings.adaptiveQualityIdleMs);
+}
+
+void View::restoreQuality()
+{
+    _qualityTimer.stop();
+
+    if (!_reducedQuality) {
+        return;
+    }
+
+    _reducedQuality = false;
+    applyRenderHints();
+    if (_scene) {
+        _scene->releaseReducedQuality();
+    }
+    viewport()->update();
+}
+
+/**
+ * The scene went away while this view still shows it. There is nothing left to
+ * release, only the pending quality restore has to be dropped.
+ */
+void View::sceneDestroyed()
+{
+    _qualityTimer.stop();
+
+    if (_reducedQuality) {
+        _reducedQuality = false;
+        applyRenderHints();
+    }
+}
+
+void View::applyRenderHints()
+{
+    setRenderHint(QPainter::Antialiasing, _settings.antialiasing && !_reducedQuality);
+    setRenderHint(QPainter::TextAntialiasing, !_reducedQuality);
+}
+
 qreal View::zoomValue() const
 {
     return _scaleFactor;
 }
 
+const FrameStatistics& View::frameStatistics() const
+{
+    return _frameStatistics;
+}
+
 void View::fitInView()
 {
     // Check if there is a scene
@@ -226,13 +528,8 @@ void View::fitInView()
         return;
     }
 
-    // Find the combined bounding rect of all the items
-    QRectF rect;
-    for (const auto& item : _scene->QGraphicsScene::items()) {
-        QRectF boundingRect = item->boundingRect();
-        boundingRect.moveTo(item->scenePos());
-        rect = rect.united(boundingRect);
-    }
+    // The combined bounding rect of all the items is kept up to date by the scene
+    QRectF rect = _scene->sceneExtents()->bounds();
 
     // Add some padding
     const auto& adj = std::max(0.0, FIT_ALL_PADDING);
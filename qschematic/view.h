@@ -1,11 +1,42 @@
 #pragma once
 
 #include <QGraphicsView>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
 #include "scene.h"
 #include "qschematic_export.h"
 
 namespace QSchematic {
 
+    /**
+     * Rendering & interaction statistics gathered by the View while the debug
+     * mode or the adaptive render quality is enabled. These are shown in the
+     * debug overlay.
+     */
+    struct FrameStatistics
+    {
+        struct ItemPaintTime
+        {
+            QRectF sceneRect;
+            int itemType = 0;
+            qint64 nsecs = 0;
+        };
+
+        qint64 paintTimeNsecs = 0;              // Duration of the last paint event, without item profiling
+        qint64 fullQualityNsecs = 0;            // Duration of the last paint event using full quality
+        qint64 reducedQualityNsecs = 0;         // Duration of the last paint event using reduced quality
+        int reducedQualityFrames = 0;           // Frames painted using reduced quality so far
+        bool reducedQuality = false;            // Whether the last frame was painted using reduced quality
+        int itemsPainted = 0;                   // Visible items intersecting the exposed area
+        int itemsCulled = 0;                    // Items outside of the exposed area
+        int hitTests = 0;                       // Hit-tests performed by the last mouse event
+        int undoStackSize = 0;
+        QVector<ItemPaintTime> slowestItems;    // Sorted, slowest first
+    };
+
     class QSCHEMATIC_EXPORT View :
         public QGraphicsView
     {
@@ -19,15 +50,17 @@ namespace QSchematic {
         };
 
         explicit View(QWidget* parent = nullptr);
-        virtual ~View() override = default;
+        virtual ~View() override;
 
         void setScene(Scene* scene);
         void setSettings(const Settings& settings);
         qreal zoomValue() const;
+        const FrameStatistics& frameStatistics() const;
 
     signals:
         void zoomChanged(qreal factor);
         void modeChanged(Mode newMode);
+        void frameStatisticsChanged(const FrameStatistics& statistics);
 
     public slots:
         void setZoomValue(qreal factor);
@@ -39,15 +72,32 @@ namespace QSchematic {
         virtual void mouseMoveEvent(QMouseEvent* event) override;
         virtual void mousePressEvent(QMouseEvent* event) override;
         virtual void mouseReleaseEvent(QMouseEvent* event) override;
+        virtual void paintEvent(QPaintEvent* event) override;
+        virtual void scrollContentsBy(int dx, int dy) override;
+        virtual void drawForeground(QPainter* painter, const QRectF& rect) override;
 
     private:
         void updateScale();
         void setMode(Mode newMode);
+        void interactionStarted();
+        void restoreQuality();
+        void sceneDestroyed();
+        void applyRenderHints();
+        void updateFrameStatistics(const QRectF& exposedRect);
+        void profileItemPaintTimes(const QList<QGraphicsItem*>& items);
+        void drawDebugOverlay(QPainter& painter) const;
 
-        Scene* _scene;
+        QPointer<Scene> _scene;                 // Cleared if the scene is destroyed before the view
         Settings _settings;
         qreal _scaleFactor;
         Mode _mode;
         QPoint _panStart;
+        FrameStatistics _frameStatistics;
+        QVector<FrameStatistics::ItemPaintTime> _itemPaintTimes;
+        QElapsedTimer _profileTimer;
+        qint64 _profileNsecs;                   // Spent profiling the items during the current paint event
+        QImage _profileImage;
+        QTimer _qualityTimer;
+        bool _reducedQuality;
     };
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <QSet>
 #include <QVector>
 #include <QVector2D>
 #include "manager.h"
@@ -23,6 +25,10 @@ void manager::add_net(const std::shared_ptr<net> wireNet)
 
     // Keep track of stuff
     m_nets.append(wireNet);
+    m_net_names.insert(wireNet.get(), wireNet->name());
+    if (!wireNet->name().isEmpty()) {
+        m_nets_by_name[wireNet->name()].append(wireNet.get());
+    }
 }
 
 /**
@@ -33,6 +39,41 @@ QList<std::shared_ptr<net>> manager::nets() const
     return m_nets;
 }
 
+/**
+ * Returns the nets with the given name in the order they were added. This is
+ * looked up in an index which is kept up to date as nets are added, removed
+ * and renamed.
+ */
+QVector<net*> manager::nets_named(const QString& name) const
+{
+    return m_nets_by_name.value(name);
+}
+
+/**
+ * Updates the name index, called by net::set_name(). Nets which aren't part of
+ * this manager are ignored.
+ */
+void manager::net_renamed(net* net)
+{
+    auto it = m_net_names.find(net);
+    if (it == m_net_names.end() || it.value() == net->name()) {
+        return;
+    }
+
+    const QString& previousName = it.value();
+    if (!previousName.isEmpty()) {
+        auto& nets = m_nets_by_name[previousName];
+        nets.removeAll(net);
+        if (nets.isEmpty()) {
+            m_nets_by_name.remove(previousName);
+        }
+    }
+    it.value() = net->name();
+    if (!net->name().isEmpty()) {
+        m_nets_by_name[net->name()].append(net);
+    }
+}
+
 /**
  * Returns a list of all the wires
  */
@@ -108,11 +149,51 @@ bool manager::merge_nets(std::shared_ptr<net>& net, std::shared_ptr<wire_system:
 void manager::remove_net(std::shared_ptr<net> net)
 {
     m_nets.removeAll(net);
+    unindex_net(net.get());
+}
+
+/**
+ * Removes several nets at once. Unlike calling remove_net() for each of them
+ * the list of nets is only walked once.
+ */
+void manager::remove_nets(const QVector<std::shared_ptr<net>>& nets)
+{
+    QSet<const net*> removed;
+    for (const auto& net : nets) {
+        if (net) {
+            removed.insert(net.get());
+            unindex_net(net.get());
+        }
+    }
+
+    m_nets.erase(std::remove_if(m_nets.begin(), m_nets.end(), [&removed](const std::shared_ptr<net>& net) {
+        return removed.contains(net.get());
+    }), m_nets.end());
+}
+
+/**
+ * Removes the net from the name index
+ */
+void manager::unindex_net(net* net)
+{
+    if (!m_net_names.contains(net)) {
+        return;
+    }
+    const QString& name = m_net_names.take(net);
+    if (!name.isEmpty()) {
+        auto& nets = m_nets_by_name[name];
+        nets.removeAll(net);
+        if (nets.isEmpty()) {
+            m_nets_by_name.remove(name);
+        }
+    }
 }
 
 void manager::clear()
 {
     m_nets.clear();
+    m_net_names.clear();
+    m_nets_by_name.clear();
 }
 
 bool manager::remove_wire(const std::shared_ptr<wire> wire)
@@ -313,6 +394,7 @@ void manager::attach_wire_to_connector(wire* wire, int index, const connectable*
     }
 
     m_connections.insert(connector, {wire, index });
+    m_wire_connectors[wire].append(connector);
 }
 
 /**
@@ -332,14 +414,23 @@ void manager::attach_wire_to_connector(wire* wire, const connectable* connector)
     }
 }
 
+/**
+ * Attaches each connector to the wire that has an extremity at its position.
+ * This is used to restore the connections after loading a file.
+ */
+void manager::attach_connectors(const QVector<const connectable*>& connectors)
+{
+    for (const auto* connector : connectors) {
+        if (auto wire = wire_with_extremity_at(connector->position())) {
+            attach_wire_to_connector(wire.get(), connector);
+        }
+    }
+}
+
 void manager::point_inserted(const wire* wire, int index)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
+    for (const auto& connector : attached_connectors(wire)) {
         auto wirePoint = m_connections.value(connector);
-        if (m_connections.value(connector).first != wire) {
-            continue;
-        }
         // Do nothing if the connected point is the first
         if (wirePoint.second == 0) {
             continue;
@@ -355,12 +446,8 @@ void manager::point_inserted(const wire* wire, int index)
 
 void manager::point_removed(const wire* wire, int index)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
+    for (const auto& connector : attached_connectors(wire)) {
         auto wirePoint = m_connections.value(connector);
-        if (m_connections.value(connector).first != wire) {
-            continue;
-        }
         if (wirePoint.second >= index) {
             wirePoint.second--;
         }
@@ -371,8 +458,19 @@ void manager::point_removed(const wire* wire, int index)
 
 void manager::detach_wire(const connectable* connector)
 {
-    const auto& wire = m_connections.value(connector).first;
-    m_connections.remove(connector);
+    const auto it = m_connections.find(connector);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    auto connectors = m_wire_connectors.find(it.value().first);
+    if (connectors != m_wire_connectors.end()) {
+        connectors->removeOne(connector);
+        if (connectors->isEmpty()) {
+            m_wire_connectors.erase(connectors);
+        }
+    }
+    m_connections.erase(it);
 }
 
 std::shared_ptr<wire> manager::wire_with_extremity_at(const QPointF& point)
@@ -389,12 +487,7 @@ std::shared_ptr<wire> manager::wire_with_extremity_at(const QPointF& point)
 
 void manager::detach_wire_from_all(const wire* wire)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
-        if (m_connections.value(connector).first != wire) {
-            continue;
-        }
-
+    for (const auto& connector : m_wire_connectors.take(wire)) {
         m_connections.remove(connector);
     }
 }
@@ -415,12 +508,21 @@ int manager::attached_point(const connectable* connector)
     return m_connections.value(connector).second;
 }
 
+/**
+ * Returns the connectors the wire is attached to
+ */
+QVector<const connectable*> manager::attached_connectors(const wire* wire) const
+{
+    return m_wire_connectors.value(wire);
+}
+
 void manager::connector_moved(const connectable* connector)
 {
-    if (!m_connections.contains(connector)) {
+    const auto it = m_connections.constFind(connector);
+    if (it == m_connections.cend()) {
         return;
     }
-    const auto wirePoint = m_connections.value(connector);
+    const auto wirePoint = it.value();
 
     if (wirePoint.second < -1 || wirePoint.first->points_count() <= wirePoint.second) {
         return;
@@ -434,21 +536,102 @@ void manager::connector_moved(const connectable* connector)
 }
 
 /**
- * Returns whether the wire's point is attached to a connector
+ * Updates the wires attached to a set of connectors that have all been moved
+ * already (e.g. when a node got resized or rotated). The connectors are grouped
+ * by wire so that the moves of each wire are computed up front and applied in
+ * one go. Connectors without a wire are skipped without further work.
  */
-bool manager::point_is_attached(wire_system::wire* wire, int index)
+void manager::connectors_moved(const QVector<const connectable*>& connectors)
 {
-    for (const auto& wire_point : m_connections.values()) {
-        if (wire_point.first != wire) {
+    if (m_connections.isEmpty()) {
+        return;
+    }
+
+    // Gather the target position of every attached point, grouped by wire
+    QHash<wire*, QVector<QPair<const connectable*, QPointF>>> moves;
+    for (const auto& connector : connectors) {
+        const auto it = m_connections.constFind(connector);
+        if (it == m_connections.cend()) {
             continue;
         }
-        if (wire_point.second == index) {
+        moves[it.value().first].append({ connector, connector->position() });
+    }
+
+    for (auto it = moves.begin(); it != moves.end(); ++it) {
+        wire* wire = it.key();
+        auto& targets = it.value();
+
+        // Apply the moves from the last point to the first. Points only get inserted
+        // in front of the last point so the indices still to be moved stay valid.
+        std::sort(targets.begin(), targets.end(), [this](const auto& a, const auto& b) {
+            return m_connections.value(a.first).second > m_connections.value(b.first).second;
+        });
+
+        for (const auto& target : targets) {
+            const int index = m_connections.value(target.first).second;
+            if (index < 0 || wire->points_count() <= index) {
+                continue;
+            }
+
+            const QVector2D moveBy(target.second - wire->points().at(index).toPointF());
+            if (!moveBy.isNull()) {
+                wire->move_point_by(index, moveBy);
+            }
+        }
+    }
+}
+
+/**
+ * Returns whether the wire's point is attached to a connector
+ */
+bool manager::point_is_attached(wire_system::wire* wire, int index)
+{
+    for (const auto& connector : attached_connectors(wire)) {
+        if (m_connections.value(connector).second == index) {
             return true;
         }
     }
     return false;
 }
 
+/**
+ * Returns an estimate of the memory used by the nets, wires and connections
+ * managed by this manager. This only walks the bookkeeping structures and is
+ * cheap enough to be polled periodically.
+ */
+memory_usage manager::memory_stats() const
+{
+    memory_usage stats;
+
+    stats.nets = m_nets.count();
+    stats.bytes += m_nets.count() * (sizeof(net) + sizeof(std::shared_ptr<net>));
+
+    for (const auto& net : m_nets) {
+        for (const auto& wire : net->wires()) {
+            if (!wire) {
+                continue;
+            }
+
+            const int pointsCount = wire->points_count();
+            const int connectedCount = wire->connected_wires().count();
+
+            stats.wires++;
+            stats.points += pointsCount;
+            stats.junctions += wire->junctions().count();
+            stats.wire_connections += connectedCount;
+            stats.bytes += sizeof(class wire) + sizeof(std::weak_ptr<class wire>);
+            stats.bytes += pointsCount * sizeof(point);
+            stats.bytes += connectedCount * sizeof(class wire*);
+        }
+    }
+
+    stats.connector_attachments = m_connections.count();
+    stats.bytes += m_connections.count() * (sizeof(const connectable*) + sizeof(QPair<wire*, int>));
+    stats.bytes += m_connections.count() * sizeof(const connectable*) + m_wire_connectors.count() * sizeof(const wire*);
+
+    return stats;
+}
+
 void manager::set_settings(const Settings& settings)
 {
     m_settings = settings;
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QMap>
+#include <QVector>
 #include <memory>
 #include <optional>
 
@@ -23,6 +25,22 @@ class net;
 class wire;
 class connectable;
 
+/**
+ * Approximate memory footprint of the wire system. The byte count is an
+ * estimate based on the size of the bookkeeping structures, it does not
+ * account for allocator overhead.
+ */
+struct memory_usage
+{
+    std::size_t nets = 0;
+    std::size_t wires = 0;
+    std::size_t points = 0;
+    std::size_t junctions = 0;
+    std::size_t wire_connections = 0;
+    std::size_t connector_attachments = 0;
+    std::size_t bytes = 0;
+};
+
 class QSCHEMATIC_EXPORT manager :
     public QObject
 {
@@ -41,10 +59,13 @@ public:
 
     void add_net(const std::shared_ptr<net> wireNet);
     [[nodiscard]] QList<std::shared_ptr<net>> nets() const;
+    [[nodiscard]] QVector<net*> nets_named(const QString& name) const;
+    void net_renamed(net* net);
     [[nodiscard]] QList<std::shared_ptr<wire>> wires() const;
     void generate_junctions();
     void connect_wire(wire* wire, wire_system::wire* rawWire, std::size_t point);
     void remove_net(std::shared_ptr<net> net);
+    void remove_nets(const QVector<std::shared_ptr<net>>& nets);
     void clear();
     bool remove_wire(const std::shared_ptr<wire> wire);
     [[nodiscard]] QVector<std::shared_ptr<wire>> wires_connected_to(const std::shared_ptr<wire>& wire) const;
@@ -52,8 +73,10 @@ public:
     bool add_wire(const std::shared_ptr<wire>& wire);
     void attach_wire_to_connector(wire* wire, int index, const connectable* connector);
     void attach_wire_to_connector(wire* wire, const connectable* connector);
+    void attach_connectors(const QVector<const connectable*>& connectors);
     [[nodiscard]] wire* attached_wire(const connectable* connector);
     [[nodiscard]] int attached_point(const connectable* connector);
+    [[nodiscard]] QVector<const connectable*> attached_connectors(const wire* wire) const;
     void detach_wire(const connectable* connector);
     [[nodiscard]] std::shared_ptr<wire> wire_with_extremity_at(const QPointF& point);
     void point_inserted(const wire* wire, int index);
@@ -64,6 +87,8 @@ public:
     void point_moved_by_user(wire& rawWire, int index);
     void set_net_factory(std::function<std::shared_ptr<net>()> func);
     void connector_moved(const connectable* connector);
+    void connectors_moved(const QVector<const connectable*>& connectors);
+    [[nodiscard]] memory_usage memory_stats() const;
 
 signals:
     void wire_point_moved(wire& wire, int index);
@@ -72,11 +97,15 @@ private:
     [[nodiscard]] static bool merge_nets(std::shared_ptr<wire_system::net>& net, std::shared_ptr<wire_system::net>& otherNet);
 
     void detach_wire_from_all(const wire* wire);
+    void unindex_net(net* net);
     [[nodiscard]] std::shared_ptr<net> create_net();
 
     QList<std::shared_ptr<net>> m_nets;
+    QHash<const net*, QString> m_net_names;                             // Name of each net in m_nets
+    QHash<QString, QVector<net*>> m_nets_by_name;                       // Reverse of m_net_names, without unnamed nets
     Settings m_settings;
     QMap<const connectable*, QPair<wire*, int>> m_connections;
+    QHash<const wire*, QVector<const connectable*>> m_wire_connectors;     // Reverse of m_connections
     std::optional<std::function<std::shared_ptr<net>()>> m_net_factory;
 };
 
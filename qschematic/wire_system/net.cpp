@@ -2,6 +2,7 @@
 
 #include <QString>
 #include "wire.h"
+#include "manager.h"
 
 using namespace wire_system;
 
@@ -18,6 +19,11 @@ void net::set_name(const std::string& name)
 void net::set_name(const QString& name)
 {
     m_name = name;
+
+    // Keep the name index of the manager up to date
+    if (m_manager) {
+        m_manager->net_renamed(this);
+    }
 }
 
 QString net::name() const
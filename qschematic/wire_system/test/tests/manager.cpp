@@ -154,6 +154,40 @@ TEST_SUITE("Manager")
         }
     }
 
+    TEST_CASE ("attached_connectors(): Looking up the connectors of a wire")
+    {
+        wire_system::manager manager;
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 10});
+        wire->append_point({10, 10});
+        manager.add_wire(wire);
+
+        connector conn1;
+        conn1.pos = QPointF(0, 10);
+        connector conn2;
+        conn2.pos = QPointF(10, 10);
+        manager.attach_wire_to_connector(wire.get(), &conn1);
+        manager.attach_wire_to_connector(wire.get(), &conn2);
+
+        REQUIRE(manager.attached_connectors(wire.get()).count() == 2);
+
+        SUBCASE("Detaching a single connector") {
+            manager.detach_wire(&conn1);
+
+            const auto connectors = manager.attached_connectors(wire.get());
+            REQUIRE(connectors.count() == 1);
+            REQUIRE(connectors.first() == &conn2);
+        }
+
+        SUBCASE("Removing the wire") {
+            REQUIRE(manager.remove_wire(wire));
+
+            REQUIRE(manager.attached_connectors(wire.get()).isEmpty());
+            REQUIRE(manager.attached_wire(&conn2) == nullptr);
+        }
+    }
+
     TEST_CASE ("connector_moved(): Moving a connector with a wire attached")
     {
         wire_system::manager manager;
@@ -206,6 +240,64 @@ TEST_SUITE("Manager")
         }
     }
 
+    TEST_CASE ("connectors_moved(): Moving several connectors at once")
+    {
+        wire_system::manager manager;
+
+        // Create a wire between two connectors
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 10});
+        wire->append_point({10, 10});
+        manager.add_wire(wire);
+
+        connector conn1;
+        conn1.pos = QPointF(0, 10);
+        connector conn2;
+        conn2.pos = QPointF(10, 10);
+        manager.attach_wire_to_connector(wire.get(), &conn1);
+        manager.attach_wire_to_connector(wire.get(), &conn2);
+
+        // A connector without a wire
+        connector conn3;
+        conn3.pos = QPointF(50, 50);
+
+        Settings settings;
+        settings.gridSize = 1;
+
+        SUBCASE("Straight angles are not maintained") {
+            settings.preserveStraightAngles = false;
+            manager.set_settings(settings);
+
+            // Move the connectors
+            conn1.pos = QPointF(0, 20);
+            conn2.pos = QPointF(10, 20);
+            conn3.pos = QPointF(60, 60);
+            manager.connectors_moved({ &conn1, &conn2, &conn3 });
+
+            // Make sure everything is as expected
+            REQUIRE(wire->points_count() == 2);
+            REQUIRE(wire->points().at(0).toPointF() == QPointF(0, 20));
+            REQUIRE(wire->points().at(1).toPointF() == QPointF(10, 20));
+            REQUIRE(manager.attached_wire(&conn3) == nullptr);
+        }
+
+        SUBCASE("Straight angles are maintained") {
+            settings.preserveStraightAngles = true;
+            manager.set_settings(settings);
+
+            // Move the connectors
+            conn1.pos = QPointF(0, 20);
+            conn2.pos = QPointF(10, 30);
+            manager.connectors_moved({ &conn1, &conn2 });
+
+            // Both ends follow their connector even though points got inserted
+            REQUIRE(wire->points().first().toPointF() == QPointF(0, 20));
+            REQUIRE(wire->points().last().toPointF() == QPointF(10, 30));
+            REQUIRE(manager.attached_point(&conn1) == 0);
+            REQUIRE(manager.attached_point(&conn2) == wire->points_count() - 1);
+        }
+    }
+
     TEST_CASE("Connections are updated when a points is inserted or removed")
     {
         wire_system::manager manager;
@@ -267,4 +359,103 @@ TEST_SUITE("Manager")
         REQUIRE(manager.attached_point(&conn1) == 0);
         REQUIRE(manager.attached_point(&conn2) == 1);
     }
+
+    TEST_CASE("memory_stats(): Reports the managed wires, points and connections")
+    {
+        wire_system::manager manager;
+
+        // Empty manager
+        {
+            const auto stats = manager.memory_stats();
+            REQUIRE(stats.nets == 0);
+            REQUIRE(stats.wires == 0);
+            REQUIRE(stats.points == 0);
+            REQUIRE(stats.bytes == 0);
+        }
+
+        // Create the first wire
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 10});
+        wire1->append_point({10, 10});
+        manager.add_wire(wire1);
+
+        // Create a second wire that lays on the first one
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({5, 0});
+        wire2->append_point({5, 10});
+        manager.add_wire(wire2);
+
+        // Connect the wires and attach a connector
+        manager.connect_wire(wire1.get(), wire2.get(), 1);
+        connector conn;
+        conn.pos = QPointF(0, 10);
+        manager.attach_wire_to_connector(wire1.get(), &conn);
+
+        const auto stats = manager.memory_stats();
+        REQUIRE(stats.nets == 1);
+        REQUIRE(stats.wires == 2);
+        REQUIRE(stats.points == 4);
+        REQUIRE(stats.junctions == 1);
+        REQUIRE(stats.wire_connections == 1);
+        REQUIRE(stats.connector_attachments == 1);
+        REQUIRE(stats.bytes > 0);
+    }
+
+    TEST_CASE ("nets_named(): Nets are indexed by name")
+    {
+        wire_system::manager manager;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 0});
+        wire1->append_point({10, 0});
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({0, 10});
+        wire2->append_point({10, 10});
+        manager.add_wire(wire2);
+
+        // Renaming updates the index
+        wire1->net()->set_name(QString("clk"));
+        wire2->net()->set_name(QString("clk"));
+        REQUIRE(manager.nets_named("clk") == QVector<wire_system::net*>{ wire1->net().get(), wire2->net().get() });
+
+        wire1->net()->set_name(QString("rst"));
+        REQUIRE(manager.nets_named("clk") == QVector<wire_system::net*>{ wire2->net().get() });
+        REQUIRE(manager.nets_named("rst") == QVector<wire_system::net*>{ wire1->net().get() });
+
+        // Removing the last wire removes the net
+        manager.remove_wire(wire2);
+        REQUIRE(manager.nets_named("clk").isEmpty());
+
+        // Nets are only indexed once added
+        auto net = std::make_shared<wire_system::net>();
+        net->set_manager(&manager);
+        net->set_name(QString("rst"));
+        REQUIRE(manager.nets_named("rst").count() == 1);
+        manager.add_net(net);
+        REQUIRE(manager.nets_named("rst").count() == 2);
+
+        manager.clear();
+        REQUIRE(manager.nets_named("rst").isEmpty());
+    }
+
+    TEST_CASE ("remove_nets(): Several nets are removed at once")
+    {
+        wire_system::manager manager;
+
+        QVector<std::shared_ptr<wire_system::net>> nets;
+        for (int i = 0; i < 4; i++) {
+            auto net = std::make_shared<wire_system::net>();
+            net->set_manager(&manager);
+            net->set_name(QString("net%1").arg(i % 2));
+            manager.add_net(net);
+            nets << net;
+        }
+
+        manager.remove_nets({ nets.at(0), nets.at(3), nullptr, nets.at(0) });
+        REQUIRE(manager.nets() == QList<std::shared_ptr<wire_system::net>>{ nets.at(1), nets.at(2) });
+        REQUIRE(manager.nets_named("net0") == QVector<wire_system::net*>{ nets.at(2).get() });
+        REQUIRE(manager.nets_named("net1") == QVector<wire_system::net*>{ nets.at(1).get() });
+    }
 }
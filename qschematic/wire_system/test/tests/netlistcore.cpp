@@ -0,0 +1,151 @@
+#include "3rdparty/doctest.h"
+#include "../../../utils/netlistcore.h"
+#include "connector.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    std::shared_ptr<wire_system::wire> addWire(wire_system::manager& manager, const QPointF& p1, const QPointF& p2, const QString& name = QString())
+    {
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point(p1);
+        wire->append_point(p2);
+        manager.add_wire(wire);
+        wire->net()->set_name(name);
+
+        return wire;
+    }
+
+    void attach(wire_system::manager& manager, const std::shared_ptr<wire_system::wire>& wire, connector& connector, const QPointF& pos)
+    {
+        connector.pos = pos;
+        manager.attach_wire_to_connector(wire.get(), &connector);
+    }
+
+    const NetlistCore::GlobalNet* netNamed(const QVector<NetlistCore::GlobalNet>& nets, const QString& name)
+    {
+        for (const auto& net : nets) {
+            if (net.name == name) {
+                return &net;
+            }
+        }
+
+        return nullptr;
+    }
+
+}
+
+TEST_SUITE("NetlistCore")
+{
+    TEST_CASE("Wire nets sharing a name form one net")
+    {
+        wire_system::manager manager;
+        connector c1, c2, c3;
+        auto wire1 = addWire(manager, { 0, 0 }, { 10, 0 }, "clk");
+        auto wire2 = addWire(manager, { 0, 20 }, { 10, 20 }, "clk");
+        auto wire3 = addWire(manager, { 0, 40 }, { 10, 40 });
+        addWire(manager, { 0, 60 }, { 10, 60 });
+        attach(manager, wire1, c1, { 0, 0 });
+        attach(manager, wire2, c2, { 10, 20 });
+        attach(manager, wire3, c3, { 0, 40 });
+
+        const auto& nets = NetlistCore::generate(manager, NetlistCore::Buses());
+        REQUIRE(nets.count() == 3);
+
+        const auto* clk = netNamed(nets, "clk");
+        REQUIRE(clk);
+        REQUIRE(clk->wires == QVector<const wire_system::wire*>{ wire1.get(), wire2.get() });
+        REQUIRE(clk->connectors == QVector<const wire_system::connectable*>{ &c1, &c2 });
+
+        // Unnamed nets are never merged
+        const auto* n0 = netNamed(nets, "N000");
+        const auto* n1 = netNamed(nets, "N001");
+        REQUIRE(n0);
+        REQUIRE(n1);
+        REQUIRE(n0->wires.count() == 1);
+        REQUIRE(n1->wires.count() == 1);
+        REQUIRE(n0->connectors.count() + n1->connectors.count() == 1);
+    }
+
+    TEST_CASE("Scoped generation only returns the nets of the seeds")
+    {
+        wire_system::manager manager;
+        auto wire1 = addWire(manager, { 0, 0 }, { 10, 0 }, "clk");
+        auto wire2 = addWire(manager, { 0, 20 }, { 10, 20 }, "clk");
+        addWire(manager, { 0, 40 }, { 10, 40 }, "rst");
+        addWire(manager, { 0, 60 }, { 10, 60 });
+        auto wire5 = addWire(manager, { 0, 80 }, { 10, 80 });
+
+        const auto& nets = NetlistCore::generate(manager, NetlistCore::Buses(), { wire1->net().get(), wire5->net().get(), wire2->net().get() });
+        REQUIRE(nets.count() == 2);
+        REQUIRE(nets.at(0).name == "clk");
+        REQUIRE(nets.at(0).wires == QVector<const wire_system::wire*>{ wire1.get(), wire2.get() });
+        REQUIRE(nets.at(1).name == "N000");
+        REQUIRE(nets.at(1).wires == QVector<const wire_system::wire*>{ wire5.get() });
+    }
+
+    TEST_CASE("Ripped nets join the bus member, buses themselves are skipped")
+    {
+        wire_system::manager manager;
+        connector ripper, pin1, pin2;
+        auto bus = addWire(manager, { 0, 100 }, { 100, 100 }, "D[1:0]");
+        auto ripped = addWire(manager, { 10, 110 }, { 10, 150 });
+        auto member = addWire(manager, { 0, 200 }, { 10, 200 }, "D0");
+        attach(manager, ripped, ripper, { 10, 110 });
+        attach(manager, ripped, pin1, { 10, 150 });
+        attach(manager, member, pin2, { 10, 200 });
+
+        NetlistCore::Ripper tap { &ripper, "D0", { 5, 100 } };
+        NetlistCore::Buses buses;
+        buses.isBus = [&bus](const wire_system::wire& wire) {
+            return &wire == bus.get();
+        };
+        buses.ripper = [&tap](const wire_system::connectable& connectable) -> std::optional<NetlistCore::Ripper> {
+            if (&connectable != tap.connector) {
+                return std::nullopt;
+            }
+            return tap;
+        };
+
+        SUBCASE("Tapping a member") {
+            const auto& nets = NetlistCore::generate(manager, buses);
+            REQUIRE(nets.count() == 1);
+            REQUIRE(nets.first().name == "D0");
+            REQUIRE(nets.first().wires == QVector<const wire_system::wire*>{ ripped.get(), member.get() });
+            REQUIRE(nets.first().connectors == QVector<const wire_system::connectable*>{ &pin1, &pin2 });
+
+            // The member net is found from the ripped one and the other way around
+            for (const auto& seed : { ripped, member }) {
+                const auto& scoped = NetlistCore::generate(manager, buses, { seed->net().get() });
+                REQUIRE(scoped.count() == 1);
+                REQUIRE(scoped.first().name == "D0");
+                REQUIRE(scoped.first().wires.count() == 2);
+            }
+
+            // Same through the ripper index
+            buses.rippersOf = [&tap](const QString& name) {
+                return name == tap.member ? QVector<NetlistCore::Ripper>{ tap } : QVector<NetlistCore::Ripper>();
+            };
+            const auto& scoped = NetlistCore::generate(manager, buses, { member->net().get() });
+            REQUIRE(scoped.count() == 1);
+            REQUIRE(scoped.first().wires.count() == 2);
+        }
+
+        SUBCASE("Not a member of the bus") {
+            tap.member = "D2";
+
+            const auto& nets = NetlistCore::generate(manager, buses);
+            REQUIRE(nets.count() == 2);
+            REQUIRE(netNamed(nets, "D0")->wires.count() == 1);
+            REQUIRE(netNamed(nets, "N000")->connectors == QVector<const wire_system::connectable*>{ &pin1 });
+        }
+
+        SUBCASE("Not on the bus") {
+            tap.tapPoint = { 5, 90 };
+
+            REQUIRE(NetlistCore::generate(manager, buses).count() == 2);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include <QMap>
+#include "3rdparty/doctest.h"
+#include "../../../utils/netlistflattener.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    using Subnets = BlockDefinition::Subnets;
+
+    // A buffer block: port "in" and "out", each connected to one pin of node 0
+    Subnets buffer()
+    {
+        Subnets subnets;
+        subnets.nets.append({ "in", { { 0, "A" } } });
+        subnets.nets.append({ "out", { { 0, "Y" } } });
+
+        return subnets;
+    }
+
+    // Instantiates the definition as node 1 and connects its ports to node 0
+    Subnets instantiating(const QString& definition)
+    {
+        Subnets subnets;
+        subnets.nets.append({ "in", { { 0, "A" }, { 1, "in" } } });
+        subnets.nets.append({ "out", { { 1, "out" } } });
+        subnets.instances.insert(1, { "U1", definition });
+
+        return subnets;
+    }
+
+    NetlistFlattener::Lookup lookup(const QMap<QString, Subnets>& definitions)
+    {
+        return [&definitions](const QString& name) -> const Subnets* {
+            auto it = definitions.constFind(name);
+            return it != definitions.constEnd() ? &it.value() : nullptr;
+        };
+    }
+
+}
+
+TEST_SUITE("NetlistFlattener")
+{
+    TEST_CASE("Instances are flattened and their ports joined to the nets above")
+    {
+        QMap<QString, Subnets> definitions;
+        definitions.insert("buffer", buffer());
+
+        Subnets top;
+        top.nets.append({ "clk", { { 0, "1" }, { 1, "in" }, { 2, "in" } } });
+        top.nets.append({ "q", { { 2, "out" } } });
+        top.instances.insert(1, { "U1", "buffer" });
+        top.instances.insert(2, { QString(), "buffer" });
+
+        FlatNetlist netlist;
+        REQUIRE(NetlistFlattener::flatten(netlist, top, lookup(definitions), 32));
+
+        QMap<QString, QStringList> nets;
+        for (const auto& net : netlist) {
+            QStringList pins = net.pins;
+            pins.sort();
+            nets.insert(net.name, pins);
+        }
+        REQUIRE(nets.value("clk") == QStringList{ "N0.1", "N2/N0.A", "U1/N0.A" });
+        REQUIRE(nets.value("q") == QStringList{ "N2/N0.Y" });
+        REQUIRE(nets.value("U1/out") == QStringList{ "U1/N0.Y" });
+    }
+
+    TEST_CASE("The same definition may be used at several levels")
+    {
+        QMap<QString, Subnets> definitions;
+        definitions.insert("buffer", buffer());
+        definitions.insert("wrapper", instantiating("buffer"));
+
+        FlatNetlist netlist;
+        REQUIRE(NetlistFlattener::flatten(netlist, instantiating("wrapper"), lookup(definitions), 32));
+        REQUIRE_FALSE(netlist.isEmpty());
+    }
+
+    TEST_CASE("Flattening fails on invalid hierarchies")
+    {
+        QMap<QString, Subnets> definitions;
+        FlatNetlist netlist;
+
+        SUBCASE("Missing definition") {
+            REQUIRE_FALSE(NetlistFlattener::flatten(netlist, instantiating("missing"), lookup(definitions), 32));
+            REQUIRE(netlist.isEmpty());
+        }
+
+        SUBCASE("Self-reference") {
+            definitions.insert("loop", instantiating("loop"));
+            REQUIRE_FALSE(NetlistFlattener::flatten(netlist, instantiating("loop"), lookup(definitions), 32));
+            REQUIRE(netlist.isEmpty());
+        }
+
+        SUBCASE("Indirect cycle") {
+            definitions.insert("a", instantiating("b"));
+            definitions.insert("b", instantiating("a"));
+            REQUIRE_FALSE(NetlistFlattener::flatten(netlist, instantiating("a"), lookup(definitions), 32));
+            REQUIRE(netlist.isEmpty());
+        }
+
+        SUBCASE("Too deep") {
+            definitions.insert("buffer", buffer());
+            definitions.insert("wrapper", instantiating("buffer"));
+            REQUIRE_FALSE(NetlistFlattener::flatten(netlist, instantiating("wrapper"), lookup(definitions), 1));
+            REQUIRE(netlist.isEmpty());
+            REQUIRE(NetlistFlattener::flatten(netlist, instantiating("wrapper"), lookup(definitions), 2));
+        }
+    }
+}
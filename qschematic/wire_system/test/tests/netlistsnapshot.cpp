@@ -0,0 +1,166 @@
+#include <string>
+#include "3rdparty/doctest.h"
+#include "../../../utils/netlistsnapshot.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    std::vector<char> twoResistors()
+    {
+        NetlistSnapshotBuilder builder;
+
+        builder.addNode(10, "R1");
+        const auto r1a = builder.addConnector(11, "a");
+        const auto r1b = builder.addConnector(12, "b");
+        builder.addNode(20, "R2");
+        const auto r2a = builder.addConnector(21, "a");
+        builder.addConnector(22, "b");
+
+        builder.addNet(0, "VCC", { r1a });
+        builder.addNet(1, "", { r1b, r2a });
+
+        return builder.data();
+    }
+
+}
+
+TEST_CASE ("NetlistSnapshotView: Reading a snapshot in place")
+{
+    const auto data = twoResistors();
+    const NetlistSnapshotView view(data.data(), data.size());
+
+    REQUIRE(view.isValid());
+    REQUIRE(view.nodeCount() == 2);
+    REQUIRE(view.connectorCount() == 4);
+    REQUIRE(view.netCount() == 2);
+
+    SUBCASE("Nodes own a range of connectors") {
+        const auto* node = view.node(1);
+        REQUIRE(node);
+        REQUIRE(node->id == 20);
+        REQUIRE(std::string(view.string(node->name)) == "R2");
+        REQUIRE(node->firstConnector == 2);
+        REQUIRE(node->connectorCount == 2);
+        REQUIRE(view.connector(node->firstConnector)->id == 21);
+    }
+
+    SUBCASE("Nets refer to connectors") {
+        const auto* net = view.net(1);
+        REQUIRE(net);
+        REQUIRE(std::string(view.string(net->name)).empty());
+        REQUIRE(net->connectorCount == 2);
+        REQUIRE(view.connector(view.netConnector(*net, 0))->id == 12);
+        REQUIRE(view.connector(view.netConnector(*net, 1))->id == 21);
+        REQUIRE(view.netConnector(*net, 2) == NETLIST_SNAPSHOT_NONE);
+    }
+
+    SUBCASE("Connectors know their node and net") {
+        REQUIRE(view.connector(2)->node == 1);
+        REQUIRE(view.connector(2)->net == 1);
+        REQUIRE(view.connector(3)->net == NETLIST_SNAPSHOT_NONE);
+    }
+
+    SUBCASE("Names are only stored once") {
+        REQUIRE(view.connector(0)->name == view.connector(2)->name);
+    }
+
+    SUBCASE("Out of range") {
+        REQUIRE_FALSE(view.node(2));
+        REQUIRE_FALSE(view.connector(4));
+        REQUIRE_FALSE(view.net(2));
+        REQUIRE(std::string(view.string(100000)).empty());
+    }
+}
+
+TEST_CASE ("NetlistSnapshotView: Rejecting invalid data")
+{
+    auto data = twoResistors();
+
+    SUBCASE("Truncated") {
+        REQUIRE_FALSE(NetlistSnapshotView(data.data(), data.size() - 1).isValid());
+        REQUIRE_FALSE(NetlistSnapshotView(data.data(), 4).isValid());
+    }
+
+    SUBCASE("Wrong magic") {
+        data[0] = 0;
+        REQUIRE_FALSE(NetlistSnapshotView(data.data(), data.size()).isValid());
+    }
+
+    SUBCASE("Unterminated string table") {
+        data.back() = 'x';
+        const NetlistSnapshotView view(data.data(), data.size());
+        REQUIRE(view.isValid());
+        REQUIRE(view.string(view.net(0)->name) == "VCCx");
+    }
+
+    SUBCASE("Offset beyond the end") {
+        NetlistSnapshotHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        header.netCount = 1000;
+        std::memcpy(data.data(), &header, sizeof(header));
+        REQUIRE_FALSE(NetlistSnapshotView(data.data(), data.size()).isValid());
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+TEST_CASE ("NetlistSnapshotSegment: Publishing through shared memory")
+{
+    const std::string name = "/qschematic-test-" + std::to_string(::getpid());
+
+    NetlistSnapshotSegment writer;
+    REQUIRE(writer.create(name, 4096));
+
+    NetlistSnapshotSegment reader;
+    REQUIRE(reader.open(name));
+
+    SUBCASE("Nothing published yet") {
+        REQUIRE(reader.sequence() == 0);
+        REQUIRE_FALSE(reader.read([](const NetlistSnapshotView&) { }));
+    }
+
+    SUBCASE("Reading the current snapshot") {
+        const auto data = twoResistors();
+        REQUIRE(writer.publish(data));
+        REQUIRE(writer.publish(data));
+        REQUIRE(reader.sequence() == 2);
+
+        std::uint32_t nodes = 0;
+        std::uint64_t sequence = 0;
+        REQUIRE(reader.read([&](const NetlistSnapshotView& view) {
+            nodes = view.nodeCount();
+            sequence = view.sequence();
+        }));
+        REQUIRE(nodes == 2);
+        REQUIRE(sequence == 2);
+    }
+
+    SUBCASE("Snapshots exceeding the capacity are refused") {
+        NetlistSnapshotBuilder builder;
+        builder.addNode(1, std::string(8192, 'x'));
+        REQUIRE_FALSE(writer.publish(builder.data()));
+        REQUIRE(writer.sequence() == 0);
+    }
+
+    SUBCASE("Readers can't publish") {
+        REQUIRE_FALSE(reader.publish(twoResistors()));
+    }
+
+    SUBCASE("Replaced segments are retired") {
+        REQUIRE(writer.publish(twoResistors()));
+        REQUIRE_FALSE(reader.isRetired());
+
+        writer.close();
+        REQUIRE(reader.isRetired());
+        REQUIRE_FALSE(reader.open(name));
+
+        REQUIRE(writer.create(name, 8192, 5));
+        REQUIRE(reader.open(name));
+        REQUIRE(reader.sequence() == 5);
+        REQUIRE_FALSE(reader.read([](const NetlistSnapshotView&) { }));
+    }
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "3rdparty/doctest.h"
+#include <QBuffer>
+#include "../../../utils/operationlog.h"
+#include "../../../operationlogreader.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    // Stand-ins for scene objects, the encoder only cares about their addresses
+    struct Object
+    {
+        int dummy = 0;
+    };
+
+    QVector<QPointF> connectors()
+    {
+        return { QPointF(0, 10), QPointF(40, 10) };
+    }
+
+    Operation addNode(quint64 id, const QPointF& pos)
+    {
+        Operation operation;
+        operation.type = Operation::ItemAdd;
+        operation.id = id;
+        operation.itemType = 1;
+        operation.pos = pos;
+        operation.size = QSizeF(40, 20);
+        operation.points = connectors();
+
+        return operation;
+    }
+
+    Operation updateWire(quint64 id, quint64 net, const QVector<QPointF>& points)
+    {
+        Operation operation;
+        operation.type = Operation::WireUpdate;
+        operation.id = id;
+        operation.itemType = 2;
+        operation.net = net;
+        operation.points = points;
+
+        return operation;
+    }
+
+    // Delivers the data in small chunks like a socket would
+    void deliver(OperationLogReader& reader, const QByteArray& data, int chunkSize)
+    {
+        for (int i = 0; i < data.size(); i += chunkSize) {
+            reader.feed(data.mid(i, chunkSize));
+        }
+    }
+
+}
+
+TEST_SUITE("Operation log")
+{
+    TEST_CASE("Operations survive encoding")
+    {
+        Operation operation = updateWire(7, 3, { QPointF(0, 0), QPointF(10, 0), QPointF(10, 25.5) });
+        operation.sequence = 42;
+
+        const QByteArray frame = OperationCodec::encode(operation);
+
+        OperationCodec codec;
+        codec.append(frame);
+        Operation decoded;
+        REQUIRE(codec.next(decoded));
+        REQUIRE(decoded.type == Operation::WireUpdate);
+        REQUIRE(decoded.sequence == 42);
+        REQUIRE(decoded.id == 7);
+        REQUIRE(decoded.net == 3);
+        REQUIRE(decoded.points == operation.points);
+        REQUIRE_FALSE(codec.next(decoded));
+        REQUIRE_FALSE(codec.hasError());
+    }
+
+    TEST_CASE("Incomplete frames are kept until the rest arrives")
+    {
+        Operation operation;
+        operation.type = Operation::NetRename;
+        operation.net = 5;
+        operation.name = QStringLiteral("clk");
+        const QByteArray frame = OperationCodec::encode(operation);
+
+        OperationCodec codec;
+        Operation decoded;
+        codec.append(frame.left(3));
+        REQUIRE_FALSE(codec.next(decoded));
+        codec.append(frame.mid(3, 5));
+        REQUIRE_FALSE(codec.next(decoded));
+        codec.append(frame.mid(8));
+        REQUIRE(codec.next(decoded));
+        REQUIRE(decoded.name == "clk");
+        REQUIRE_FALSE(codec.hasError());
+    }
+
+    TEST_CASE("Corrupt frames are detected")
+    {
+        QByteArray frame = OperationCodec::encode(addNode(1, QPointF(0, 0)));
+        frame[4] = char(0x7f);      // Unknown operation type
+
+        OperationCodec codec;
+        codec.append(frame);
+        Operation decoded;
+        REQUIRE_FALSE(codec.next(decoded));
+        REQUIRE(codec.hasError());
+    }
+
+    TEST_CASE("A replica reading the log from a device ends up in the same state")
+    {
+        Object node1, node2, wire, net;
+        OperationLogEncoder encoder;
+
+        // Two nodes connected by a wire
+        encoder.updateItem(&node1, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateItem(&node2, 1, QPointF(100, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateWire(&wire, 2, encoder.id(&net), { QPointF(40, 10), QPointF(100, 10) });
+        encoder.renameNet(encoder.id(&net), QStringLiteral("data"));
+        encoder.setAttachment(encoder.id(&node1), 1, encoder.id(&wire), 0);
+        encoder.setAttachment(encoder.id(&node2), 0, encoder.id(&wire), 1);
+        encoder.reset();
+        REQUIRE(encoder.model().items.isEmpty());
+
+        // Start over, the previous ids are gone
+        encoder.updateItem(&node1, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateItem(&node2, 1, QPointF(100, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateWire(&wire, 2, encoder.id(&net), { QPointF(40, 10), QPointF(100, 10) });
+        encoder.renameNet(encoder.id(&net), QStringLiteral("data"));
+        encoder.setAttachment(encoder.id(&node1), 1, encoder.id(&wire), 0);
+        encoder.setAttachment(encoder.id(&node2), 0, encoder.id(&wire), 1);
+        encoder.finish();
+
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        buffer.write(encoder.takeFrames());
+        buffer.seek(0);
+
+        OperationLogReader reader;
+        reader.setDevice(&buffer);
+        REQUIRE_FALSE(reader.isDiverged());
+        REQUIRE(reader.sequence() == encoder.sequence());
+        REQUIRE(reader.model().items.count() == 2);
+        REQUIRE(reader.model().wires.count() == 1);
+        REQUIRE(reader.model().nets.value(encoder.id(&net)) == "data");
+        REQUIRE(reader.model().attachments.count() == 2);
+        REQUIRE(reader.model().checksum() == encoder.model().checksum());
+    }
+
+    TEST_CASE("Only what changed is encoded")
+    {
+        Object node, wire, net;
+        OperationLogEncoder encoder;
+        encoder.setChecksumInterval(0);
+        OperationLogReader reader;
+
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateWire(&wire, 2, encoder.id(&net), { QPointF(40, 10), QPointF(100, 10) });
+        encoder.setAttachment(encoder.id(&node), 1, encoder.id(&wire), 0);
+        deliver(reader, encoder.takeFrames(), 5);
+        REQUIRE(encoder.sequence() == 3);
+
+        // Nothing changed
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        encoder.updateWire(&wire, 2, encoder.id(&net), { QPointF(40, 10), QPointF(100, 10) });
+        encoder.setAttachment(encoder.id(&node), 1, encoder.id(&wire), 0);
+        encoder.renameNet(encoder.id(&net), QString());
+        encoder.finish();
+        REQUIRE(encoder.takeFrames().isEmpty());
+
+        // Move the node and its wire end
+        encoder.updateItem(&node, 1, QPointF(0, 20), 0, QSizeF(40, 20), connectors());
+        encoder.updateWire(&wire, 2, encoder.id(&net), { QPointF(40, 30), QPointF(100, 10) });
+        deliver(reader, encoder.takeFrames(), 3);
+        REQUIRE(encoder.sequence() == 5);
+        REQUIRE_FALSE(reader.isDiverged());
+        REQUIRE(reader.model().items.value(encoder.id(&node)).pos == QPointF(0, 20));
+        REQUIRE(reader.model().checksum() == encoder.model().checksum());
+
+        // Detaching
+        REQUIRE(encoder.attachedTo(encoder.id(&wire)).count() == 1);
+        encoder.setAttachment(encoder.id(&node), 1, 0, 0);
+        REQUIRE(encoder.attachedTo(encoder.id(&wire)).isEmpty());
+        deliver(reader, encoder.takeFrames(), 3);
+        REQUIRE(reader.model().attachments.isEmpty());
+    }
+
+    TEST_CASE("Reused addresses get new ids")
+    {
+        Object node;
+        OperationLogEncoder encoder;
+        OperationLogReader reader;
+
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        const quint64 first = encoder.findId(&node);
+        REQUIRE(first != 0);
+
+        // The item is removed and another one is created at the same address
+        encoder.removeItem(&node);
+        REQUIRE(encoder.findId(&node) == 0);
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        const quint64 second = encoder.findId(&node);
+        REQUIRE(second != first);
+        REQUIRE(encoder.key(second) == &node);
+        REQUIRE(encoder.key(first) == nullptr);
+
+        deliver(reader, encoder.takeFrames(), 64);
+        REQUIRE_FALSE(reader.isDiverged());
+        REQUIRE(reader.model().items.keys() == QList<quint64>{ second });
+
+        // Removing something that never made it into the log writes nothing
+        Object other;
+        encoder.id(&other);
+        encoder.removeItem(&other);
+        REQUIRE(encoder.takeFrames().isEmpty());
+    }
+
+    TEST_CASE("Gaps in the sequence mark the replica as diverged until a reset")
+    {
+        Object node;
+        OperationLogEncoder encoder;
+        OperationLogReader reader;
+        int divergedCount = 0;
+        QObject::connect(&reader, &OperationLogReader::diverged, [&divergedCount] { divergedCount++; });
+
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        deliver(reader, encoder.takeFrames(), 16);
+        REQUIRE_FALSE(reader.isDiverged());
+
+        // The replica misses an operation
+        encoder.updateItem(&node, 1, QPointF(20, 0), 0, QSizeF(40, 20), connectors());
+        encoder.takeFrames();
+        encoder.updateItem(&node, 1, QPointF(40, 0), 0, QSizeF(40, 20), connectors());
+        deliver(reader, encoder.takeFrames(), 16);
+        REQUIRE(reader.isDiverged());
+        REQUIRE(divergedCount == 1);
+
+        // Operations are ignored until the writer starts over
+        encoder.updateItem(&node, 1, QPointF(60, 0), 0, QSizeF(40, 20), connectors());
+        deliver(reader, encoder.takeFrames(), 16);
+        REQUIRE(reader.isDiverged());
+        REQUIRE(reader.model().items.value(1).pos == QPointF(0, 0));
+
+        encoder.reset();
+        encoder.updateItem(&node, 1, QPointF(60, 0), 0, QSizeF(40, 20), connectors());
+        encoder.finish();
+        deliver(reader, encoder.takeFrames(), 16);
+        REQUIRE_FALSE(reader.isDiverged());
+        REQUIRE(reader.model().checksum() == encoder.model().checksum());
+    }
+
+    TEST_CASE("Checksums reveal a replica that diverged")
+    {
+        OperationLogReader reader;
+
+        // The replica gets an operation the writer never applied to its own state
+        OperationLogEncoder encoder;
+        Object node;
+        encoder.updateItem(&node, 1, QPointF(0, 0), 0, QSizeF(40, 20), connectors());
+        deliver(reader, encoder.takeFrames(), 16);
+
+        Operation checksum;
+        checksum.type = Operation::Checksum;
+        checksum.sequence = encoder.sequence() + 1;
+        checksum.checksum = encoder.model().checksum() + 1;
+        reader.feed(OperationCodec::encode(checksum));
+        REQUIRE(reader.isDiverged());
+    }
+
+    TEST_CASE("Operations that don't fit the state are rejected")
+    {
+        OperationLogModel model;
+
+        Operation move = addNode(1, QPointF(0, 0));
+        move.type = Operation::ItemMove;
+        REQUIRE_FALSE(model.apply(move));
+
+        REQUIRE(model.apply(addNode(1, QPointF(0, 0))));
+        REQUIRE_FALSE(model.apply(addNode(1, QPointF(0, 0))));
+
+        Operation attach;
+        attach.type = Operation::Attach;
+        attach.id = 1;
+        attach.index = 0;
+        attach.wire = 99;
+        REQUIRE_FALSE(model.apply(attach));
+    }
+}
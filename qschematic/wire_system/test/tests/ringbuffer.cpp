@@ -0,0 +1,91 @@
+#include <thread>
+#include <vector>
+#include "3rdparty/doctest.h"
+#include "../../../utils/ringbuffer.h"
+
+using namespace QSchematic;
+
+TEST_SUITE("RingBuffer")
+{
+    TEST_CASE("The capacity is rounded up to a power of two")
+    {
+        REQUIRE(RingBuffer<int>(0).capacity() == 2);
+        REQUIRE(RingBuffer<int>(2).capacity() == 2);
+        REQUIRE(RingBuffer<int>(5).capacity() == 8);
+        REQUIRE(RingBuffer<int>(64).capacity() == 64);
+    }
+
+    TEST_CASE("Values are popped in order and pushing fails when full")
+    {
+        RingBuffer<int> buffer(4);
+        int value = 0;
+        REQUIRE_FALSE(buffer.tryPop(value));
+
+        // Go around a few times
+        int next = 0;
+        int expected = 0;
+        for (int round = 0; round < 3; round++) {
+            while (buffer.tryPush(next)) {
+                next++;
+            }
+            REQUIRE(next - expected == 4);
+
+            REQUIRE(buffer.tryPop(value));
+            REQUIRE(value == expected++);
+            REQUIRE(buffer.tryPop(value));
+            REQUIRE(value == expected++);
+        }
+
+        while (buffer.tryPop(value)) {
+            REQUIRE(value == expected++);
+        }
+        REQUIRE(expected == next);
+    }
+
+    TEST_CASE("Every value of concurrent producers arrives exactly once")
+    {
+        const int producerCount = 4;
+        const int valueCount = 100000;
+        RingBuffer<int> buffer(256);
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producerCount; p++) {
+            producers.emplace_back([&buffer, p] {
+                for (int i = 0; i < valueCount; i++) {
+                    while (!buffer.tryPush(p * valueCount + i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        // Values of the same producer must arrive in order
+        std::vector<int> nextValue(producerCount, 0);
+        int received = 0;
+        bool ordered = true;
+        while (received < producerCount * valueCount) {
+            int value = 0;
+            if (!buffer.tryPop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const int producer = value / valueCount;
+            ordered = ordered && value % valueCount == nextValue[producer];
+            nextValue[producer]++;
+            received++;
+        }
+
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        REQUIRE(ordered);
+        for (int count : nextValue) {
+            REQUIRE(count == valueCount);
+        }
+
+        int value = 0;
+        REQUIRE_FALSE(buffer.tryPop(value));
+    }
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include "3rdparty/doctest.h"
+#include "../../../utils/selectionpayload.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    // Two nodes connected by a wire that has a second wire ending on it
+    SelectionPayload twoNodes()
+    {
+        SelectionPayload payload;
+        payload.itemCount = 2;
+        payload.wireCount = 2;
+        payload.items = QByteArray("items", 5);
+        payload.nets.push_back({ "clk", { 0, 1 } });
+        payload.attachments.push_back({ 0, 1, 0, 0 });
+        payload.attachments.push_back({ 1, 0, 0, 3 });
+        payload.junctions.push_back({ 0, 1, 2 });
+
+        return payload;
+    }
+
+}
+
+TEST_SUITE("SelectionPayload")
+{
+    TEST_CASE("decode() restores the encoded connectivity")
+    {
+        SelectionPayload payload;
+        REQUIRE(SelectionPayload::decode(twoNodes().encode(), payload));
+
+        REQUIRE(payload.itemCount == 2);
+        REQUIRE(payload.wireCount == 2);
+        REQUIRE(payload.items == "items");
+        REQUIRE(payload.nets.count() == 1);
+        REQUIRE(payload.nets.first().name == "clk");
+        REQUIRE(payload.nets.first().wires == QVector<int>{ 0, 1 });
+        REQUIRE(payload.attachments.count() == 2);
+        REQUIRE(payload.attachments.at(1).item == 1);
+        REQUIRE(payload.attachments.at(1).connector == 0);
+        REQUIRE(payload.attachments.at(1).wire == 0);
+        REQUIRE(payload.attachments.at(1).point == 3);
+        REQUIRE(payload.junctions.count() == 1);
+        REQUIRE(payload.junctions.first().connectedWire == 1);
+        REQUIRE(payload.junctions.first().point == 2);
+    }
+
+    TEST_CASE("decode() rejects invalid data")
+    {
+        SelectionPayload payload;
+
+        SUBCASE("Truncated") {
+            const QByteArray data = twoNodes().encode();
+            REQUIRE_FALSE(SelectionPayload::decode(data.left(data.size() - 1), payload));
+        }
+
+        SUBCASE("Wire out of range") {
+            SelectionPayload invalid = twoNodes();
+            invalid.junctions.push_back({ 0, 2, 0 });
+            REQUIRE_FALSE(SelectionPayload::decode(invalid.encode(), payload));
+        }
+
+        SUBCASE("Negative point") {
+            SelectionPayload invalid = twoNodes();
+            invalid.junctions.push_back({ 0, 1, -1 });
+            REQUIRE_FALSE(SelectionPayload::decode(invalid.encode(), payload));
+        }
+
+        SUBCASE("Item out of range") {
+            SelectionPayload invalid = twoNodes();
+            invalid.attachments.push_back({ 2, 0, 0, 0 });
+            REQUIRE_FALSE(SelectionPayload::decode(invalid.encode(), payload));
+        }
+
+        SUBCASE("Other data") {
+            REQUIRE_FALSE(SelectionPayload::decode(QByteArray("qschematic"), payload));
+        }
+    }
+
+    // Benchmark: the connectivity of 10k nodes each with a wire to the previous one.
+    // Skipped by default as timings aren't reliable on shared machines, run with --no-skip.
+    TEST_CASE("encode() and decode() of 10k items" * doctest::skip())
+    {
+        const int count = 10000;
+        SelectionPayload payload;
+        payload.itemCount = count;
+        payload.wireCount = count - 1;
+        for (int i = 1; i < count; i++) {
+            payload.nets.push_back({ QString("net%1").arg(i), { i - 1 } });
+            payload.attachments.push_back({ i - 1, 1, i - 1, 0 });
+            payload.attachments.push_back({ i, 0, i - 1, 1 });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const QByteArray data = payload.encode();
+        SelectionPayload decoded;
+        REQUIRE(SelectionPayload::decode(data, decoded));
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        MESSAGE(count << " items: " << data.size() << " bytes, " << elapsed << " ms");
+
+        REQUIRE(decoded.attachments.count() == payload.attachments.count());
+    }
+}
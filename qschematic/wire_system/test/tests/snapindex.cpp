@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "3rdparty/doctest.h"
+#include "../../../utils/snapindex.h"
+
+using namespace QSchematic;
+
+namespace
+{
+
+    SnapIndex randomIndex(std::size_t count, qreal extent, std::mt19937& rng, std::vector<QPointF>& points)
+    {
+        std::uniform_real_distribution<qreal> coordinate(0, extent);
+
+        SnapIndex index(10);
+        points.clear();
+        for (std::size_t i = 0; i < count; i++) {
+            const QPointF point(coordinate(rng), coordinate(rng));
+            points.push_back(point);
+            index.addPoint(point, 0);
+        }
+        index.finalize();
+
+        return index;
+    }
+
+}
+
+TEST_SUITE("SnapIndex")
+{
+    TEST_CASE("nearestPoints() matches brute force")
+    {
+        std::mt19937 rng(42);
+        std::vector<QPointF> points;
+        const SnapIndex index = randomIndex(2000, 1000, rng, points);
+
+        std::uniform_real_distribution<qreal> coordinate(0, 1000);
+        std::vector<SnapIndex::Candidate> candidates;
+        for (int i = 0; i < 200; i++) {
+            const QPointF source(coordinate(rng), coordinate(rng));
+            index.nearestPoints(source, 25, 3, candidates);
+
+            std::vector<qreal> distances;
+            for (const QPointF& point : points) {
+                const qreal distance = std::hypot(point.x() - source.x(), point.y() - source.y());
+                if (distance <= 25) {
+                    distances.push_back(distance);
+                }
+            }
+            std::sort(distances.begin(), distances.end());
+            distances.resize(std::min<std::size_t>(distances.size(), 3));
+
+            REQUIRE(candidates.size() == distances.size());
+            for (std::size_t j = 0; j < distances.size(); j++) {
+                REQUIRE(candidates[j].distance == doctest::Approx(distances[j]));
+            }
+        }
+    }
+
+    TEST_CASE("nearestVerticalEdge() requires overlapping spans")
+    {
+        SnapIndex index(10);
+        index.addVerticalEdge(100, 0, 50, 0);
+        index.addVerticalEdge(104, 200, 250, 1);
+        index.finalize();
+
+        SnapIndex::Candidate candidate;
+        REQUIRE(index.nearestVerticalEdge(97, 40, 80, 10, candidate));
+        REQUIRE(candidate.offset.x() == doctest::Approx(3));
+        REQUIRE(candidate.offset.y() == doctest::Approx(0));
+
+        REQUIRE_FALSE(index.nearestVerticalEdge(97, 60, 80, 10, candidate));
+        REQUIRE_FALSE(index.nearestVerticalEdge(80, 40, 80, 10, candidate));
+    }
+
+    TEST_CASE("priorities win over distance")
+    {
+        SnapIndex index(10);
+        index.addHorizontalEdge(10, 0, 100, 0);
+        index.addHorizontalEdge(15, 0, 100, 1);
+        index.finalize();
+
+        SnapIndex::Candidate candidate;
+        REQUIRE(index.nearestHorizontalEdge(9, 20, 30, 10, candidate));
+        REQUIRE(candidate.priority == 1);
+        REQUIRE(candidate.offset.y() == doctest::Approx(6));
+    }
+
+    // Benchmark: the query time depends on the local density, not on the number of targets.
+    // Skipped by default as timings aren't reliable on shared machines, run with --no-skip.
+    TEST_CASE("nearestPoints() query time is independent of the scene size" * doctest::skip())
+    {
+        std::mt19937 rng(7);
+        std::vector<QPointF> points;
+        std::vector<SnapIndex::Candidate> candidates;
+        const int queries = 20000;
+
+        auto measure = [&](std::size_t count) {
+            // Keep the density constant: one target per 400 square units
+            const qreal extent = std::sqrt(static_cast<qreal>(count) * 400);
+            const SnapIndex index = randomIndex(count, extent, rng, points);
+
+            std::uniform_real_distribution<qreal> coordinate(0, extent);
+            const auto start = std::chrono::steady_clock::now();
+            std::size_t found = 0;
+            for (int i = 0; i < queries; i++) {
+                index.nearestPoints(QPointF(coordinate(rng), coordinate(rng)), 10, 4, candidates);
+                found += candidates.size();
+            }
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / queries;
+            MESSAGE(count << " targets: " << elapsed << " ns per query (" << found << " candidates)");
+        };
+
+        measure(1000);
+        measure(200000);
+    }
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include "3rdparty/doctest.h"
+#include "../../../utils/taskscheduler.h"
+
+using namespace QSchematic;
+
+TEST_SUITE("TaskScheduler")
+{
+    TEST_CASE("Interactive tasks of other workers run before the own background tasks")
+    {
+        std::atomic<int> started { 0 };
+        std::atomic<int> queued { 0 };
+        std::promise<void> releaseFirst;
+        std::promise<void> releaseSecond;
+        std::shared_future<void> first = releaseFirst.get_future().share();
+        std::shared_future<void> second = releaseSecond.get_future().share();
+
+        std::mutex mutex;
+        std::vector<int> order;
+        std::promise<void> done;
+        auto record = [&](int value) {
+            std::lock_guard lock(mutex);
+            order.push_back(value);
+            if (order.size() == 2) {
+                done.set_value();
+            }
+        };
+
+        // Declared last so that the workers are joined before the state above is destroyed
+        TaskScheduler scheduler(2);
+
+        // Occupy both workers, each queues a task onto its own queue
+        for (int i = 0; i < 2; i++) {
+            scheduler.schedule([&] {
+                const int index = started++;
+                while (started.load() < 2) {
+                    std::this_thread::yield();
+                }
+
+                if (index == 0) {
+                    scheduler.schedule([&] { record(TaskScheduler::Background); }, TaskScheduler::Background);
+                    queued++;
+                    first.wait();
+                } else {
+                    scheduler.schedule([&] { record(TaskScheduler::Interactive); }, TaskScheduler::Interactive);
+                    queued++;
+                    second.wait();
+                }
+            });
+        }
+        while (queued.load() < 2) {
+            std::this_thread::yield();
+        }
+
+        // The released worker has to steal the interactive task first
+        releaseFirst.set_value();
+        done.get_future().wait();
+        releaseSecond.set_value();
+
+        REQUIRE(order == std::vector<int>{ TaskScheduler::Interactive, TaskScheduler::Background });
+    }
+
+    TEST_CASE("runPendingTask() prefers interactive tasks")
+    {
+        TaskScheduler scheduler(0);
+
+        std::vector<int> order;
+        scheduler.schedule([&] { order.push_back(TaskScheduler::Background); }, TaskScheduler::Background);
+        scheduler.schedule([&] { order.push_back(TaskScheduler::Interactive); }, TaskScheduler::Interactive);
+
+        while (scheduler.runPendingTask()) {
+        }
+
+        REQUIRE(order == std::vector<int>{ TaskScheduler::Interactive, TaskScheduler::Background });
+    }
+
+    TEST_CASE("TaskGroup::wait() only runs the tasks of its group")
+    {
+        TaskScheduler scheduler(0);
+
+        int count = 0;
+        TaskGroup group(scheduler);
+        for (int i = 0; i < 10; i++) {
+            group.run([&] { count++; });
+        }
+
+        bool unrelated = false;
+        scheduler.schedule([&] { unrelated = true; });
+        group.wait();
+
+        REQUIRE(count == 10);
+        REQUIRE_FALSE(unrelated);
+
+        while (scheduler.runPendingTask()) {
+        }
+        REQUIRE(unrelated);
+    }
+
+    TEST_CASE("TaskGroup skips cancelled tasks and forwards exceptions")
+    {
+        TaskScheduler scheduler(2);
+
+        SUBCASE("Cancelled") {
+            std::atomic<int> count { 0 };
+            CancellationToken token;
+            token.cancel();
+
+            TaskGroup group(scheduler, TaskScheduler::Background, token);
+            group.run([&] { count++; });
+            group.wait();
+
+            REQUIRE(count.load() == 0);
+        }
+
+        SUBCASE("Exception") {
+            TaskGroup group(scheduler);
+            group.run([] { throw 42; });
+
+            REQUIRE_THROWS_AS(group.wait(), int);
+        }
+    }
+
+    TEST_CASE("parallelFor() with nested groups")
+    {
+        TaskScheduler scheduler(3);
+
+        std::vector<int> results(100);
+        parallelFor(100, [&](int i) {
+            std::atomic<int> sum { 0 };
+            parallelFor(i, [&](int j) { sum += j; }, TaskScheduler::Background, CancellationToken(), scheduler);
+            results[i] = sum.load();
+        }, TaskScheduler::Interactive, CancellationToken(), scheduler);
+
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(results[i] == i * (i - 1) / 2);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#include <QLineF>
+#include <QRectF>
+#include "3rdparty/doctest.h"
+#include "../../../utils.h"
+
+using namespace QSchematic;
+
+TEST_SUITE("Utils")
+{
+    TEST_CASE("distanceToLineSquared()")
+    {
+        const QLineF line(QPointF(0, 0), QPointF(10, 0));
+
+        SUBCASE("Projection on the segment") {
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(5, 3)) == doctest::Approx(9));
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(5, -4)) == doctest::Approx(16));
+        }
+
+        SUBCASE("On the segment") {
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(7, 0)) == doctest::Approx(0));
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(10, 0)) == doctest::Approx(0));
+        }
+
+        SUBCASE("Clamped to the end points") {
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(-3, 4)) == doctest::Approx(25));
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(13, -4)) == doctest::Approx(25));
+            REQUIRE(Utils::distanceToLineSquared(line, QPointF(20, 0)) == doctest::Approx(100));
+        }
+
+        SUBCASE("Diagonal") {
+            const QLineF diagonal(QPointF(0, 0), QPointF(10, 10));
+            REQUIRE(Utils::distanceToLineSquared(diagonal, QPointF(10, 0)) == doctest::Approx(50));
+        }
+
+        SUBCASE("Degenerate segment") {
+            const QLineF point(QPointF(2, 3), QPointF(2, 3));
+            REQUIRE(Utils::distanceToLineSquared(point, QPointF(5, 7)) == doctest::Approx(25));
+            REQUIRE(Utils::distanceToLineSquared(point, QPointF(2, 3)) == doctest::Approx(0));
+        }
+    }
+
+    TEST_CASE("distanceBetweenLinesSquared()")
+    {
+        SUBCASE("Crossing") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 10));
+            const QLineF line2(QPointF(0, 10), QPointF(10, 0));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(0));
+        }
+
+        SUBCASE("Touching at an end point") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(5, 0), QPointF(5, 10));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(0));
+        }
+
+        SUBCASE("Parallel") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(0, 3), QPointF(10, 3));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(9));
+        }
+
+        SUBCASE("Parallel and offset") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(13, 4), QPointF(20, 4));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(25));
+        }
+
+        SUBCASE("Collinear and overlapping") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(5, 0), QPointF(15, 0));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(0));
+        }
+
+        SUBCASE("Collinear and apart") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(12, 0), QPointF(20, 0));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(4));
+        }
+
+        SUBCASE("Closest to the inside of a segment") {
+            const QLineF line1(QPointF(0, 0), QPointF(10, 0));
+            const QLineF line2(QPointF(5, 2), QPointF(5, 10));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line1, line2) == doctest::Approx(4));
+            REQUIRE(Utils::distanceBetweenLinesSquared(line2, line1) == doctest::Approx(4));
+        }
+
+        SUBCASE("Degenerate segments") {
+            const QLineF point1(QPointF(0, 0), QPointF(0, 0));
+            const QLineF point2(QPointF(3, 4), QPointF(3, 4));
+            const QLineF line(QPointF(-5, 2), QPointF(5, 2));
+            REQUIRE(Utils::distanceBetweenLinesSquared(point1, point2) == doctest::Approx(25));
+            REQUIRE(Utils::distanceBetweenLinesSquared(point1, line) == doctest::Approx(4));
+        }
+    }
+
+    TEST_CASE("lineIntersectsRect()")
+    {
+        const QRectF rect(0, 0, 10, 10);
+
+        SUBCASE("Inside") {
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(2, 2), QPointF(8, 5)), rect));
+        }
+
+        SUBCASE("Crossing") {
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(-5, 5), QPointF(15, 5)), rect));
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(-5, -5), QPointF(15, 15)), rect));
+        }
+
+        SUBCASE("One end point inside") {
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(5, 5), QPointF(50, 5)), rect));
+        }
+
+        SUBCASE("Touching an edge or a corner") {
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(-5, 0), QPointF(15, 0)), rect));
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(10, 5), QPointF(20, 5)), rect));
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(-5, 15), QPointF(5, 5)), rect));
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(10, 10), QPointF(20, 20)), rect));
+        }
+
+        SUBCASE("Outside") {
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(-5, -1), QPointF(15, -1)), rect));
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(11, 0), QPointF(11, 10)), rect));
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(12, 0), QPointF(20, 10)), rect));
+        }
+
+        SUBCASE("Passing a corner") {
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(-5, 4), QPointF(4, -5)), rect));
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(8, 13), QPointF(13, 8)), rect));
+        }
+
+        SUBCASE("Degenerate segment") {
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(5, 5), QPointF(5, 5)), rect));
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(10, 10), QPointF(10, 10)), rect));
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(-1, 5), QPointF(-1, 5)), rect));
+        }
+
+        SUBCASE("Unnormalized rectangle") {
+            const QRectF flipped(10, 10, -10, -10);
+            REQUIRE(Utils::lineIntersectsRect(QLineF(QPointF(-5, 5), QPointF(15, 5)), flipped));
+            REQUIRE_FALSE(Utils::lineIntersectsRect(QLineF(QPointF(-5, -1), QPointF(15, -1)), flipped));
+        }
+    }
+}
@@ -570,6 +570,17 @@ void wire::remove_obsolete_points()
     }
 }
 
+/**
+ * Replaces all points. Meant for wires that are not (yet) managed, the manager
+ * is not notified.
+ */
+void wire::set_points(const QVector<point>& points)
+{
+    about_to_change();
+    m_points = points;
+    has_changed();
+}
+
 void wire::simplify()
 {
     about_to_change();
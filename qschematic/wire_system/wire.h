@@ -44,6 +44,7 @@ namespace wire_system
         void disconnectWire(wire* wire);
         virtual void add_segment(int index);
         void remove_point(int index);
+        void set_points(const QVector<point>& points);
 
     protected:
         void move_junctions_to_new_segment(const line& oldSegment, const line& newSegment);